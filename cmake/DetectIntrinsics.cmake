@@ -21,12 +21,34 @@ endif()
 
 # -------------------------------------------------------------------------------------------------- #
 # -------------------------------------------------------------------------------------------------- #
+# команда pclmulqdq разрешается только в функциях с атрибутом target("pclmul"),
+# а ее поддержка процессором проверяется во время выполнения, поэтому
+# глобальные флаги компилятора не изменяются
 check_c_source_compiles("
   #include <wmmintrin.h>
+  #ifdef __GNUC__
+   #define TARGET_PCLMUL __attribute__(( target( \"pclmul\" )))
+  #else
+   #include <intrin.h>
+   #define TARGET_PCLMUL
+  #endif
+
+  TARGET_PCLMUL static __m128i mul( __m128i a, __m128i b ) {
+    return _mm_clmulepi64_si128( a, b, 0x00 );
+  }
+
   int main( void ) {
 
-   __m128i a, b, c;
-   c = _mm_clmulepi64_si128( a, b, 0x00 );
+   __m128i a = _mm_set_epi64x( 1, 2 ), b = _mm_set_epi64x( 3, 4 );
+  #ifdef __GNUC__
+   __builtin_cpu_init();
+   if( __builtin_cpu_supports( \"pclmul\" )) a = mul( a, b );
+  #else
+   int info[4];
+   __cpuid( info, 1 );
+   if(( info[2] >> 1 )&1 ) a = mul( a, b );
+  #endif
+   _mm_storeu_si128( &b, a );
 
   return 0;
  }" LIBAKRYPT_HAVE_BUILTIN_CLMULEPI64 )
@@ -34,3 +56,37 @@ check_c_source_compiles("
 if( LIBAKRYPT_HAVE_BUILTIN_CLMULEPI64 )
     set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DLIBAKRYPT_HAVE_BUILTIN_CLMULEPI64" )
 endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #include <emmintrin.h>
+  int main( void ) {
+
+   __m128i a = _mm_set_epi64x( 1, 2 ), b = _mm_set_epi64x( 3, 4 ), c;
+   c = _mm_xor_si128( a, b );
+   _mm_storeu_si128( &a, c );
+
+  return 0;
+ }" LIBAKRYPT_HAVE_BUILTIN_XOR_SI128 )
+
+if( LIBAKRYPT_HAVE_BUILTIN_XOR_SI128 )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DLIBAKRYPT_HAVE_BUILTIN_XOR_SI128" )
+endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #include <sys/types.h>
+  int main( void ) {
+   ssize_t counter = 10, value = 0;
+
+   value = __atomic_load_n( &counter, __ATOMIC_RELAXED );
+   __atomic_compare_exchange_n( &counter, &value, value - 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED );
+
+  return 0;
+ }" LIBAKRYPT_HAVE_BUILTIN_ATOMIC )
+
+if( LIBAKRYPT_HAVE_BUILTIN_ATOMIC )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DLIBAKRYPT_HAVE_BUILTIN_ATOMIC" )
+endif()
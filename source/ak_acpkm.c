@@ -0,0 +1,447 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Copyright (c) 2014 - 2019 by Axel Kenzo, axelkenzo@mail.ru                                     */
+/*                                                                                                 */
+/*  Файл ak_acpkm.c                                                                                */
+/*  - содержит реализацию процедуры ACPKM выработки производных ключей и режима шифрования         */
+/*    CTR-ACPKM из рекомендаций по стандартизации Р 1323565.1.017-2018.                            */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <ak_tools.h>
+ #include <ak_bckey.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef LIBAKRYPT_HAVE_STRING_H
+ #include <string.h>
+#else
+ #error Library cannot be compiled without string.h header
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет новое значение ключа \f$ K_{i+1} \f$ из текущего значения \f$ K_i \f$
+    в соответствии с процедурой ACPKM:
+    \f$ K_{i+1} = e_{K_i}(D_1)||\ldots||e_{K_i}(D_{k}) \f$, где константа
+    \f$ D = D_1||\ldots||D_k \f$ есть последовательность октетов `0x80, 0x81, ..., 0x9f`,
+    разбитая на блоки длины n.
+
+    Все блоки константы зашифровываются одним вызовом многоблочной функции. После вычисления
+    новое значение присваивается ключу, выполняется развертка раундовых ключей, а ресурс ключа
+    устанавливается равным значению опции `acpkm_section_magma_block_count`
+    (`acpkm_section_kuznechik_block_count` для алгоритма Кузнечик).
+
+    @param bkey Контекст ключа алгоритма блочного шифрования, значение которого изменяется.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_context_next_acpkm_key( ak_bckey bkey )
+{
+  size_t i, j, blocks;
+  ak_uint8 d[32], new_key[32];
+  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option( "openssl_compability" );
+
+  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to block cipher key" );
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
+                                          __func__ , "incorrect block size of block cipher key" );
+  if( bkey->key.key_size != sizeof( new_key ))
+    return ak_error_message( ak_error_wrong_length, __func__,
+                                                     "using block cipher key with wrong length" );
+  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                                   "incorrect integrity code of secret key value" );
+
+ /* формируем константу D в том порядке байт, который ожидает функция зашифрования */
+  blocks = sizeof( d )/bkey->bsize;
+  for( i = 0; i < blocks; i++ )
+     for( j = 0; j < bkey->bsize; j++ )
+        d[i*bkey->bsize+j] = ( ak_uint8 )( 0x80 + i*bkey->bsize + ( oc ? j : bkey->bsize-1-j ));
+  ak_bckey_context_encrypt_blocks( bkey, d, d, blocks );
+
+ /* формируем новый ключ во внутреннем представлении:
+    в режиме совместимости ключ Кузнечика хранится в каноническом порядке байт, а ключ Магмы
+    (как и все ключи в обычном режиме) - в обратном, т.е. блоки следуют в обратном порядке */
+  if( oc && ( bkey->bsize == 16 )) memcpy( new_key, d, sizeof( new_key ));
+   else {
+     if( oc ) for( i = 0; i < sizeof( new_key ); i++ ) new_key[i] = d[sizeof( d )-1-i];
+      else for( i = 0; i < blocks; i++ )
+              memcpy( new_key + ( blocks-1-i )*bkey->bsize, d + i*bkey->bsize, bkey->bsize );
+   }
+
+ /* присваиваем новое значение и выполняем развертку */
+  if(( error = ak_skey_context_set_key( &bkey->key, new_key, sizeof( new_key ))) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "incorrect assigning of acpkm key data" );
+    goto lexit;
+  }
+  if( bkey->schedule_keys != NULL ) {
+    if(( error = bkey->schedule_keys( &bkey->key )) != ak_error_ok ) {
+      ak_error_message( error, __func__, "incorrect execution of key scheduling procedure" );
+      goto lexit;
+    }
+  }
+  if(( error = ak_skey_context_set_resource_values( &bkey->key, block_counter_resource,
+                    bkey->bsize == 8 ? "acpkm_section_magma_block_count" :
+                                       "acpkm_section_kuznechik_block_count", 0, 0 )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect assigning of acpkm section resource" );
+
+  lexit:
+   ak_ptr_context_wipe( d, sizeof( d ), &bkey->key.generator );
+   ak_ptr_context_wipe( new_key, sizeof( new_key ), &bkey->key.generator );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает номер следующего обрабатываемого блока, т.е. количество блоков,
+    зашифрованных с момента установки синхропосылки (младшая половина счетчика режима
+    гаммирования, хранящегося в контексте ключа).                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint64 ak_bckey_context_ctr_position( ak_bckey bkey, const int oc )
+{
+  ak_uint64 x;
+
+  if( bkey->bsize == 8 ) {
+   #ifdef LIBAKRYPT_LITTLE_ENDIAN
+    x = oc ? bswap_64( ((ak_uint64 *)bkey->ivector)[0] ) : ((ak_uint64 *)bkey->ivector)[0];
+   #else
+    x = oc ? ((ak_uint64 *)bkey->ivector)[0] : bswap_64( ((ak_uint64 *)bkey->ivector)[0] );
+   #endif
+    return x&0xffffffffLL;
+  }
+ #ifdef LIBAKRYPT_LITTLE_ENDIAN
+  x = oc ? bswap_64( ((ak_uint64 *)bkey->ivector)[1] ) : ((ak_uint64 *)bkey->ivector)[0];
+ #else
+  x = oc ? ((ak_uint64 *)bkey->ivector)[1] : bswap_64( ((ak_uint64 *)bkey->ivector)[0] );
+ #endif
+ return x;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует режим гаммирования CTR-ACPKM, в котором последовательность блоков гаммы
+    разбивается на секции длины `section_size` байт, и после выработки каждой секции
+    ключ заменяется на производный с помощью функции ak_bckey_context_next_acpkm_key().
+    Внутри секции используется многоблочная реализация режима гаммирования
+    ak_bckey_context_ctr(), а развертка раундовых ключей выполняется только на границах секций.
+
+    Как и для функции ak_bckey_context_ctr(), данные могут обрабатываться фрагментами:
+    при повторном вызове с нулевым указателем `iv` шифрование продолжается с того места,
+    на котором оно было остановлено (длины всех фрагментов, кроме последнего, должны быть кратны
+    длине блока). Положение внутри секции определяется по значению счетчика, поэтому
+    границы фрагментов могут не совпадать с границами секций.
+
+\code
+ // создаем рабочую копию ключа, поскольку значение ключа изменяется
+  ak_bckey_context_create_and_set_bckey( &work, &key );
+  ak_bckey_context_ctr_acpkm( &work, in, out, 1024, 256, iv, 8 );
+  ak_bckey_context_ctr_acpkm( &work, in+1024, out+1024, size-1024, 256, NULL, 0 );
+  ak_bckey_context_destroy( &work );
+\endcode
+
+    \note Функция изменяет значение ключа `bkey`. Для шифрования следующего сообщения
+    необходимо заново присвоить ключу исходное значение, либо использовать рабочую копию ключа,
+    созданную функцией ak_bckey_context_create_and_set_bckey().
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на входные данные.
+    @param out Указатель на область памяти, куда помещаются результаты
+    (этот указатель может совпадать с `in`).
+    @param size Размер обрабатываемых данных (в байтах).
+    @param section_size Длина секции (в байтах); должна быть кратна длине блока. Если значение
+    равно нулю, то длина секции определяется опцией `acpkm_section_magma_block_count`
+    или `acpkm_section_kuznechik_block_count`.
+    @param iv Указатель на синхропосылку или NULL для продолжения обработки данных.
+    @param iv_size Длина синхропосылки в байтах (половина длины блока).
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_context_ctr_acpkm( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                         size_t section_size, ak_pointer iv, size_t iv_size )
+{
+  size_t len = 0;
+  ak_uint64 position = 0, sb = 0;
+  ak_uint8 *inptr = ( ak_uint8 *)in, *outptr = ( ak_uint8 *)out;
+  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option( "openssl_compability" );
+
+  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to block cipher key" );
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
+                                          __func__ , "incorrect block size of block cipher key" );
+  if( size && (( in == NULL ) || ( out == NULL )))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer to data" );
+
+ /* определяем длину секции в блоках */
+  if( section_size == 0 ) {
+    sb = ( ak_uint64 ) ak_libakrypt_get_option( bkey->bsize == 8 ?
+                "acpkm_section_magma_block_count" : "acpkm_section_kuznechik_block_count" );
+  } else {
+     if( section_size%bkey->bsize )
+       return ak_error_message( ak_error_wrong_length, __func__,
+                                            "the length of section is not divided by block length" );
+     sb = section_size/bkey->bsize;
+    }
+
+ /* устанавливаем синхропосылку или определяем текущее положение в потоке данных */
+  if(( iv == NULL ) || ( iv_size == 0 )) {
+    if( bkey->key.flags&ak_key_flag_not_ctr )
+      return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
+                                           "function call with undefined value of initial vector" );
+    position = ak_bckey_context_ctr_position( bkey, oc );
+  } else {
+     if(( error = ak_bckey_context_ctr( bkey, in, out, 0, iv, iv_size )) != ak_error_ok )
+       return ak_error_message( error, __func__, "incorrect assigning of initial vector" );
+     position = 0;
+    }
+
+ /* обрабатываем данные посекционно */
+  while( size > 0 ) {
+    if( position && (( position%sb ) == 0 )) {
+      if(( error = ak_bckey_context_next_acpkm_key( bkey )) != ak_error_ok )
+        return ak_error_message( error, __func__, "incorrect generation of acpkm section key" );
+     /* ресурс ключа секции в точности равен длине секции */
+      bkey->key.resource.value.counter = ( ak_int64 )sb;
+    }
+    len = ( size_t ) ak_min(( ak_uint64 )size, ( sb - position%sb )*bkey->bsize );
+    if(( error = ak_bckey_context_ctr( bkey, inptr, outptr, len, NULL, 0 )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect encryption of section data" );
+
+    inptr += len; outptr += len; size -= len;
+    position += sb - position%sb;
+  }
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Проверка процедуры ACPKM: значение, выработанное из ключа `key`, сравнивается с
+    ожидаемым значением `next_key` путем зашифрования одних и тех же данных на обоих ключах.       */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_bckey_test_acpkm_next_key( ak_bckey bkey, ak_uint8 *key, ak_uint8 *next_key )
+{
+  struct bckey nkey;
+  bool_t result = ak_false;
+  ak_uint8 out[32], nout[32];
+  int error = ak_error_ok;
+
+  memset( out, 0x5a, sizeof( out ));
+  memset( nout, 0x5a, sizeof( nout ));
+  if(( error = ak_bckey_context_set_key( bkey, key, 32 )) != ak_error_ok ) goto lexit;
+  if(( error = ak_bckey_context_next_acpkm_key( bkey )) != ak_error_ok ) goto lexit;
+  if(( error = ak_bckey_context_encrypt_ecb( bkey, out, out, sizeof( out ))) != ak_error_ok )
+    goto lexit;
+
+  if(( error = ak_bckey_context_create_oid( &nkey, bkey->key.oid )) != ak_error_ok ) goto lexit;
+  if(( error = ak_bckey_context_set_key( &nkey, next_key, 32 )) == ak_error_ok )
+    error = ak_bckey_context_encrypt_ecb( &nkey, nout, nout, sizeof( nout ));
+  ak_bckey_context_destroy( &nkey );
+  if( error != ak_error_ok ) goto lexit;
+
+  if(( result = ak_ptr_is_equal_with_log( out, nout, sizeof( out ))) != ak_true )
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                               "the acpkm key derivation test from R 1323565.1.017-2018 is wrong" );
+ return result;
+
+  lexit:
+   ak_error_message( error, __func__ , "wrong derivation of acpkm key" );
+ return ak_false;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Проверка режима CTR-ACPKM для одного ключа на заданных значениях.
+
+    Проверяется зашифрование за один вызов (если указатель `out` отличен от NULL, результат
+    сравнивается с контрольным значением), расшифрование, а также зашифрование фрагментами,
+    границы которых не совпадают с границами секций. Перед каждой проверкой ключу
+    присваивается исходное значение.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_bckey_test_acpkm_values( ak_bckey bkey, ak_uint8 *key, ak_uint8 *in,
+                  ak_uint8 *out, const size_t size, const size_t section_size, ak_uint8 *iv )
+{
+  size_t i = 0, offset = 0;
+  ak_uint8 result[128], myout[128];
+  int error = ak_error_ok, audit = ak_log_get_level();
+  size_t chunks[3] = { 0, 0, 0 };
+
+  if(( size > sizeof( result )) || ( size < 4*bkey->bsize )) {
+    ak_error_message( ak_error_wrong_length, __func__, "wrong length of test data" );
+    return ak_false;
+  }
+
+ /* 1. зашифрование за один вызов */
+  if(( error = ak_bckey_context_set_key( bkey, key, 32 )) != ak_error_ok ) goto lexit;
+  if(( error = ak_bckey_context_ctr_acpkm( bkey, in, result, size,
+                                          section_size, iv, bkey->bsize >> 1 )) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "wrong ctr-acpkm mode encryption" );
+    return ak_false;
+  }
+  if(( out != NULL ) && !ak_ptr_is_equal_with_log( result, out, size )) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                            "the ctr-acpkm mode encryption test from R 1323565.1.017-2018 is wrong" );
+    return ak_false;
+  }
+
+ /* 2. расшифрование на месте */
+  memcpy( myout, result, size );
+  if(( error = ak_bckey_context_set_key( bkey, key, 32 )) != ak_error_ok ) goto lexit;
+  if(( error = ak_bckey_context_ctr_acpkm( bkey, myout, myout, size,
+                                          section_size, iv, bkey->bsize >> 1 )) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "wrong ctr-acpkm mode decryption" );
+    return ak_false;
+  }
+  if( !ak_ptr_is_equal_with_log( myout, in, size )) {
+    ak_error_message( ak_error_not_equal_data, __func__ , "the ctr-acpkm mode decryption is wrong" );
+    return ak_false;
+  }
+
+ /* 3. зашифрование фрагментами, не совпадающими с границами секций */
+  memset( myout, 0, sizeof( myout ));
+  chunks[0] = bkey->bsize;
+  chunks[1] = 3*bkey->bsize;
+  chunks[2] = size - chunks[0] - chunks[1];
+  if(( error = ak_bckey_context_set_key( bkey, key, 32 )) != ak_error_ok ) goto lexit;
+  for( i = 0; i < 3; offset += chunks[i++] )
+     if(( error = ak_bckey_context_ctr_acpkm( bkey, in+offset, myout+offset, chunks[i],
+              section_size, i ? NULL : iv, i ? 0 : bkey->bsize >> 1 )) != ak_error_ok ) goto lexit;
+  if( !ak_ptr_is_equal_with_log( myout, result, size )) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                                    "the ctr-acpkm mode encryption of data fragments is wrong" );
+    return ak_false;
+  }
+  if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
+                                "the ctr-acpkm mode test for one-pass and fragmented data is Ok" );
+ return ak_true;
+
+  lexit:
+   ak_error_message( error, __func__ , "wrong processing of data in ctr-acpkm mode" );
+ return ak_false;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция проверяет корректность реализации процедуры выработки производных ключей ACPKM и
+    режима шифрования CTR-ACPKM с использованием контрольных примеров из Р 1323565.1.017-2018.
+
+    @return Функция возвращает ak_true, если тестирование прошло успешно.
+    В противном случае, возвращается ak_false.                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ bool_t ak_bckey_test_acpkm( void )
+{
+ /* ключ, используемый в примерах из Р 1323565.1.017-2018, и следующие за ним ключи ACPKM */
+  ak_uint8 key[32] = {
+    0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+    0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+  ak_uint8 openssl_key[32] = {
+    0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+    0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10, 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef };
+  ak_uint8 kuznechik_next_key[32] = {
+    0x60, 0x0c, 0xe6, 0x3a, 0x40, 0xac, 0x59, 0x96, 0x8e, 0x7e, 0x30, 0x80, 0x57, 0xdb, 0x0a, 0x39,
+    0x7b, 0x7a, 0xf5, 0x48, 0xb4, 0xa0, 0x5c, 0x74, 0x11, 0x78, 0x68, 0xae, 0x40, 0xed, 0x66, 0x26 };
+  ak_uint8 openssl_kuznechik_next_key[32] = {
+    0x26, 0x66, 0xed, 0x40, 0xae, 0x68, 0x78, 0x11, 0x74, 0x5c, 0xa0, 0xb4, 0x48, 0xf5, 0x7a, 0x7b,
+    0x39, 0x0a, 0xdb, 0x57, 0x80, 0x30, 0x7e, 0x8e, 0x96, 0x59, 0xac, 0x40, 0x3a, 0xe6, 0x0c, 0x60 };
+  ak_uint8 magma_next_key[32] = {
+    0xa0, 0x0c, 0xd0, 0xab, 0x74, 0xb9, 0x8a, 0x9e, 0x0c, 0xde, 0x20, 0x77, 0x10, 0xfc, 0xbe, 0x74,
+    0x7d, 0x31, 0xe2, 0x28, 0x5a, 0xa8, 0x18, 0x2b, 0x37, 0x3d, 0x2c, 0x84, 0x17, 0xa0, 0x3e, 0x86 };
+  ak_uint8 openssl_magma_next_key[32] = {
+    0x86, 0x3e, 0xa0, 0x17, 0x84, 0x2c, 0x3d, 0x37, 0x2b, 0x18, 0xa8, 0x5a, 0x28, 0xe2, 0x31, 0x7d,
+    0x74, 0xbe, 0xfc, 0x10, 0x77, 0x20, 0xde, 0x0c, 0x9e, 0x8a, 0xb9, 0x74, 0xab, 0xd0, 0x0c, 0xa0 };
+
+ /* синхропосылки, открытый и зашифрованный тексты (длина секции 32 байта для Кузнечика) */
+  ak_uint8 kuznechik_iv[8] = {
+    0xf0, 0xce, 0xab, 0x90, 0x78, 0x56, 0x34, 0x12 };
+  ak_uint8 openssl_kuznechik_iv[8] = {
+    0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xce, 0xf0 };
+  ak_uint8 magma_iv[4] = {
+    0x78, 0x56, 0x34, 0x12 };
+  ak_uint8 openssl_magma_iv[4] = {
+    0x12, 0x34, 0x56, 0x78 };
+  ak_uint8 in[112] = {
+    0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+    0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00,
+    0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+    0x11, 0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22,
+    0x22, 0x11, 0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33,
+    0x33, 0x22, 0x11, 0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44,
+    0x44, 0x33, 0x22, 0x11, 0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55 };
+  ak_uint8 openssl_in[112] = {
+    0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88,
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xee, 0xff, 0x0a,
+    0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xee, 0xff, 0x0a, 0x00,
+    0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xee, 0xff, 0x0a, 0x00, 0x11,
+    0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xee, 0xff, 0x0a, 0x00, 0x11, 0x22,
+    0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xee, 0xff, 0x0a, 0x00, 0x11, 0x22, 0x33,
+    0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xee, 0xff, 0x0a, 0x00, 0x11, 0x22, 0x33, 0x44 };
+  ak_uint8 kuznechik_out[112] = {
+    0xb8, 0xa1, 0xbd, 0x40, 0xa2, 0x5f, 0x7b, 0xd5, 0xdb, 0xd1, 0x0e, 0xc1, 0xbe, 0xd8, 0x95, 0xf1,
+    0xe4, 0xde, 0x45, 0x3c, 0xb3, 0xe4, 0x3c, 0xf3, 0x5d, 0x3e, 0xa1, 0xf6, 0x33, 0xe7, 0xee, 0x85,
+    0x00, 0xe8, 0x85, 0x5e, 0x27, 0x06, 0x17, 0x00, 0x55, 0x4c, 0x6f, 0x64, 0x8f, 0xeb, 0xce, 0x4b,
+    0x46, 0x50, 0x80, 0xd0, 0xaf, 0x34, 0x48, 0x3e, 0x39, 0x94, 0xd0, 0x68, 0xf5, 0x4d, 0x7c, 0x58,
+    0x6e, 0x89, 0x8a, 0x6b, 0x31, 0x6c, 0xfc, 0x1c, 0xe1, 0xec, 0xae, 0x86, 0x76, 0xf5, 0x30, 0xcf,
+    0x3e, 0x16, 0x23, 0x34, 0x74, 0x3b, 0x4f, 0x0c, 0x46, 0x36, 0x36, 0x81, 0xec, 0x07, 0xfd, 0xdf,
+    0x5d, 0xde, 0xd6, 0xfb, 0xe7, 0x21, 0xd2, 0x69, 0xd4, 0xc8, 0xfa, 0x82, 0xc2, 0xa9, 0x09, 0x64 };
+  ak_uint8 openssl_kuznechik_out[112] = {
+    0xf1, 0x95, 0xd8, 0xbe, 0xc1, 0x0e, 0xd1, 0xdb, 0xd5, 0x7b, 0x5f, 0xa2, 0x40, 0xbd, 0xa1, 0xb8,
+    0x85, 0xee, 0xe7, 0x33, 0xf6, 0xa1, 0x3e, 0x5d, 0xf3, 0x3c, 0xe4, 0xb3, 0x3c, 0x45, 0xde, 0xe4,
+    0x4b, 0xce, 0xeb, 0x8f, 0x64, 0x6f, 0x4c, 0x55, 0x00, 0x17, 0x06, 0x27, 0x5e, 0x85, 0xe8, 0x00,
+    0x58, 0x7c, 0x4d, 0xf5, 0x68, 0xd0, 0x94, 0x39, 0x3e, 0x48, 0x34, 0xaf, 0xd0, 0x80, 0x50, 0x46,
+    0xcf, 0x30, 0xf5, 0x76, 0x86, 0xae, 0xec, 0xe1, 0x1c, 0xfc, 0x6c, 0x31, 0x6b, 0x8a, 0x89, 0x6e,
+    0xdf, 0xfd, 0x07, 0xec, 0x81, 0x36, 0x36, 0x46, 0x0c, 0x4f, 0x3b, 0x74, 0x34, 0x23, 0x16, 0x3e,
+    0x64, 0x09, 0xa9, 0xc2, 0x82, 0xfa, 0xc8, 0xd4, 0x69, 0xd2, 0x21, 0xe7, 0xfb, 0xd6, 0xde, 0x5d };
+
+  struct bckey bkey;
+  bool_t result = ak_true;
+  int error = ak_error_ok, audit = ak_log_get_level(),
+      oc = (int) ak_libakrypt_get_option( "openssl_compability" );
+
+ /* Проверка используемого режима совместимости */
+  if(( oc < 0 ) || ( oc > 1 )) {
+    ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+    return ak_false;
+  }
+
+ /* 1. Тестируем алгоритм Кузнечик */
+  if(( error = ak_bckey_context_create_kuznechik( &bkey )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect initialization of kuznechik secret key context");
+    return ak_false;
+  }
+  if(( result = ak_bckey_test_acpkm_next_key( &bkey, oc ? openssl_key : key,
+                             oc ? openssl_kuznechik_next_key : kuznechik_next_key )) == ak_true )
+    result = ak_bckey_test_acpkm_values( &bkey, oc ? openssl_key : key, oc ? openssl_in : in,
+                          oc ? openssl_kuznechik_out : kuznechik_out, sizeof( in ), 32,
+                                                      oc ? openssl_kuznechik_iv : kuznechik_iv );
+  ak_bckey_context_destroy( &bkey );
+  if( result != ak_true ) {
+    ak_error_message( ak_error_get_value(), __func__ ,
+                                                "incorrect testing of ctr-acpkm mode for kuznechik" );
+    return ak_false;
+  }
+  if( audit >= ak_log_maximum )
+    ak_error_message( ak_error_ok, __func__ , "testing of ctr-acpkm mode for kuznechik is Ok" );
+
+ /* 2. Тестируем алгоритм Магма (длина секции 16 байт) */
+  if(( error = ak_bckey_context_create_magma( &bkey )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect initialization of magma secret key context");
+    return ak_false;
+  }
+  if(( result = ak_bckey_test_acpkm_next_key( &bkey, oc ? openssl_key : key,
+                                     oc ? openssl_magma_next_key : magma_next_key )) == ak_true )
+    result = ak_bckey_test_acpkm_values( &bkey, oc ? openssl_key : key, oc ? openssl_in : in,
+                                       NULL, sizeof( in ), 16, oc ? openssl_magma_iv : magma_iv );
+  ak_bckey_context_destroy( &bkey );
+  if( result != ak_true ) {
+    ak_error_message( ak_error_get_value(), __func__ ,
+                                                    "incorrect testing of ctr-acpkm mode for magma" );
+    return ak_false;
+  }
+  if( audit >= ak_log_maximum )
+    ak_error_message( ak_error_ok, __func__ , "testing of ctr-acpkm mode for magma is Ok" );
+
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                                     ak_acpkm.c  */
+/* ----------------------------------------------------------------------------------------------- */
@@ -19,6 +19,12 @@
 #else
  #error Library cannot be compiled without string.h header
 #endif
+#ifdef LIBAKRYPT_HAVE_UNISTD_H
+ #include <unistd.h>
+#endif
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ #include <pthread.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция устанавливает параметры алгоритма блочного шифрования, передаваемые в качестве
@@ -27,6 +33,8 @@
 
     - bkey.encrypt -- алгоритм зашифрования одного блока
     - bkey.decrypt -- алгоритм расшифрования одного блока
+    - bkey.encrypt_blocks -- алгоритм зашифрования нескольких блоков (может не определяться)
+    - bkey.decrypt_blocks -- алгоритм расшифрования нескольких блоков (может не определяться)
     - bkey.shedule_keys -- алгоритм развертки ключа и генерации раундовых ключей
     - bkey.delete_keys -- функция удаления раундовых ключей
 
@@ -60,12 +68,16 @@
  /* инициализируем ключевые данные */
   if(( error = ak_skey_context_create( &bkey->key, keysize )) != ak_error_ok )
     return ak_error_message( error, __func__, "wrong creation of secret key" );
+ /* до установки синхропосылки режим гаммирования не может использовать внутреннее значение */
+  bkey->key.flags |= ak_key_flag_not_ctr;
 
   memset( bkey->ivector, 0, sizeof( bkey->ivector ));
   bkey->bsize =         blocksize;
   bkey->ivector_size =  0;
   bkey->encrypt =       NULL;
   bkey->decrypt =       NULL;
+  bkey->encrypt_blocks = NULL;
+  bkey->decrypt_blocks = NULL;
   bkey->schedule_keys = NULL;
   bkey->delete_keys =   NULL;
 
@@ -100,6 +112,8 @@
   bkey->bsize =            0;
   bkey->encrypt =       NULL;
   bkey->decrypt =       NULL;
+  bkey->encrypt_blocks = NULL;
+  bkey->decrypt_blocks = NULL;
   bkey->schedule_keys = NULL;
   bkey->delete_keys =   NULL;
 
@@ -328,8 +342,132 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция инициализирует контекст ключа `bkey` для того же алгоритма блочного шифрования,
+    что и ключ `source`, и присваивает ему значение ключа `source`. Вместе со значением ключа
+    копируются его номер и текущий ресурс.
+
+    Значение ключа копируется в маскированном виде вместе с маской, после чего маска копии
+    сменяется. Исходный ключ не изменяется, а значение ключа без маски не вычисляется.
+
+    Функция предназначена для создания рабочих копий ключа, например, при использовании
+    режимов, изменяющих значение ключа в процессе шифрования (см. ak_bckey_context_ctr_acpkm()).
+
+    @param bkey Контекст создаваемого ключа.
+    @param source Контекст ключа, значение которого присваивается.
+
+    @return Функция возвращает код ошибки. В случае успеха возвращается \ref ak_error_ok.          */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_context_create_and_set_bckey( ak_bckey bkey, ak_bckey source )
+{
+  int error = ak_error_ok;
+
+ /* проверяем входные данные */
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                      "using null pointer to secret key context" );
+  if( source == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                      "using null pointer to source key context" );
+  if( !( source->key.flags&ak_key_flag_set_key ))
+    return ak_error_message( ak_error_key_value, __func__ ,
+                                                        "using source key with undefined value" );
+ /* создаем контекст того же алгоритма */
+  if(( error = ak_bckey_context_create_oid( bkey, source->key.oid )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect creation of block cipher key context" );
+  if( bkey->key.key_size != source->key.key_size ) {
+    ak_error_message( error = ak_error_wrong_length, __func__,
+                                                        "using source key with wrong length" );
+    goto lexit;
+  }
+
+ /* копируем маскированное значение ключа вместе с маской; блокировка совместного использования
+    исключает смену маски исходного ключа во время копирования */
+  ak_skey_context_shared_lock( &source->key );
+  if( source->key.check_icode( &source->key ) != ak_true ) {
+    ak_skey_context_shared_unlock( &source->key );
+    ak_error_message( error = ak_error_wrong_key_icode, __func__,
+                                                   "incorrect integrity code of secret key value" );
+    goto lexit;
+  }
+  memcpy( bkey->key.key, source->key.key, 2*source->key.key_size );
+  bkey->key.flags |= ( source->key.flags&ak_key_flag_set_mask );
+  ak_skey_context_shared_unlock( &source->key );
+
+ /* сменяем маску копии и вычисляем ее контрольную сумму */
+  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "wrong secret key masking" );
+    goto lexit;
+  }
+  if(( error = bkey->key.set_icode( &bkey->key )) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "wrong calculation of integrity code" );
+    goto lexit;
+  }
+  bkey->key.flags |= ak_key_flag_set_key;
+
+  if(( error = ak_skey_context_set_number( &bkey->key,
+                                 source->key.number, sizeof( source->key.number ))) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "incorrect assigning of key number" );
+    goto lexit;
+  }
+  if( bkey->schedule_keys != NULL ) {
+    if(( error = bkey->schedule_keys( &bkey->key )) != ak_error_ok ) {
+      ak_error_message( error, __func__, "incorrect execution of key scheduling procedure" );
+      goto lexit;
+    }
+  }
+  if(( error = ak_skey_context_set_resource( &bkey->key, &source->key.resource )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect assigning of key resource" );
+
+  lexit:
+   if( error != ak_error_ok ) ak_bckey_context_destroy( bkey );
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                             теперь реализация режимов шифрования                                */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает заданное количество последовательно расположенных блоков.
+
+    Если для алгоритма блочного шифрования определена многоблочная реализация
+    (метод `bkey.encrypt_blocks`), то используется она, в противном случае блоки
+    зашифровываются по одному.                                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_bckey_context_encrypt_blocks( ak_bckey bkey, ak_pointer in,
+                                                                   ak_pointer out, size_t blocks )
+{
+  ak_uint8 *inptr = ( ak_uint8 *)in, *outptr = ( ak_uint8 *)out;
+
+  if( bkey->encrypt_blocks != NULL ) {
+    bkey->encrypt_blocks( &bkey->key, in, out, blocks );
+    return;
+  }
+  while( blocks-- > 0 ) {
+    bkey->encrypt( &bkey->key, inptr, outptr );
+    inptr += bkey->bsize; outptr += bkey->bsize;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифровывает заданное количество последовательно расположенных блоков.
+
+    Если для алгоритма блочного шифрования определена многоблочная реализация
+    (метод `bkey.decrypt_blocks`), то используется она, в противном случае блоки
+    расшифровываются по одному.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_bckey_context_decrypt_blocks( ak_bckey bkey, ak_pointer in,
+                                                                   ak_pointer out, size_t blocks )
+{
+  ak_uint8 *inptr = ( ak_uint8 *)in, *outptr = ( ak_uint8 *)out;
+
+  if( bkey->decrypt_blocks != NULL ) {
+    bkey->decrypt_blocks( &bkey->key, in, out, blocks );
+    return;
+  }
+  while( blocks-- > 0 ) {
+    bkey->decrypt( &bkey->key, inptr, outptr );
+    inptr += bkey->bsize; outptr += bkey->bsize;
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param bkey Контекст ключа алгоритма блочного шифрования.
     @param in Указатель на область памяти, где хранятся входные (зашифровываемые) данные
@@ -345,7 +483,6 @@
 {
   size_t blocks = 0;
   int error = ak_error_ok;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
 
  /* выполняем проверку размера входных данных */
   if( size%bkey->bsize != 0 )
@@ -366,22 +503,14 @@
  /* теперь приступаем к зашифрованию данных */
   switch( bkey->bsize ) {
     case  8: /* шифр с длиной блока 64 бита */
-      do {
-        bkey->encrypt( &bkey->key, inptr++, outptr++ );
-      } while( --blocks > 0 );
-    break;
-
     case 16: /* шифр с длиной блока 128 бит */
-      do {
-        bkey->encrypt( &bkey->key, inptr, outptr );
-        inptr+=2; outptr+=2;
-      } while( --blocks > 0 );
+      ak_bckey_context_encrypt_blocks( bkey, in, out, blocks );
     break;
     default: return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
   }
  /* перемаскируем ключ */
-  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+  if(( error = ak_skey_context_remask( &bkey->key, (ak_int64) blocks )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
  return ak_error_ok;
@@ -402,7 +531,6 @@
 {
   size_t blocks = 0;
   int error = ak_error_ok;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
 
  /* выполняем проверку размера входных данных */
   if( size%bkey->bsize != 0 )
@@ -423,27 +551,138 @@
  /* теперь приступаем к расшифрованию данных */
   switch( bkey->bsize ) {
     case  8: /* шифр с длиной блока 64 бита */
-      do {
-        bkey->decrypt( &bkey->key, inptr++, outptr++ );
-      } while( --blocks > 0 );
-    break;
-
     case 16: /* шифр с длиной блока 128 бит */
-      do {
-        bkey->decrypt( &bkey->key, inptr, outptr );
-        inptr+=2; outptr+=2;
-      } while( --blocks > 0 );
+      ak_bckey_context_decrypt_blocks( bkey, in, out, blocks );
     break;
     default: return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
   }
  /* перемаскируем ключ */
-  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+  if(( error = ak_skey_context_remask( &bkey->key, (ak_int64) blocks )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция увеличивает значение счетчика режима гаммирования, хранящееся в буффере
+    `ivector` в том же формате, что и в контексте ключа, на величину `value`.                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_context_ctr_increment( ak_bckey bkey, ak_uint8 *ivector,
+                                                              const ak_uint64 value, const int oc )
+{
+  ak_uint64 x, *iv = ( ak_uint64 *)ivector;
+  size_t idx = ( bkey->bsize == 16 ) ? ( size_t )oc : 0;
+
+ #ifdef LIBAKRYPT_LITTLE_ENDIAN
+  x = oc ? bswap_64( iv[idx] ) : iv[idx];
+  x += value;
+  iv[idx] = oc ? bswap_64( x ) : x;
+ #else
+  x = oc ? iv[idx] : bswap_64( iv[idx] );
+  x += value;
+  iv[idx] = oc ? x : bswap_64( x );
+ #endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция гаммирует `size` байт данных, используя значение счетчика, хранящееся в буффере
+    `ivector` (в том же формате, что и в контексте ключа).
+
+    После обработки полных блоков значение счетчика увеличивается на их количество. Неполный
+    последний блок обрабатывается как последний блок сообщения; значение счетчика при этом
+    не изменяется. Функция не изменяет маску ключа и не проверяет его ресурс; вспомогательные
+    данные, изменяемые при зашифровании (для Магмы - буффер траекторий случайного блуждания),
+    защищены мьютексом ключа. Поэтому функция может вызываться одновременно из нескольких
+    потоков для одного ключа.                                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_context_ctr_process( ak_bckey bkey, ak_uint8 *ivector, ak_pointer in,
+                                                 ak_pointer out, const size_t size, const int oc )
+{
+  ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
+             tail = (ak_int64)( size%bkey->bsize );
+  ak_int64 i, n;
+  ak_uint64 x, yaout[2], *iv = (ak_uint64 *)ivector,
+                                         *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+  ak_uint64 gamma[256]; /* буффер для одновременной выработки нескольких блоков гаммы */
+
+ /* обработка основного массива данных (кратного длине блока) */
+  switch( bkey->bsize ) {
+    case  8: /* шифр с длиной блока 64 бита (Магма) */
+     #ifndef LIBAKRYPT_LITTLE_ENDIAN
+      x = oc ? iv[0] : bswap_64( iv[0] );
+     #else
+      x = oc ? bswap_64( iv[0] ) : iv[0];
+     #endif
+
+      while( blocks > 0 ) {
+       /* формируем сразу несколько последовательных значений счетчика */
+        n = ak_min( blocks, 256 );
+        for( i = 0; i < n; i++ ) {
+           gamma[i] = iv[0];
+         #ifndef LIBAKRYPT_LITTLE_ENDIAN
+           iv[0] = oc ? ++x : bswap_64( ++x );
+         #else
+           iv[0] = oc ? bswap_64( ++x ) : ++x;
+         #endif
+        }
+        ak_bckey_context_encrypt_blocks( bkey, gamma, gamma, (size_t) n );
+        for( i = 0; i < n; i++ ) outptr[i] = inptr[i] ^ gamma[i];
+        outptr += n; inptr += n;
+        blocks -= n;
+      }
+    break;
+
+    case 16: /* шифр с длиной блока 128 бит (Кузнечик) */
+     #ifndef LIBAKRYPT_LITTLE_ENDIAN
+      x = oc ? iv[1] : bswap_64( iv[0] );
+     #else
+      x = oc ? bswap_64( iv[1] ) : iv[0];
+     #endif
+
+      while( blocks > 0 ) {
+       /* формируем сразу несколько последовательных значений счетчика */
+        n = ak_min( blocks, 128 );
+        for( i = 0; i < n; i++ ) {
+           gamma[2*i] = iv[0];
+           gamma[2*i+1] = iv[1];
+
+         /* за элементарное сложение с единицей приходится платить одним разворотом */
+         #ifdef LIBAKRYPT_LITTLE_ENDIAN
+           iv[oc] = oc ? bswap_64(++x) : ++x;
+         #else
+           iv[oc] = oc ? ++x : bswap_64( ++x );
+         #endif                    /* здесь мы не учитываем знак переноса
+                                      потому что объем данных на одном ключе не должен
+                                      превышать 2^64 блоков (контролируется через ресурс ключа) */
+        }
+        ak_bckey_context_encrypt_blocks( bkey, gamma, gamma, (size_t) n );
+        for( i = 0; i < 2*n; i++ ) outptr[i] = inptr[i] ^ gamma[i];
+        outptr += 2*n; inptr += 2*n;
+        blocks -= n;
+      }
+    break;
+
+    default: return;
+  }
+
+ /* обрабатываем хвост сообщения */
+  if( tail ) {
+    bkey->encrypt( &bkey->key, ivector, yaout );
+    for( i = 0; i < tail; i++ ) /* теперь мы гаммируем tail байт, используя для этого
+                                   старшие байты (most significant bytes) зашифрованного счетчика */
+       if( oc ) {
+        /* для блочного шифра Магма этот код выдает результат отличный от того, что вырабатывает openssl
+           для блочного шифра Кузнечик результат совпадает
+
+           поиск того, почему Магма реализована по другому - задача за гранью добра и зла */
+         ( (ak_uint8*)outptr )[i] = ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[i];
+
+       } else ( (ak_uint8*)outptr )[i] =
+           ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[bkey->bsize - (size_t)(tail-i)];
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Поскольку в режиме гаммирования операцией шифрования является сложение открытого текста по
     модулю два с последовательностью, вырабатываемой блочным шифром, то для зашифрования и
@@ -498,20 +737,22 @@
 {
   ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
              tail = (ak_int64)( size%bkey->bsize );
-  ak_uint64 x, yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
   int error = ak_error_ok, oc = (int) ak_libakrypt_get_option( "openssl_compability" );
 
   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                 "wrong value for \"openssl_compability\" option" );
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
+                                          __func__ , "incorrect block size of block cipher key" );
  /* проверяем целостность ключа */
   if( bkey->key.check_icode( &bkey->key ) != ak_true )
     return ak_error_message( ak_error_wrong_key_icode, __func__,
                                                    "incorrect integrity code of secret key value" );
  /* уменьшаем значение ресурса ключа */
-  if( bkey->key.resource.value.counter < ( blocks + ( tail > 0 )))
-    return ak_error_message( ak_error_low_key_resource,
-                                                    __func__ , "low resource of block cipher key" );
-   else bkey->key.resource.value.counter -= ( blocks + ( tail > 0 ));
+  if(( error = ak_skey_context_decrement_resource( &bkey->key,
+                                               (ssize_t)( blocks + ( tail > 0 )))) != ak_error_ok )
+    return ak_error_message( error, __func__ , "low resource of block cipher key" );
+  ak_skey_context_shared_lock( &bkey->key );
 
  /* выбираем, как вычислять синхропосылку проверяем флаг
     флаг поднимается при вызове функции с заданным значением синхропосылки и
@@ -536,87 +777,423 @@
                                                        выделенной под переменную ivector */
      memcpy( bkey->ivector + halfsize*((unsigned int)(1-oc)), iv, ak_min( halfsize, iv_size ));
 
-    /* поднимаем значение флага: синхропосылка установлена */
-     bkey->key.flags = ( bkey->key.flags&( ~ak_key_flag_not_ctr ))^ak_key_flag_not_ctr;
+    /* опускаем значение флага: синхропосылка установлена */
+     bkey->key.flags = bkey->key.flags&( ~ak_key_flag_not_ctr );
     }
 
- /* обработка основного массива данных (кратного длине блока) */
-  switch( bkey->bsize ) {
-    case  8: /* шифр с длиной блока 64 бита (Магма) */
-      while( blocks > 0 ) {
-        #ifndef LIBAKRYPT_LITTLE_ENDIAN
-          x = oc ? ((ak_uint64 *)bkey->ivector)[0] : bswap_64( ((ak_uint64 *)bkey->ivector)[0] );
-        #else
-          x = oc ? bswap_64( ((ak_uint64 *)bkey->ivector)[0] ) : ((ak_uint64 *)bkey->ivector)[0];
-        #endif
-          bkey->encrypt( &bkey->key, bkey->ivector, yaout );
-          *outptr = *inptr ^ yaout[0];
-          outptr++; inptr++;
+ /* обработка данных */
+  ak_bckey_context_ctr_process( bkey, bkey->ivector, in, out, size, oc );
 
-        #ifndef LIBAKRYPT_LITTLE_ENDIAN
-          ((ak_uint64 *)bkey->ivector)[0] = oc ? ++x : bswap_64( ++x );
-        #else
-          ((ak_uint64 *)bkey->ivector)[0] = oc ? bswap_64( ++x ) : ++x;
-        #endif
-        --blocks;
-      }
-    break;
+ /* запрещаем дальнейшее использование функции на данном значении синхропосылки,
+                                           поскольку обрабатываемые данные не кратны длине блока. */
+  if( tail ) {
+    memset( bkey->ivector, 0, sizeof( bkey->ivector ));
+    bkey->key.flags |= ak_key_flag_not_ctr;
+  }
 
-    case 16: /* шифр с длиной блока 128 бит (Кузнечик) */
-     #ifndef LIBAKRYPT_LITTLE_ENDIAN
-      x = bswap_64( ((ak_uint64 *)bkey->ivector)[oc] );
-     #else
-      x = ((ak_uint64 *)bkey->ivector)[oc];
-     #endif
+ /* перемаскируем ключ */
+  if(( error = ak_skey_context_remask( &bkey->key, blocks + ( tail > 0 ))) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
-      while( blocks > 0 ) {
-          bkey->encrypt( &bkey->key, bkey->ivector, yaout );
-          *outptr = *inptr ^ yaout[0]; outptr++; inptr++;
-          *outptr = *inptr ^ yaout[1]; outptr++; inptr++;
+ return error;
+}
 
-       /* за элементарное сложение с единицей приходится платить одним разворотом */
-        #ifdef LIBAKRYPT_LITTLE_ENDIAN
-         ((ak_uint64 *)bkey->ivector)[oc] = oc ? bswap_64(++x) : ++x;
-        #else
-          ((ak_uint64 *)bkey->ivector)[oc] = oc ? ++x : bswap_64( ++x );
-        #endif                    /* здесь мы не учитываем знак переноса
-                                     потому что объем данных на одном ключе не должен
-                                     превышать 2^64 блоков (контролируется через ресурс ключа) */
-        --blocks;
-      }
-    break;
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Флаг, определяющий, что контекст режима гаммирования инициализирован. */
+ #define ak_ctr_flag_clean          (0x01)
+/*! \brief Флаг, определяющий, что обработан неполный блок и продолжение невозможно. */
+ #define ak_ctr_flag_tail           (0x02)
 
-    default: return ak_error_message( ak_error_wrong_block_cipher,
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция помещает в контекст начальное значение счетчика, вычисляемое по синхропосылке так же,
+    как и в функции ak_bckey_context_ctr(). Контекст ключа функцией не изменяется.
+
+    @param ctx Контекст режима гаммирования.
+    @param bkey Ключ алгоритма блочного шифрования (Магма или Кузнечик).
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в байтах; должна быть не меньше половины длины блока.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_ctr_context_clean( ak_ctr_ctx ctx, ak_bckey bkey, const ak_pointer iv, const size_t iv_size )
+{
+  size_t halfsize = 0;
+  int oc = (int) ak_libakrypt_get_option( "openssl_compability" );
+
+  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to ctr context" );
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to block cipher key" );
+  if( iv == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using null pointer to initial vector" );
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
-  }
+  if( iv_size < ( halfsize = bkey->bsize >> 1 ))
+    return ak_error_message( ak_error_wrong_iv_length, __func__,
+                                                              "incorrect length of initial value" );
+  memset( ctx, 0, sizeof( struct ctr_ctx ));
+  ctx->bsize = bkey->bsize;
+  memcpy( (ak_uint8 *)ctx->counter + halfsize*((unsigned int)(1-oc)), iv, halfsize );
+  ctx->flags = ak_ctr_flag_clean;
 
- /* обрабатываем хвост сообщения */
-  if( tail ) {
-    int i;
-    bkey->encrypt( &bkey->key, bkey->ivector, yaout );
-    for( i = 0; i < tail; i++ ) /* теперь мы гаммируем tail байт, используя для этого
-                                   старшие байты (most significant bytes) зашифрованного счетчика */
-       if( oc ) {
-        /* для блочного шифра Магма этот код выдает результат отличный от того, что вырабатывает openssl
-           для блочного шифра Кузнечик результат совпадает
+ return ak_error_ok;
+}
 
-           поиск того, почему Магма реализована по другому - задача за гранью добра и зла */
-         ( (ak_uint8*)outptr )[i] = ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[i];
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция гаммирует очередной фрагмент данных, используя значение счетчика, хранящееся
+    в контексте `ctx`. Синхропосылка и флаги ключа не изменяются, ресурс ключа уменьшается
+    атомарно, а вспомогательные данные, изменяемые при зашифровании (для Магмы - буффер
+    траекторий случайного блуждания), защищены мьютексом ключа. Поэтому один ключ может
+    одновременно использоваться в нескольких потоках, каждый из которых владеет собственным
+    контекстом режима гаммирования.
+
+    После обработки данных маска ключа сменяется в соответствии с политикой смены маски
+    функцией ak_skey_context_remask_shared(): счетчики политики изменяются атомарно, а сама
+    смена маски выполняется только тогда, когда ни один поток не обрабатывает данные.
+    Функции, не предназначенные для совместного использования ключа (например,
+    ak_bckey_context_ctr()), по-прежнему не должны вызываться одновременно с данной функцией.
+
+    Длина всех фрагментов, кроме последнего, должна быть кратна длине блока; после обработки
+    неполного блока дальнейшее использование контекста невозможно.
+
+    @param ctx Контекст режима гаммирования.
+    @param bkey Ключ алгоритма блочного шифрования, использованный при инициализации контекста.
+    @param in Указатель на входные данные.
+    @param out Указатель на область памяти, куда помещаются результаты
+    (этот указатель может совпадать с `in`).
+    @param size Размер обрабатываемых данных (в байтах).
 
-       } else ( (ak_uint8*)outptr )[i] =
-           ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[bkey->bsize - (size_t)(tail-i)];
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_ctr_context_update( ak_ctr_ctx ctx, ak_bckey bkey, const ak_pointer in,
+                                                              ak_pointer out, const size_t size )
+{
+  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option( "openssl_compability" );
 
-   /* запрещаем дальнейшее использование функции на данном значении синхропосылки,
-                                           поскольку обрабатываемые данные не кратны длине блока. */
-    memset( bkey->ivector, 0, sizeof( bkey->ivector ));
-    bkey->key.flags = bkey->key.flags&( ~ak_key_flag_not_ctr );
+  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to ctr context" );
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to block cipher key" );
+  if( !( ctx->flags&ak_ctr_flag_clean ))
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__,
+                                                            "using non initialized ctr context" );
+  if( ctx->flags&ak_ctr_flag_tail )
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
+                                           "function call with undefined value of initial vector" );
+  if( bkey->bsize != ctx->bsize )
+    return ak_error_message( ak_error_wrong_block_cipher, __func__,
+                                  "block size of secret key differs from ctr context block size" );
+  if( size == 0 ) return ak_error_ok;
+
+ /* пока обрабатываются данные, маска ключа не может быть изменена другим потоком */
+  ak_skey_context_shared_lock( &bkey->key );
+
+ /* проверяем целостность ключа и уменьшаем его ресурс */
+  if( bkey->key.check_icode( &bkey->key ) != ak_true ) {
+    ak_skey_context_shared_unlock( &bkey->key );
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                                   "incorrect integrity code of secret key value" );
+  }
+  if(( error = ak_skey_context_decrement_resource( &bkey->key,
+                   (ssize_t)(( size + bkey->bsize - 1 )/bkey->bsize ))) != ak_error_ok ) {
+    ak_skey_context_shared_unlock( &bkey->key );
+    return ak_error_message( error, __func__ , "low resource of block cipher key" );
+  }
+
+  ak_bckey_context_ctr_process( bkey, (ak_uint8 *)ctx->counter, in, out, size, oc );
+  ak_skey_context_shared_unlock( &bkey->key );
+  if( size%bkey->bsize ) {
+    memset( ctx->counter, 0, sizeof( ctx->counter ));
+    ctx->flags |= ak_ctr_flag_tail;
   }
 
  /* перемаскируем ключ */
-  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+  if(( error = ak_skey_context_remask_shared( &bkey->key,
+                                (ak_int64)(( size + bkey->bsize - 1 )/bkey->bsize ))) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
+ return ak_error_ok;
+}
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Минимальный объем данных (в байтах), обрабатываемый одним потоком. */
+ #define ak_bckey_ctr_parallel_min_size  ( 1048576 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание для одного потока, реализующего режим гаммирования. */
+ typedef struct ctr_worker {
+  /*! \brief Общий для всех потоков ключ. */
+   ak_bckey bkey;
+  /*! \brief Собственное значение счетчика потока. */
+   ak_uint64 counter[2];
+  /*! \brief Указатель на входные данные. */
+   ak_pointer in;
+  /*! \brief Указатель на выходные данные. */
+   ak_pointer out;
+  /*! \brief Размер обрабатываемых данных. */
+   size_t size;
+  /*! \brief Используемый порядок байт. */
+   int oc;
+ } *ak_ctr_worker;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока: гаммирование фрагмента данных с собственным значением счетчика. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_bckey_context_ctr_worker( void *ptr )
+{
+  ak_ctr_worker worker = ( ak_ctr_worker )ptr;
+  ak_bckey_context_ctr_process( worker->bkey, (ak_uint8 *)worker->counter,
+                                    worker->in, worker->out, worker->size, worker->oc );
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует режим гаммирования с разделением обрабатываемых данных между несколькими
+    потоками. Все потоки используют один и тот же ключ; каждый поток
+    получает собственное значение счетчика, увеличенное на количество блоков, предшествующих
+    обрабатываемому им фрагменту. Результат совпадает с результатом функции
+    ak_bckey_context_ctr(), вызванной для тех же данных.
+
+    Количество потоков определяется опцией `ctr_thread_count` (нулевое значение опции означает
+    количество доступных процессоров). Каждому потоку передается не менее одного мегабайта
+    данных; если объем данных мал или библиотека собрана без поддержки pthread, то функция
+    вызывает ak_bckey_context_ctr().
+
+    Ресурс ключа уменьшается один раз, до запуска потоков, на суммарное количество блоков.
+    Значение синхропосылки, хранящееся в контексте ключа, изменяется только после завершения
+    всех потоков, поэтому данные могут обрабатываться фрагментами так же, как и в функции
+    ak_bckey_context_ctr(). На время работы потоков захватывается блокировка совместного
+    использования ключа, а маска ключа сменяется функцией ak_skey_context_remask_shared(),
+    поэтому функция может выполняться одновременно с функцией ak_ctr_context_update(),
+    использующей тот же ключ.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на входные данные.
+    @param out Указатель на область памяти, куда помещаются результаты
+    (этот указатель может совпадать с `in`).
+    @param size Размер обрабатываемых данных (в байтах).
+    @param iv Указатель на синхропосылку или NULL для продолжения обработки данных.
+    @param iv_size Длина синхропосылки в байтах.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_context_ctr_parallel( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                                     ak_pointer iv, size_t iv_size )
+{
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  ak_ctr_worker workers = NULL;
+  pthread_t *threads = NULL;
+  ak_int64 blocks = 0, tail = 0;
+  ak_uint64 offset = 0, count = 0, part = 0;
+  size_t i, started = 0;
+  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option( "openssl_compability" );
+  ak_int64 threads_count = ak_libakrypt_get_option( "ctr_thread_count" );
+
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to block cipher key" );
+  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
+                                          __func__ , "incorrect block size of block cipher key" );
+ /* определяем количество потоков */
+  if( threads_count <= 0 ) {
+   #ifdef _SC_NPROCESSORS_ONLN
+    threads_count = ( ak_int64 ) sysconf( _SC_NPROCESSORS_ONLN );
+   #endif
+    if( threads_count <= 0 ) threads_count = 1;
+  }
+  threads_count = ak_min( threads_count, ( ak_int64 )( size/ak_bckey_ctr_parallel_min_size ));
+  if( threads_count < 2 ) return ak_bckey_context_ctr( bkey, in, out, size, iv, iv_size );
+
+ /* устанавливаем синхропосылку (если она задана) */
+  if(( iv != NULL ) && ( iv_size != 0 )) {
+    if(( error = ak_bckey_context_ctr( bkey, in, out, 0, iv, iv_size )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect assigning of initial vector" );
+  }
+  if( bkey->key.flags&ak_key_flag_not_ctr )
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
+                                           "function call with undefined value of initial vector" );
+ /* проверяем целостность ключа и однократно уменьшаем его ресурс */
+  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                                   "incorrect integrity code of secret key value" );
+  blocks = ( ak_int64 )( size/bkey->bsize );
+  tail = ( ak_int64 )( size%bkey->bsize );
+  if(( error = ak_skey_context_decrement_resource( &bkey->key,
+                                               (ssize_t)( blocks + ( tail > 0 )))) != ak_error_ok )
+    return ak_error_message( error, __func__ , "low resource of block cipher key" );
+
+ /* создаем задания для потоков */
+  if(( workers = calloc(( size_t )threads_count, sizeof( struct ctr_worker ))) == NULL ) {
+    error = ak_error_message( ak_error_out_of_memory, __func__, "wrong allocation of workers" );
+    ak_skey_context_shared_unlock( &bkey->key );
+    goto lexit;
+  }
+  if(( threads = calloc(( size_t )threads_count, sizeof( pthread_t ))) == NULL ) {
+    error = ak_error_message( ak_error_out_of_memory, __func__, "wrong allocation of threads" );
+    ak_skey_context_shared_unlock( &bkey->key );
+    goto lexit;
+  }
+
+ /* делим данные на фрагменты, длины которых кратны 64 блокам (кроме последнего) */
+  part = ((( ak_uint64 )blocks/( ak_uint64 )threads_count ) + 63 )&( ~( ak_uint64 )63 );
+  for( i = 0; i < ( size_t )threads_count; i++ ) {
+     ak_ctr_worker worker = workers + i;
+
+     count = ( i == ( size_t )threads_count - 1 ) ? ( ak_uint64 )blocks - offset :
+                                                     ak_min( part, ( ak_uint64 )blocks - offset );
+     worker->bkey = bkey;
+     worker->oc = oc;
+     memcpy( worker->counter, bkey->ivector, bkey->bsize );
+     ak_bckey_context_ctr_increment( bkey, (ak_uint8 *)worker->counter, offset, oc );
+     worker->in = ( ak_uint8 *)in + offset*bkey->bsize;
+     worker->out = ( ak_uint8 *)out + offset*bkey->bsize;
+     worker->size = ( size_t )( count*bkey->bsize );
+     if( i == ( size_t )threads_count - 1 ) worker->size += ( size_t )tail;
+     offset += count;
+  }
+
+ /* запускаем потоки и дожидаемся их завершения */
+  for( i = 0; i < ( size_t )threads_count; i++, started++ )
+     if( pthread_create( threads+i, NULL, ak_bckey_context_ctr_worker, workers+i ) != 0 ) {
+       error = ak_error_message( ak_error_undefined_function, __func__,
+                                                                 "wrong creation of worker thread" );
+       break;
+     }
+  for( i = 0; i < started; i++ ) pthread_join( threads[i], NULL );
+  ak_skey_context_shared_unlock( &bkey->key );
+
+ /* однократно изменяем состояние синхропосылки в контексте ключа */
+  if( error == ak_error_ok ) {
+    if( tail ) {
+      memset( bkey->ivector, 0, sizeof( bkey->ivector ));
+      bkey->key.flags |= ak_key_flag_not_ctr;
+    } else ak_bckey_context_ctr_increment( bkey, bkey->ivector, ( ak_uint64 )blocks, oc );
+  }
+
+  lexit:
+   if( workers != NULL ) {
+     memset( workers, 0, ( size_t )threads_count*sizeof( struct ctr_worker ));
+     free( workers );
+   }
+   if( threads != NULL ) free( threads );
+
+ /* перемаскируем ключ */
+  if( ak_skey_context_remask_shared( &bkey->key, blocks + ( tail > 0 )) != ak_error_ok )
+    ak_error_message( ak_error_get_value(), __func__ , "wrong remasking of secret key" );
+
  return error;
+#else
+ return ak_bckey_context_ctr( bkey, in, out, size, iv, iv_size );
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует режим гаммирования для фрагмента сообщения, начинающегося с байта
+    с номером `offset`. Значение счетчика вычисляется непосредственно по синхропосылке и
+    смещению, поэтому для обработки фрагмента не требуется выработка гаммы для всех
+    предшествующих ему данных. Результат совпадает с соответствующим фрагментом результата функции
+    ak_bckey_context_ctr(), вызванной для всего сообщения.
+
+    Смещение `offset` может быть не кратно длине блока: в этом случае первый блок фрагмента
+    обрабатывается частично. Так же, как и в функции ak_bckey_context_ctr(), неполный последний блок
+    фрагмента рассматривается как последний блок всего сообщения. Таким образом, фрагмент должен
+    либо заканчиваться на границе блока, либо совпадать с окончанием сообщения.
+
+\code
+ // зашифрование сообщения за один вызов
+  ak_bckey_context_ctr( &key, in, out, size, iv, 8 );
+
+ // расшифрование произвольного фрагмента сообщения
+  ak_bckey_context_ctr_offset( &key, out+offset, buffer, size-offset, offset, iv, 8 );
+\endcode
+
+    Если фрагмент заканчивается на границе блока, то после завершения работы функции обработка
+    данных может быть продолжена вызовом ak_bckey_context_ctr() с неопределенной синхропосылкой.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на входные данные фрагмента.
+    @param out Указатель на область памяти, куда помещаются результаты
+    (этот указатель может совпадать с `in`).
+    @param size Размер обрабатываемого фрагмента (в байтах).
+    @param offset Смещение фрагмента (в байтах) относительно начала сообщения.
+    @param iv Указатель на синхропосылку, использованную для всего сообщения.
+    @param iv_size Длина синхропосылки в байтах.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_context_ctr_offset( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                               ak_uint64 offset, ak_pointer iv, size_t iv_size )
+{
+  size_t i, head, tail, len;
+  ak_uint64 yaout[2];
+  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option( "openssl_compability" );
+
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to block cipher key" );
+  if(( iv == NULL ) || ( iv_size == 0 )) return ak_error_message( ak_error_null_pointer,
+                                                  __func__, "using null pointer to initial vector" );
+  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
+                                          __func__ , "incorrect block size of block cipher key" );
+
+ /* устанавливаем синхропосылку и переходим к блоку, содержащему первый байт фрагмента */
+  if(( error = ak_bckey_context_ctr( bkey, in, out, 0, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect assigning of initial vector" );
+  ak_bckey_context_ctr_increment( bkey, bkey->ivector, offset/bkey->bsize, oc );
+  if(( head = ( size_t )( offset%bkey->bsize )) == 0 )
+    return ak_bckey_context_ctr( bkey, in, out, size, NULL, 0 );
+  if( size == 0 ) { /* позиция внутри блока не может быть использована для продолжения */
+    bkey->key.flags |= ak_key_flag_not_ctr;
+    return ak_error_ok;
+  }
+
+ /* обрабатываем первый, неполный блок фрагмента */
+  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                                   "incorrect integrity code of secret key value" );
+  if(( error = ak_skey_context_decrement_resource( &bkey->key, 1 )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "low resource of block cipher key" );
+
+  len = ak_min( size, bkey->bsize - head );
+  bkey->encrypt( &bkey->key, bkey->ivector, yaout );
+  if(( tail = head + len ) < bkey->bsize ) {
+   /* фрагмент заканчивается внутри блока - это последний блок сообщения,
+      он обрабатывается так же, как и в функции ak_bckey_context_ctr() */
+    for( i = head; i < tail; i++ )
+       ((ak_uint8 *)out)[i-head] = ((ak_uint8 *)in)[i-head]^
+                                         ((ak_uint8 *)yaout)[ oc ? i : bkey->bsize - tail + i ];
+    memset( bkey->ivector, 0, sizeof( bkey->ivector ));
+    bkey->key.flags |= ak_key_flag_not_ctr;
+  } else {
+    for( i = head; i < bkey->bsize; i++ )
+       ((ak_uint8 *)out)[i-head] = ((ak_uint8 *)in)[i-head]^((ak_uint8 *)yaout)[i];
+    ak_bckey_context_ctr_increment( bkey, bkey->ivector, 1, oc );
+  }
+  memset( yaout, 0, sizeof( yaout ));
+
+ /* перемаскируем ключ */
+  if(( error = ak_skey_context_remask( &bkey->key, 1 )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "wrong remasking of secret key" );
+
+ /* обрабатываем оставшиеся данные, начинающиеся на границе блока */
+  if( size == len ) return ak_error_ok;
+ return ak_bckey_context_ctr( bkey, (ak_uint8 *)in + len, (ak_uint8 *)out + len,
+                                                                             size - len, NULL, 0 );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -687,7 +1264,8 @@
                                            __func__ , "incorrect block size of block cipher key" );
    }
   /* перемаскируем ключ */
-   if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+   if(( error = ak_skey_context_remask( &bkey->key,
+                                            (ak_int64)( size/bkey->bsize ))) != ak_error_ok )
      ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
   return ak_error_ok;
@@ -697,8 +1275,8 @@
  int ak_bckey_context_decrypt_cbc( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
                                    ak_pointer iv, size_t iv_size )
  {
-  ak_int64 blocks = 0;
-  ak_uint64 yaout[2], z = iv_size / bkey->bsize;
+  ak_int64 blocks = 0, i, n;
+  ak_uint64 yaout[64], z = iv_size / bkey->bsize;
   ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, *ivector = (ak_uint64 *)bkey->ivector;
   int error = ak_error_ok, oc = (int) ak_libakrypt_get_option( "openssl_compability" );
 
@@ -733,28 +1311,36 @@
   switch( bkey->bsize ) {
     case  8: /* шифр с длиной блока 64 бита */
       while( blocks > 0 ) {
-          bkey->decrypt( &bkey->key, inptr, yaout );
-          if( z == 0 ) {
-              ivector = (ak_uint64 *)in;
+         /* расшифровываем сразу несколько блоков */
+          n = ak_min( blocks, 64 );
+          ak_bckey_context_decrypt_blocks( bkey, inptr, yaout, (size_t) n );
+          for( i = 0; i < n; i++ ) {
+             if( z == 0 ) {
+                 ivector = (ak_uint64 *)in;
+             }
+             *outptr = yaout[i] ^ *ivector; outptr++; ivector++;
+             --z;
           }
-          *outptr = yaout[0] ^ *ivector; outptr++; ivector++;
-          inptr++;
-          --blocks;
-          --z;
+          inptr += n;
+          blocks -= n;
       }
     break;
 
     case 16: /* шифр с длиной блока 128 бит */
       while( blocks > 0 ) {
-          bkey->decrypt( &bkey->key, inptr, yaout );
-          if( z == 0 ) {
-              ivector = (ak_uint64 *)in;
+         /* расшифровываем сразу несколько блоков */
+          n = ak_min( blocks, 32 );
+          ak_bckey_context_decrypt_blocks( bkey, inptr, yaout, (size_t) n );
+          for( i = 0; i < n; i++ ) {
+             if( z == 0 ) {
+                 ivector = (ak_uint64 *)in;
+             }
+             *outptr = yaout[2*i] ^ *ivector; outptr++; ivector++;
+             *outptr = yaout[2*i+1] ^ *ivector; outptr++; ivector++;
+             --z;
           }
-          *outptr = yaout[0] ^ *ivector; outptr++; ivector++;
-          *outptr = yaout[1] ^ *ivector; outptr++; ivector++;
-          inptr+=2;
-          --blocks;
-          --z;
+          inptr += 2*n;
+          blocks -= n;
       }
 
     break;
@@ -762,7 +1348,8 @@
                                           __func__ , "incorrect block size of block cipher key" );
   }
  /* перемаскируем ключ */
-  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+  if(( error = ak_skey_context_remask( &bkey->key,
+                                            (ak_int64)( size/bkey->bsize ))) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
 
  return ak_error_ok;
@@ -24,6 +24,8 @@ extern "C" {
  typedef int ( ak_function_bckey_create ) ( ak_bckey );
 /*! \brief Функция зашифрования/расширования одного блока информации. */
  typedef void ( ak_function_bckey )( ak_skey, ak_pointer, ak_pointer );
+/*! \brief Функция зашифрования/расширования нескольких последовательно расположенных блоков информации. */
+ typedef void ( ak_function_bckey_blocks )( ak_skey, ak_pointer, ak_pointer, size_t );
 /*! \brief Функция, предназначенная для зашифрования/расшифрования области памяти заданного размера */
  typedef int ( ak_function_bckey_encrypt )( ak_bckey, ak_pointer, ak_pointer, size_t,
                                                                                 ak_pointer, size_t );
@@ -44,6 +46,12 @@ extern "C" {
    ak_function_bckey *encrypt;
   /*! \brief Функция расширования одного блока информации. */
    ak_function_bckey *decrypt;
+  /*! \brief Функция зашифрования нескольких независимых блоков информации.
+      \details Может принимать значение NULL; в этом случае блоки зашифровываются по одному. */
+   ak_function_bckey_blocks *encrypt_blocks;
+  /*! \brief Функция расшифрования нескольких независимых блоков информации.
+      \details Может принимать значение NULL; в этом случае блоки расшифровываются по одному. */
+   ak_function_bckey_blocks *decrypt_blocks;
   /*! \brief Функция развертки ключа. */
    ak_function_skey *schedule_keys;
   /*! \brief Функция уничтожения развернутых ключей. */
@@ -81,6 +89,12 @@ extern "C" {
     из рекомендаций Р 1323565.1.012-2018. */
  int ak_bckey_context_next_acpkm_key( ak_bckey );
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Зашифрование нескольких последовательно расположенных блоков информации. */
+ void ak_bckey_context_encrypt_blocks( ak_bckey , ak_pointer , ak_pointer , size_t );
+/*! \brief Расшифрование нескольких последовательно расположенных блоков информации. */
+ void ak_bckey_context_decrypt_blocks( ak_bckey , ak_pointer , ak_pointer , size_t );
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Зашифрование данных в режиме простой замены (electronic codebook, ecb). */
  int ak_bckey_context_encrypt_ecb( ak_bckey , ak_pointer , ak_pointer , size_t );
@@ -88,6 +102,12 @@ extern "C" {
  int ak_bckey_context_decrypt_ecb( ak_bckey , ak_pointer , ak_pointer , size_t );
 /*! \brief Шифрование данных в режиме гаммирования из ГОСТ Р 34.13-2015 (counter mode, ctr). */
  int ak_bckey_context_ctr( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
+/*! \brief Шифрование данных в режиме гаммирования с использованием нескольких потоков. */
+ int ak_bckey_context_ctr_parallel( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer ,
+                                                                                         size_t );
+/*! \brief Шифрование фрагмента сообщения в режиме гаммирования с заданного смещения. */
+ int ak_bckey_context_ctr_offset( ak_bckey , ak_pointer , ak_pointer , size_t , ak_uint64 ,
+                                                                             ak_pointer , size_t );
  /*! \brief Зашифрование данных в режиме простой замены с зацеплением из ГОСТ Р 34.13-2015 (cbc). */
  int ak_bckey_context_encrypt_cbc( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
  /*! \brief Расшифрование данных в режиме простой замены с зацеплением из ГОСТ Р 34.13-2015 (cbc). */
@@ -99,6 +119,68 @@ extern "C" {
  int ak_bckey_context_cmac( ak_bckey , ak_pointer , const size_t , ak_pointer , const size_t );
 
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Контекст режима гаммирования.
+    \details Контекст хранит текущее значение счетчика одного потока данных, что позволяет
+    использовать один ключ одновременно в нескольких потоках выполнения. Значение счетчика
+    хранится в том же формате, что и в буффере `ivector` контекста ключа. */
+ typedef struct ctr_ctx {
+  /*! \brief Текущее значение счетчика. */
+   ak_uint64 counter[2];
+  /*! \brief Размер блока алгоритма блочного шифрования, для которого инициализирован контекст. */
+   size_t bsize;
+  /*! \brief Флаги, определяющие текущее состояние контекста. */
+   ak_uint32 flags;
+ } *ak_ctr_ctx;
+
+/*! \brief Инициализация контекста режима гаммирования значением синхропосылки. */
+ int ak_ctr_context_clean( ak_ctr_ctx , ak_bckey , const ak_pointer , const size_t );
+/*! \brief Гаммирование фрагмента данных с использованием контекста режима гаммирования. */
+ int ak_ctr_context_update( ak_ctr_ctx , ak_bckey , const ak_pointer , ak_pointer , const size_t );
+
+/*! \brief Контекст режима аутентифицированного шифрования MGM (Р 1323565.1.026-2019).
+    \details Контекст хранит промежуточные значения, позволяющие обрабатывать ассоциированные
+    и шифруемые данные фрагментами. Все значения хранятся в порядке байт little endian. */
+ typedef struct mgm_ctx {
+  /*! \brief Текущее значение накапливаемой суммы (имитовставки до зашифрования). */
+   ak_uint64 sum[2];
+  /*! \brief Текущее значение счетчика, используемого для выработки гаммы. */
+   ak_uint64 ycount[2];
+  /*! \brief Текущее значение счетчика, используемого для выработки множителей. */
+   ak_uint64 zcount[2];
+  /*! \brief Длина обработанных ассоциированных данных (в битах). */
+   ak_uint64 abitlen;
+  /*! \brief Длина обработанных шифруемых данных (в битах). */
+   ak_uint64 pbitlen;
+  /*! \brief Размер блока алгоритма блочного шифрования, для которого инициализирован контекст. */
+   size_t bsize;
+  /*! \brief Флаги, определяющие текущее состояние контекста. */
+   ak_uint32 flags;
+ } *ak_mgm_ctx;
+
+/*! \brief Инициализация контекста режима MGM значением синхропосылки. */
+ int ak_mgm_context_clean( ak_mgm_ctx , ak_bckey , const ak_pointer , const size_t );
+/*! \brief Обработка фрагмента ассоциированных данных в режиме MGM. */
+ int ak_mgm_context_authentication_update( ak_mgm_ctx , ak_bckey , const ak_pointer ,
+                                                                                   const size_t );
+/*! \brief Зашифрование фрагмента данных в режиме MGM. */
+ int ak_mgm_context_encryption_update( ak_mgm_ctx , ak_bckey , const ak_pointer , ak_pointer ,
+                                                                                   const size_t );
+/*! \brief Расшифрование фрагмента данных в режиме MGM. */
+ int ak_mgm_context_decryption_update( ak_mgm_ctx , ak_bckey , const ak_pointer , ak_pointer ,
+                                                                                   const size_t );
+/*! \brief Завершение вычислений и выработка имитовставки в режиме MGM. */
+ int ak_mgm_context_finalize( ak_mgm_ctx , ak_bckey , ak_pointer , const size_t );
+
+/*! \brief Зашифрование данных и выработка имитовставки в режиме MGM. */
+ int ak_bckey_context_encrypt_mgm( ak_bckey , const ak_pointer , const size_t , const ak_pointer ,
+                      ak_pointer , const size_t , const ak_pointer , const size_t , ak_pointer ,
+                                                                                   const size_t );
+/*! \brief Расшифрование данных и проверка имитовставки в режиме MGM. */
+ int ak_bckey_context_decrypt_mgm( ak_bckey , const ak_pointer , const size_t , const ak_pointer ,
+                      ak_pointer , const size_t , const ak_pointer , const size_t , ak_pointer ,
+                                                                                   const size_t );
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Выработка матрицы, соответствующей 16 тактам работы линейного региста сдвига. */
  void ak_bckey_context_kuznechik_generate_matrix( const linear_register , linear_matrix );
@@ -111,6 +193,8 @@ extern "C" {
  int ak_bckey_context_kuznechik_init_tables( const linear_register , const sbox , ak_kuznechik_params );
 /*! \brief Инициализация внутренних переменных значениями, регламентируемыми ГОСТ Р 34.12-2015. */
  int ak_bckey_context_kuznechik_init_gost_tables( void );
+/*! \brief Выбор векторной реализации алгоритма Кузнечик, если она была собрана. */
+ int ak_bckey_context_kuznechik_init_vector_implementation( void );
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Тестирование корректной работы алгоритма блочного шифрования Магма (ГОСТ Р 34.12-2015). */
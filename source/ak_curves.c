@@ -15,6 +15,9 @@
 #ifdef LIBAKRYPT_HAVE_STRINGS_H
  #include <strings.h>
 #endif
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ #include <pthread.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция вычисляет величину \f$\Delta \equiv -16(4a^3 + 27b^2) \pmod{p} \f$, зависящую
@@ -160,6 +163,11 @@
   if( ak_wpoint_is_ok( &wp, ec ) != ak_true )
     return ak_error_message( ak_error_curve_point, __func__ ,
                                                "elliptic curve parameters has incorrect point" );
+ /* если кривая имеет эквивалентную скрученную кривую Эдвардса, проверяем ее параметры,
+    поскольку именно они используются при вычислении кратных точек */
+  if( ak_wcurve_get_tcurve( ec ) != NULL )
+    if(( error = ak_tcurve_is_ok( ak_wcurve_get_tcurve( ec ))) != ak_error_ok )
+      return ak_error_message( error, __func__ , "incorrect twisted Edwards curve parameters" );
   if( ak_wpoint_check_order( &wp, ec ) != ak_true )
     return ak_error_message( ak_error_curve_point_order, __func__ ,
                                                          "elliptic curve point has wrong order" );
@@ -170,6 +178,102 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция помещает в переменную one единицу кольца вычетов по модулю \f$ p \f$
+    в представлении Монтгомери.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_wcurve_set_one( ak_uint64 *one, ak_wcurve ec )
+{
+  ak_mpznmax u = ak_mpznmax_one;
+  ak_mpzn_mul_montgomery( one, ec->r2, u, ec->p, ec->n, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция просматривает известные библиотеке скрученные кривые Эдвардса и возвращает ту,
+    которая бирационально эквивалентна заданной кривой.
+
+    @param ec Эллиптическая кривая в короткой форме Вейерштрасса.
+    @return Указатель на параметры скрученной кривой Эдвардса или NULL, если для заданной
+    кривой такие параметры не определены.                                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_tcurve ak_wcurve_get_tcurve( ak_wcurve ec )
+{
+  size_t i = 0;
+  static const struct tcurve *tcurves[] = {
+    &id_tc26_gost_3410_2012_256_paramSetA_twisted,
+    &id_tc26_gost_3410_2012_512_paramSetC_twisted
+  };
+
+  for( i = 0; i < sizeof( tcurves )/sizeof( tcurves[0] ); i++ )
+     if( tcurves[i]->wc == ec ) return tcurves[i];
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция проверяет, что параметры скрученной кривой Эдвардса согласованы между собой и
+    с параметрами кривой в форме Вейерштрасса, то есть выполнены сравнения
+    \f$ 4s \equiv e - d \f$, \f$ 6t \equiv e + d \f$, \f$ a \equiv s^2 - 3t^2 \f$,
+    \f$ b \equiv 2t^3 - ts^2 \pmod{p} \f$. Кроме того, проверяется, что \f$ d \f$ не является
+    квадратом по модулю \f$ p \f$, что гарантирует полноту формул сложения точек.
+
+    @param tc Параметры скрученной кривой Эдвардса.
+    @return В случае успешной проверки возвращается \ref ak_error_ok (ноль).
+    В противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_tcurve_is_ok( ak_tcurve tc )
+{
+  size_t i = 0;
+  ak_wcurve ec = NULL;
+  ak_mpznmax u1, u2, u3, one;
+
+  if( tc == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                 "using null pointer to twisted Edwards curve" );
+  ec = tc->wc;
+
+ /* 4s = e - d */
+  ak_mpzn_sub( u1, ( ak_uint64 *)tc->e, ( ak_uint64 *)tc->d, ec->size );
+  if( ak_mpzn_cmp( ( ak_uint64 *)tc->e, ( ak_uint64 *)tc->d, ec->size ) < 0 )
+    ak_mpzn_add( u1, u1, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( u2, ( ak_uint64 *)tc->s, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( u2, u2, ec->p, ec->size );
+  if( ak_mpzn_cmp( u1, u2, ec->size )) goto lexit;
+
+ /* 6t = e + d */
+  ak_mpzn_add_montgomery( u1, ( ak_uint64 *)tc->e, ( ak_uint64 *)tc->d, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( u2, ( ak_uint64 *)tc->t, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( u3, u2, ec->p, ec->size );
+  ak_mpzn_add_montgomery( u2, u2, u3, ec->p, ec->size );
+  if( ak_mpzn_cmp( u1, u2, ec->size )) goto lexit;
+
+ /* a = s^2 - 3t^2 */
+  ak_mpzn_mul_montgomery( u1, ( ak_uint64 *)tc->s, ( ak_uint64 *)tc->s, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u2, ( ak_uint64 *)tc->t, ( ak_uint64 *)tc->t, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u3, u2, ec->p, ec->size );
+  ak_mpzn_add_montgomery( u3, u3, u2, ec->p, ec->size );
+  ak_mpzn_add_montgomery( u3, u3, ec->a, ec->p, ec->size );
+  if( ak_mpzn_cmp( u1, u3, ec->size )) goto lexit;
+
+ /* b = 2t^3 - ts^2 */
+  ak_mpzn_mul_montgomery( u2, u2, ( ak_uint64 *)tc->t, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u2, u2, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u1, u1, ( ak_uint64 *)tc->t, ec->p, ec->n, ec->size );
+  ak_mpzn_add_montgomery( u1, u1, ec->b, ec->p, ec->size );
+  if( ak_mpzn_cmp( u1, u2, ec->size )) goto lexit;
+
+ /* d^{(p-1)/2} = -1 */
+  ak_mpzn_set( u1, ec->p, ec->size );
+  for( i = 0; i < ec->size-1; i++ ) u1[i] = ( u1[i] >> 1 )^( u1[i+1] << 63 );
+  u1[ec->size-1] >>= 1;
+  ak_mpzn_modpow_montgomery( u2, ( ak_uint64 *)tc->d, u1, ec->p, ec->n, ec->size );
+  ak_wcurve_set_one( one, ec );
+  ak_mpzn_add_montgomery( u2, u2, one, ec->p, ec->size );
+  if( ak_mpzn_cmp_ui( u2, ec->size, 0 ) == ak_true ) return ak_error_ok;
+
+ lexit:
+ return ak_error_message( ak_error_curve_order_parameters, __func__ ,
+                                           "twisted Edwards curve has inconsistent parameters" );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция выводит в файл аудита значения параметров эллиптической кривой                  */
 /* ----------------------------------------------------------------------------------------------- */
@@ -570,13 +674,527 @@
  ak_mpzn_set_ui( wp->z, ec->size, 1 );
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                       арифметика точек в координатах Якоби                                      */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Указатель на функцию удвоения точки, заданной в координатах Якоби. */
+ typedef void ( ak_function_wpoint_double )( ak_wpoint , ak_wcurve );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет разность \f$ z \equiv x - y \pmod{p} \f$ вычетов,
+    меньших модуля эллиптической кривой.                                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_wpoint_jacobian_sub( ak_uint64 *z, ak_uint64 *x, ak_uint64 *y,
+                                                                                   ak_wcurve ec )
+{
+  if( ak_mpzn_sub( z, x, y, ec->size )) ak_mpzn_add( z, z, ec->p, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция переводит точку из проективных координат \f$ (x:y:z) \f$ в координаты Якоби
+    \f$ (X:Y:Z) = (xz:yz^2:z) \f$, для которых \f$ x/z = X/Z^2 \f$ и \f$ y/z = Y/Z^3 \f$.
+    Точки wj и wp могут совпадать.                                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_to_jacobian( ak_wpoint wj, ak_wpoint wp, ak_wcurve ec )
+{
+  ak_mpzn_mul_montgomery( wj->x, wp->x, wp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wj->y, wp->y, wp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wj->y, wj->y, wp->z, ec->p, ec->n, ec->size );
+  if( wj != wp ) ak_mpzn_set( wj->z, wp->z, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция переводит точку из координат Якоби \f$ (X:Y:Z) \f$ в проективные координаты
+    \f$ (x:y:z) = (XZ:Y:Z^3) \f$. Точки wp и wj могут совпадать.                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_from_jacobian( ak_wpoint wp, ak_wpoint wj, ak_wcurve ec )
+{
+  ak_mpznmax u;
+
+  if( ak_mpzn_cmp_ui( wj->z, ec->size, 0 ) == ak_true ) {
+    ak_wpoint_set_as_unit( wp, ec );
+    return;
+  }
+  ak_mpzn_mul_montgomery( u, wj->z, wj->z, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp->x, wj->x, wj->z, ec->p, ec->n, ec->size );
+  if( wp != wj ) ak_mpzn_set( wp->y, wj->y, ec->size );
+  ak_mpzn_mul_montgomery( wp->z, u, wj->z, ec->p, ec->n, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция приводит точку к аффинной форме и представляет ее так, что
+    координата \f$ z \f$ равна единице кольца вычетов в представлении Монтгомери.
+
+    \details Функция ak_wpoint_reduce() помещает в координату \f$ z \f$ значение 1, которое
+    в представлении Монтгомери соответствует вычету \f$ r^{-1} \f$. Домножение всех координат
+    на \f$ r_2 \f$ приводит точку к виду \f$ (x:y:1) \f$, одинаковому в проективных
+    координатах и координатах Якоби, что позволяет использовать ее в смешанном сложении
+    ak_wpoint_jacobian_add_mixed().                                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_jacobian_set_affine( ak_wpoint wp, ak_wcurve ec )
+{
+  ak_wpoint_reduce( wp, ec );
+  if( ak_mpzn_cmp_ui( wp->z, ec->size, 0 ) == ak_true ) return;
+  ak_mpzn_mul_montgomery( wp->x, wp->x, ec->r2, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp->y, wp->y, ec->r2, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp->z, wp->z, ec->r2, ec->p, ec->n, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Удвоение точки, заданной в координатах Якоби, для произвольного коэффициента \f$ a \f$.
+
+    \details Используются соотношения dbl-2007-bl (1M + 8S + 1*a),
+    см. <a href="https://hyperelliptic.org/EFD/g1p/auto-shortw-jacobian.html">Explicit-Formulas
+    Database</a>.
+
+    \code
+      XX = X1^2, YY = Y1^2, YYYY = YY^2, ZZ = Z1^2
+      S = 2*((X1+YY)^2-XX-YYYY)
+      M = 3*XX+a*ZZ^2
+      X3 = M^2-2*S
+      Y3 = M*(S-X3)-8*YYYY
+      Z3 = (Y1+Z1)^2-YY-ZZ
+    \endcode
+
+    Для бесконечно удаленной точки и точек второго порядка формулы дают \f$ Z_3 = 0 \f$.         */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_jacobian_double( ak_wpoint wp, ak_wcurve ec )
+{
+  ak_mpznmax u1, u2, u3, u4, u5, u6, u7;
+
+  ak_mpzn_mul_montgomery( u1, wp->x, wp->x, ec->p, ec->n, ec->size ); // u1 = XX
+  ak_mpzn_mul_montgomery( u2, wp->y, wp->y, ec->p, ec->n, ec->size ); // u2 = YY
+  ak_mpzn_mul_montgomery( u3, u2, u2, ec->p, ec->n, ec->size );       // u3 = YYYY
+  ak_mpzn_mul_montgomery( u4, wp->z, wp->z, ec->p, ec->n, ec->size ); // u4 = ZZ
+
+  ak_mpzn_add_montgomery( u5, wp->x, u2, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u5, u5, u5, ec->p, ec->n, ec->size );
+  ak_wpoint_jacobian_sub( u5, u5, u1, ec );
+  ak_wpoint_jacobian_sub( u5, u5, u3, ec );
+  ak_mpzn_lshift_montgomery( u5, u5, ec->p, ec->size );               // u5 = S
+
+  ak_mpzn_mul_montgomery( u6, u4, u4, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u6, u6, ec->a, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u7, u1, ec->p, ec->size );
+  ak_mpzn_add_montgomery( u7, u7, u1, ec->p, ec->size );
+  ak_mpzn_add_montgomery( u6, u6, u7, ec->p, ec->size );              // u6 = M
+
+  ak_mpzn_add_montgomery( u7, wp->y, wp->z, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u7, u7, u7, ec->p, ec->n, ec->size );
+  ak_wpoint_jacobian_sub( u7, u7, u2, ec );
+  ak_wpoint_jacobian_sub( wp->z, u7, u4, ec );
+
+  ak_mpzn_mul_montgomery( u7, u6, u6, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u1, u5, ec->p, ec->size );
+  ak_wpoint_jacobian_sub( wp->x, u7, u1, ec );
+
+  ak_wpoint_jacobian_sub( u7, u5, wp->x, ec );
+  ak_mpzn_mul_montgomery( u7, u6, u7, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u3, u3, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( u3, u3, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( u3, u3, ec->p, ec->size );
+  ak_wpoint_jacobian_sub( wp->y, u7, u3, ec );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Удвоение точки, заданной в координатах Якоби, для кривых с коэффициентом \f$ a = -3 \f$.
+
+    \details Используются соотношения dbl-2001-b (3M + 5S).
+
+    \code
+      delta = Z1^2, gamma = Y1^2, beta = X1*gamma
+      alpha = 3*(X1-delta)*(X1+delta)
+      X3 = alpha^2-8*beta
+      Z3 = (Y1+Z1)^2-gamma-delta
+      Y3 = alpha*(4*beta-X3)-8*gamma^2
+    \endcode                                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_jacobian_double_a3( ak_wpoint wp, ak_wcurve ec )
+{
+  ak_mpznmax u1, u2, u3, u4, u5, u6, u7;
+
+  ak_mpzn_mul_montgomery( u1, wp->z, wp->z, ec->p, ec->n, ec->size ); // u1 = delta
+  ak_mpzn_mul_montgomery( u2, wp->y, wp->y, ec->p, ec->n, ec->size ); // u2 = gamma
+  ak_mpzn_mul_montgomery( u3, wp->x, u2, ec->p, ec->n, ec->size );    // u3 = beta
+
+  ak_wpoint_jacobian_sub( u4, wp->x, u1, ec );
+  ak_mpzn_add_montgomery( u5, wp->x, u1, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u4, u4, u5, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u5, u4, ec->p, ec->size );
+  ak_mpzn_add_montgomery( u4, u4, u5, ec->p, ec->size );              // u4 = alpha
+
+  ak_mpzn_add_montgomery( u5, wp->y, wp->z, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u5, u5, u5, ec->p, ec->n, ec->size );
+  ak_wpoint_jacobian_sub( u5, u5, u2, ec );
+  ak_wpoint_jacobian_sub( wp->z, u5, u1, ec );
+
+  ak_mpzn_mul_montgomery( u5, u4, u4, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u6, u3, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( u6, u6, ec->p, ec->size );               // u6 = 4*beta
+  ak_mpzn_lshift_montgomery( u7, u6, ec->p, ec->size );
+  ak_wpoint_jacobian_sub( wp->x, u5, u7, ec );
+
+  ak_wpoint_jacobian_sub( u6, u6, wp->x, ec );
+  ak_mpzn_mul_montgomery( u6, u4, u6, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u2, u2, u2, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u2, u2, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( u2, u2, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( u2, u2, ec->p, ec->size );
+  ak_wpoint_jacobian_sub( wp->y, u6, u2, ec );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выбирает наиболее быстрые формулы удвоения точки в координатах Якоби
+    для заданной кривой.
+    \return Функция ak_wpoint_jacobian_double_a3(), если \f$ a \equiv -3 \pmod{p} \f$, и
+    функция ak_wpoint_jacobian_double() в противном случае.                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_function_wpoint_double *ak_wpoint_jacobian_double_function( ak_wcurve ec )
+{
+  ak_mpznmax e, t;
+
+ /* e - единица кольца вычетов в представлении Монтгомери, проверяем равенство a + 3e = 0 */
+  ak_wcurve_set_one( e, ec );
+  ak_mpzn_lshift_montgomery( t, e, ec->p, ec->size );
+  ak_mpzn_add_montgomery( t, t, e, ec->p, ec->size );
+  ak_mpzn_add_montgomery( t, t, ec->a, ec->p, ec->size );
+  if( ak_mpzn_cmp_ui( t, ec->size, 0 ) == ak_true ) return ak_wpoint_jacobian_double_a3;
+ return ak_wpoint_jacobian_double;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Сложение двух точек, заданных в координатах Якоби; результат помещается в wp1.
+
+    \details Используются соотношения add-2007-bl (11M + 5S).
+
+    \code
+      Z1Z1 = Z1^2, Z2Z2 = Z2^2, U1 = X1*Z2Z2, U2 = X2*Z1Z1
+      S1 = Y1*Z2*Z2Z2, S2 = Y2*Z1*Z1Z1, H = U2-U1, r = 2*(S2-S1)
+      I = (2*H)^2, J = H*I, V = U1*I
+      X3 = r^2-J-2*V
+      Y3 = r*(V-X3)-2*S1*J
+      Z3 = ((Z1+Z2)^2-Z1Z1-Z2Z2)*H
+    \endcode
+
+    Случаи бесконечно удаленных точек и совпадающих точек обрабатываются отдельно.               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_jacobian_add( ak_wpoint wp1, ak_wpoint wp2, ak_wcurve ec )
+{
+  ak_mpznmax u1, u2, u3, u4, u5, u6, u7, u8;
+
+  if( ak_mpzn_cmp_ui( wp2->z, ec->size, 0 ) == ak_true ) return;
+  if( ak_mpzn_cmp_ui( wp1->z, ec->size, 0 ) == ak_true ) {
+    ak_wpoint_set_wpoint( wp1, wp2, ec );
+    return;
+  }
+
+  ak_mpzn_mul_montgomery( u1, wp1->z, wp1->z, ec->p, ec->n, ec->size ); // u1 = Z1Z1
+  ak_mpzn_mul_montgomery( u2, wp2->z, wp2->z, ec->p, ec->n, ec->size ); // u2 = Z2Z2
+  ak_mpzn_mul_montgomery( u3, wp1->x, u2, ec->p, ec->n, ec->size );     // u3 = U1
+  ak_mpzn_mul_montgomery( u4, wp2->x, u1, ec->p, ec->n, ec->size );     // u4 = U2
+  ak_mpzn_mul_montgomery( u5, wp1->y, wp2->z, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u5, u5, u2, ec->p, ec->n, ec->size );         // u5 = S1
+  ak_mpzn_mul_montgomery( u6, wp2->y, wp1->z, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u6, u6, u1, ec->p, ec->n, ec->size );         // u6 = S2
+  ak_wpoint_jacobian_sub( u4, u4, u3, ec );                             // u4 = H
+  ak_wpoint_jacobian_sub( u6, u6, u5, ec );
+
+  if( ak_mpzn_cmp_ui( u4, ec->size, 0 ) == ak_true ) {
+    if( ak_mpzn_cmp_ui( u6, ec->size, 0 ) == ak_true ) ak_wpoint_jacobian_double( wp1, ec );
+     else ak_mpzn_set_ui( wp1->z, ec->size, 0 );
+    return;
+  }
+
+  ak_mpzn_lshift_montgomery( u6, u6, ec->p, ec->size );                 // u6 = r
+  ak_mpzn_lshift_montgomery( u7, u4, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u7, u7, u7, ec->p, ec->n, ec->size );         // u7 = I
+  ak_mpzn_mul_montgomery( u8, u4, u7, ec->p, ec->n, ec->size );         // u8 = J
+  ak_mpzn_mul_montgomery( u3, u3, u7, ec->p, ec->n, ec->size );         // u3 = V
+
+  ak_mpzn_add_montgomery( u7, wp1->z, wp2->z, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u7, u7, u7, ec->p, ec->n, ec->size );
+  ak_wpoint_jacobian_sub( u7, u7, u1, ec );
+  ak_wpoint_jacobian_sub( u7, u7, u2, ec );
+  ak_mpzn_mul_montgomery( wp1->z, u7, u4, ec->p, ec->n, ec->size );
+
+  ak_mpzn_mul_montgomery( u7, u6, u6, ec->p, ec->n, ec->size );
+  ak_wpoint_jacobian_sub( u7, u7, u8, ec );
+  ak_mpzn_lshift_montgomery( u1, u3, ec->p, ec->size );
+  ak_wpoint_jacobian_sub( wp1->x, u7, u1, ec );
+
+  ak_wpoint_jacobian_sub( u3, u3, wp1->x, ec );
+  ak_mpzn_mul_montgomery( u3, u6, u3, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u5, u5, u8, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u5, u5, ec->p, ec->size );
+  ak_wpoint_jacobian_sub( wp1->y, u3, u5, ec );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Смешанное сложение точки в координатах Якоби и точки, приведенной функцией
+    ak_wpoint_jacobian_set_affine(); результат помещается в wp1.
+
+    \details Используются соотношения madd-2007-bl (7M + 4S).
+
+    \code
+      Z1Z1 = Z1^2, U2 = X2*Z1Z1, S2 = Y2*Z1*Z1Z1
+      H = U2-X1, HH = H^2, I = 4*HH, J = H*I, r = 2*(S2-Y1), V = X1*I
+      X3 = r^2-J-2*V
+      Y3 = r*(V-X3)-2*Y1*J
+      Z3 = (Z1+H)^2-Z1Z1-HH
+    \endcode                                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_jacobian_add_mixed( ak_wpoint wp1, ak_wpoint wp2, ak_wcurve ec )
+{
+  ak_mpznmax u1, u2, u3, u4, u5, u6, u7;
+
+  if( ak_mpzn_cmp_ui( wp2->z, ec->size, 0 ) == ak_true ) return;
+  if( ak_mpzn_cmp_ui( wp1->z, ec->size, 0 ) == ak_true ) {
+    ak_wpoint_set_wpoint( wp1, wp2, ec );
+    return;
+  }
+
+  ak_mpzn_mul_montgomery( u1, wp1->z, wp1->z, ec->p, ec->n, ec->size ); // u1 = Z1Z1
+  ak_mpzn_mul_montgomery( u2, wp2->x, u1, ec->p, ec->n, ec->size );     // u2 = U2
+  ak_mpzn_mul_montgomery( u3, wp2->y, wp1->z, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u3, u3, u1, ec->p, ec->n, ec->size );         // u3 = S2
+  ak_wpoint_jacobian_sub( u2, u2, wp1->x, ec );                         // u2 = H
+  ak_wpoint_jacobian_sub( u3, u3, wp1->y, ec );
+
+  if( ak_mpzn_cmp_ui( u2, ec->size, 0 ) == ak_true ) {
+    if( ak_mpzn_cmp_ui( u3, ec->size, 0 ) == ak_true ) ak_wpoint_jacobian_double( wp1, ec );
+     else ak_mpzn_set_ui( wp1->z, ec->size, 0 );
+    return;
+  }
+
+  ak_mpzn_mul_montgomery( u4, u2, u2, ec->p, ec->n, ec->size );         // u4 = HH
+  ak_mpzn_lshift_montgomery( u5, u4, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( u5, u5, ec->p, ec->size );                 // u5 = I
+  ak_mpzn_mul_montgomery( u6, u2, u5, ec->p, ec->n, ec->size );         // u6 = J
+  ak_mpzn_lshift_montgomery( u3, u3, ec->p, ec->size );                 // u3 = r
+  ak_mpzn_mul_montgomery( u5, wp1->x, u5, ec->p, ec->n, ec->size );     // u5 = V
+
+  ak_mpzn_add_montgomery( u7, wp1->z, u2, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u7, u7, u7, ec->p, ec->n, ec->size );
+  ak_wpoint_jacobian_sub( u7, u7, u1, ec );
+  ak_wpoint_jacobian_sub( wp1->z, u7, u4, ec );
+
+  ak_mpzn_mul_montgomery( u7, u3, u3, ec->p, ec->n, ec->size );
+  ak_wpoint_jacobian_sub( u7, u7, u6, ec );
+  ak_mpzn_lshift_montgomery( u1, u5, ec->p, ec->size );
+  ak_wpoint_jacobian_sub( wp1->x, u7, u1, ec );
+
+  ak_wpoint_jacobian_sub( u5, u5, wp1->x, ec );
+  ak_mpzn_mul_montgomery( u5, u3, u5, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u6, wp1->y, u6, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u6, u6, ec->p, ec->size );
+  ak_wpoint_jacobian_sub( wp1->y, u5, u6, ec );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                   арифметика точек скрученных кривых Эдвардса                                   */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Точка скрученной кривой Эдвардса в расширенных координатах.
+    \details Точка \f$ (u, v) \f$ представляется вектором \f$ (X:Y:T:Z) \f$, для которого
+    \f$ u = X/Z,\ v = Y/Z,\ uv = T/Z \f$ (H.Hisil, K.Wong, G.Carter, E.Dawson,
+    <a href="https://eprint.iacr.org/2008/522">Twisted Edwards curves revisited</a>, 2008).    */
+/* ----------------------------------------------------------------------------------------------- */
+ typedef struct tpoint {
+  /*! \brief Координата \f$ X \f$. */
+   ak_uint64 x[ak_mpzn512_size];
+  /*! \brief Координата \f$ Y \f$. */
+   ak_uint64 y[ak_mpzn512_size];
+  /*! \brief Координата \f$ T \f$. */
+   ak_uint64 t[ak_mpzn512_size];
+  /*! \brief Координата \f$ Z \f$. */
+   ak_uint64 z[ak_mpzn512_size];
+ } *ak_tpoint;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция присваивает точке значение нейтрального элемента \f$ (0, 1) \f$.               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_tpoint_set_as_unit( ak_tpoint tp, ak_tcurve tc )
+{
+  ak_mpzn_set_ui( tp->x, tc->wc->size, 0 );
+  ak_mpzn_set_ui( tp->t, tc->wc->size, 0 );
+  ak_wcurve_set_one( tp->y, tc->wc );
+  ak_wcurve_set_one( tp->z, tc->wc );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция переводит точку \f$ (x:y:z) \f$ кривой в форме Вейерштрасса в точку
+    скрученной кривой Эдвардса.
+
+    \details Используется представление
+    \f$ X = (x-tz)(x-tz+sz),\ Y = y(x-tz-sz),\ T = (x-tz)(x-tz-sz),\ Z = y(x-tz+sz) \f$.
+    Преобразование не определено для точек порядка 2 и 4, не принадлежащих подгруппе
+    порядка \f$ q \f$.
+
+    @return Функция возвращает ak_false, если точка не может быть преобразована.                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_tpoint_set_wpoint( ak_tpoint tp, ak_wpoint wp, ak_tcurve tc )
+{
+  ak_wcurve ec = tc->wc;
+  ak_mpznmax u1, u2, u3, u4;
+
+  if( ak_mpzn_cmp_ui( wp->z, ec->size, 0 ) == ak_true ) {
+    ak_tpoint_set_as_unit( tp, tc );
+    return ak_true;
+  }
+
+  ak_mpzn_mul_montgomery( u1, ( ak_uint64 *)tc->t, wp->z, ec->p, ec->n, ec->size );
+  ak_wpoint_jacobian_sub( u1, wp->x, u1, ec );                           // u1 = x - tz
+  ak_mpzn_mul_montgomery( u2, ( ak_uint64 *)tc->s, wp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_add_montgomery( u3, u1, u2, ec->p, ec->size );                 // u3 = x - tz + sz
+  ak_wpoint_jacobian_sub( u4, u1, u2, ec );                              // u4 = x - tz - sz
+
+  ak_mpzn_mul_montgomery( tp->z, wp->y, u3, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( tp->x, u1, u3, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( tp->y, wp->y, u4, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( tp->t, u1, u4, ec->p, ec->n, ec->size );
+ return !ak_mpzn_cmp_ui( tp->z, ec->size, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция переводит точку скрученной кривой Эдвардса в проективную точку
+    кривой в форме Вейерштрасса.
+
+    \details Используется представление
+    \f$ x = (s(Z+Y) + t(Z-Y))X,\ y = s(Z+Y)Z,\ z = (Z-Y)X \f$. Для точек с \f$ X = 0 \f$
+    представление не определено: нейтральный элемент \f$ (0, 1) \f$ переходит в бесконечно
+    удаленную точку, а точка второго порядка \f$ (0, -1) \f$ - в точку \f$ (t:0:1) \f$.         */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_set_tpoint( ak_wpoint wp, ak_tpoint tp, ak_tcurve tc )
+{
+  ak_wcurve ec = tc->wc;
+  ak_mpznmax u1, u2, u3;
+
+  if( ak_mpzn_cmp_ui( tp->x, ec->size, 0 ) == ak_true ) {
+    if( ak_mpzn_cmp( tp->y, tp->z, ec->size ) == 0 ) ak_wpoint_set_as_unit( wp, ec );
+     else {
+      ak_mpzn_set( wp->x, ( ak_uint64 *)tc->t, ec->size );
+      ak_mpzn_set_ui( wp->y, ec->size, 0 );
+      ak_wcurve_set_one( wp->z, ec );
+     }
+    return;
+  }
+
+  ak_mpzn_add_montgomery( u1, tp->z, tp->y, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u1, ( ak_uint64 *)tc->s, u1, ec->p, ec->n, ec->size ); // u1 = s(Z+Y)
+  ak_wpoint_jacobian_sub( u2, tp->z, tp->y, ec );                                 // u2 = Z-Y
+  ak_mpzn_mul_montgomery( u3, ( ak_uint64 *)tc->t, u2, ec->p, ec->n, ec->size );
+  ak_mpzn_add_montgomery( u3, u3, u1, ec->p, ec->size );
+
+  ak_mpzn_mul_montgomery( wp->z, u2, tp->x, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp->x, u3, tp->x, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp->y, u1, tp->z, ec->p, ec->n, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Удвоение точки скрученной кривой Эдвардса.
+
+    \details Используются соотношения dbl-2008-hwcd (4M + 4S + 1*e).
+
+    \code
+      A = X1^2, B = Y1^2, C = 2*Z1^2, D = e*A
+      E = (X1+Y1)^2-A-B, G = D+B, F = G-C, H = D-B
+      X3 = E*F, Y3 = G*H, T3 = E*H, Z3 = F*G
+    \endcode                                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_tpoint_double( ak_tpoint tp, ak_tcurve tc )
+{
+  ak_wcurve ec = tc->wc;
+  ak_mpznmax u1, u2, u3, u4, u5, u6, u7;
+
+  ak_mpzn_mul_montgomery( u1, tp->x, tp->x, ec->p, ec->n, ec->size );             // u1 = A
+  ak_mpzn_mul_montgomery( u2, tp->y, tp->y, ec->p, ec->n, ec->size );             // u2 = B
+  ak_mpzn_mul_montgomery( u3, tp->z, tp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u3, u3, ec->p, ec->size );                           // u3 = C
+  ak_mpzn_mul_montgomery( u4, ( ak_uint64 *)tc->e, u1, ec->p, ec->n, ec->size );  // u4 = D
+  ak_mpzn_add_montgomery( u5, tp->x, tp->y, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u5, u5, u5, ec->p, ec->n, ec->size );
+  ak_wpoint_jacobian_sub( u5, u5, u1, ec );
+  ak_wpoint_jacobian_sub( u5, u5, u2, ec );                                        // u5 = E
+  ak_mpzn_add_montgomery( u6, u4, u2, ec->p, ec->size );                          // u6 = G
+  ak_wpoint_jacobian_sub( u7, u6, u3, ec );                                        // u7 = F
+  ak_wpoint_jacobian_sub( u4, u4, u2, ec );                                        // u4 = H
+
+  ak_mpzn_mul_montgomery( tp->x, u5, u7, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( tp->y, u6, u4, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( tp->t, u5, u4, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( tp->z, u7, u6, ec->p, ec->n, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Сложение двух точек скрученной кривой Эдвардса; результат помещается в tp1.
+
+    \details Используются соотношения add-2008-hwcd (9M + 1*e + 1*d). Поскольку \f$ e \f$
+    является квадратом, а \f$ d \f$ - нет, формулы полны: они верны для любых точек,
+    в том числе совпадающих и нейтральных, и выполняются без ветвлений.
+
+    \code
+      A = X1*X2, B = Y1*Y2, C = T1*d*T2, D = Z1*Z2
+      E = (X1+Y1)*(X2+Y2)-A-B, F = D-C, G = D+C, H = B-e*A
+      X3 = E*F, Y3 = G*H, T3 = E*H, Z3 = F*G
+    \endcode                                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_tpoint_add( ak_tpoint tp1, ak_tpoint tp2, ak_tcurve tc )
+{
+  ak_wcurve ec = tc->wc;
+  ak_mpznmax u1, u2, u3, u4, u5, u6;
+
+  ak_mpzn_mul_montgomery( u1, tp1->x, tp2->x, ec->p, ec->n, ec->size );           // u1 = A
+  ak_mpzn_mul_montgomery( u2, tp1->y, tp2->y, ec->p, ec->n, ec->size );           // u2 = B
+  ak_mpzn_mul_montgomery( u3, tp1->t, tp2->t, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u3, u3, ( ak_uint64 *)tc->d, ec->p, ec->n, ec->size );  // u3 = C
+  ak_mpzn_mul_montgomery( u4, tp1->z, tp2->z, ec->p, ec->n, ec->size );           // u4 = D
+  ak_mpzn_add_montgomery( u5, tp1->x, tp1->y, ec->p, ec->size );
+  ak_mpzn_add_montgomery( u6, tp2->x, tp2->y, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u5, u5, u6, ec->p, ec->n, ec->size );
+  ak_wpoint_jacobian_sub( u5, u5, u1, ec );
+  ak_wpoint_jacobian_sub( u5, u5, u2, ec );                                        // u5 = E
+  ak_wpoint_jacobian_sub( u6, u4, u3, ec );                                        // u6 = F
+  ak_mpzn_add_montgomery( u4, u4, u3, ec->p, ec->size );                          // u4 = G
+  ak_mpzn_mul_montgomery( u1, ( ak_uint64 *)tc->e, u1, ec->p, ec->n, ec->size );
+  ak_wpoint_jacobian_sub( u2, u2, u1, ec );                                        // u2 = H
+
+  ak_mpzn_mul_montgomery( tp1->x, u5, u6, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( tp1->y, u4, u2, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( tp1->t, u5, u2, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( tp1->z, u6, u4, ec->p, ec->n, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление кратной точки скрученной кривой Эдвардса методом лесенки Монтгомери.     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_tpoint_pow( ak_tpoint tq, ak_tpoint tp, ak_uint64 *k, size_t size, ak_tcurve tc )
+{
+  ak_uint64 uk = 0;
+  long long int i, j;
+  struct tpoint Q, R;
+
+  ak_tpoint_set_as_unit( &Q, tc );
+  memcpy( &R, tp, sizeof( struct tpoint ));
+  for( i = size-1; i >= 0; i-- ) {
+     uk = k[i];
+     for( j = 0; j < 64; j++ ) {
+       if( uk&0x8000000000000000LL ) { ak_tpoint_add( &Q, &R, tc ); ak_tpoint_double( &R, tc ); }
+        else { ak_tpoint_add( &R, &Q, tc ); ak_tpoint_double( &Q, tc ); }
+       uk <<= 1;
+     }
+  }
+  memcpy( tq, &Q, sizeof( struct tpoint ));
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Для заданной точки \f$ P = (x:y:z) \f$ и заданного целого числа (вычета) \f$ k \f$
     функция вычисляет кратную точку \f$ Q \f$, удовлетворяющую
     равенству \f$  Q = [k]P = \underbrace{P+ \cdots + P}_{k}\f$.
 
     При вычислении используется метод `лесенки Монтгомери`, выравнивающий время работы алгоритма
-    вне зависимости от вида числа \f$ k \f$.
+    вне зависимости от вида числа \f$ k \f$. Промежуточные вычисления выполняются
+    в координатах Якоби; для кривых с коэффициентом \f$ a = -3 \f$ используются
+    специальные формулы удвоения. Для кривых, эквивалентных скрученным кривым Эдвардса
+    (см. ak_wcurve_get_tcurve()), вычисления выполняются на кривой Эдвардса.
 
     \b Для \b информации:
      \li Функция не приводит результирующую точку \f$ Q \f$ к аффинной форме.
@@ -595,22 +1213,538 @@
   ak_uint64 uk = 0;
   long long int i, j;
   struct wpoint Q, R; /* две точки из лесенки Монтгомери */
+  ak_function_wpoint_double *dbl = NULL;
+  ak_tcurve tc = ak_wcurve_get_tcurve( ec );
+
+ /* для скрученных кривых Эдвардса используем полные формулы сложения */
+  if( tc != NULL ) {
+    struct tpoint tp;
+    if( ak_tpoint_set_wpoint( &tp, wp, tc )) {
+      ak_tpoint_pow( &tp, &tp, k, size, tc );
+      ak_wpoint_set_tpoint( wq, &tp, tc );
+      return;
+    }
+  }
+  dbl = ak_wpoint_jacobian_double_function( ec );
 
  /* начальные значения для переменных */
   ak_wpoint_set_as_unit( &Q, ec );
-  ak_wpoint_set_wpoint( &R, wp, ec );
+  ak_wpoint_to_jacobian( &R, wp, ec );
 
  /* полный цикл по всем(!) битам числа k */
   for( i = size-1; i >= 0; i-- ) {
      uk = k[i];
      for( j = 0; j < 64; j++ ) {
-       if( uk&0x8000000000000000LL ) { ak_wpoint_add( &Q, &R, ec ); ak_wpoint_double( &R, ec ); }
-        else { ak_wpoint_add( &R, &Q, ec ); ak_wpoint_double( &Q, ec ); }
+       if( uk&0x8000000000000000LL ) { ak_wpoint_jacobian_add( &Q, &R, ec ); dbl( &R, ec ); }
+        else { ak_wpoint_jacobian_add( &R, &Q, ec ); dbl( &Q, ec ); }
        uk <<= 1;
      }
   }
  /* копируем полученный результат */
-  ak_wpoint_set_wpoint( wq, &Q, ec );
+  ak_wpoint_from_jacobian( wq, &Q, ec );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                  вычисление кратных точек образующей с помощью метода гребенки                  */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Ширина гребенки (количество зубцов) при вычислении кратных образующей точки. */
+ #define ak_wpoint_comb_width        ( 4 )
+/*! \brief Количество точек в таблице предвычислений метода гребенки. */
+ #define ak_wpoint_comb_table_size   ( 1 << ak_wpoint_comb_width )
+/*! \brief Максимальное количество кривых, для которых хранятся таблицы предвычислений. */
+ #define ak_wpoint_comb_curves_count ( 16 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Таблица предвычислений для образующей точки одной эллиптической кривой.
+    \details Для кривой с длиной параметров \f$ n = 64\cdot\texttt{size} \f$ бит определим
+    \f$ d = n/4 \f$. Тогда точка с номером \f$ j = j_0 + 2j_1 + 4j_2 + 8j_3 \f$ равна
+    \f$ \sum_{i=0}^{3} j_i [2^{id}]P \f$ и хранится в аффинной форме, приведенной
+    функцией ak_wpoint_jacobian_set_affine() для смешанного сложения. Для кривых, эквивалентных
+    скрученным кривым Эдвардса, таблица содержит соответствующие точки кривой Эдвардса.
+
+    Для остальных кривых нулевая точка таблицы (бесконечно удаленная точка) заменяется
+    начальной точкой вычислений \f$ S \f$, равной последней точке таблицы, а в поле `offset`
+    хранится точка \f$ -[2^d]S \f$, см. ak_wpoint_pow_base().                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ typedef struct wpoint_comb {
+  /*! \brief Параметры кривой, доступные через механизм OID, для которых вычислена таблица. */
+   ak_wcurve wc;
+  /*! \brief Скрученная кривая Эдвардса, если таблица содержит ее точки, или NULL. */
+   ak_tcurve tc;
+  /*! \brief Точки таблицы. */
+   union {
+    /*! \brief Точки кривой в форме Вейерштрасса. */
+     struct wpoint w[ak_wpoint_comb_table_size];
+    /*! \brief Точки скрученной кривой Эдвардса. */
+     struct tpoint t[ak_wpoint_comb_table_size];
+   } table;
+  /*! \brief Точка \f$ -[2^d]S \f$, компенсирующая начальную точку вычислений. */
+   struct wpoint offset;
+ } *ak_wpoint_comb;
+
+/*! \brief Таблицы предвычислений для всех кривых, известных библиотеке.
+    \details Таблицы создаются один раз, при первом вызове функции ak_wpoint_pow_base(),
+    и после этого только читаются, поэтому поиск таблицы не требует блокировок.                  */
+ static struct wpoint_comb ak_wpoint_combs[ak_wpoint_comb_curves_count];
+/*! \brief Количество созданных таблиц предвычислений. */
+ static size_t ak_wpoint_combs_count = 0;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+/*! \brief Признак однократного создания таблиц предвычислений. */
+ static pthread_once_t ak_wpoint_combs_once = PTHREAD_ONCE_INIT;
+#else
+/*! \brief Признак того, что таблицы предвычислений уже созданы. */
+ static bool_t ak_wpoint_combs_ready = ak_false;
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет совпадение параметров двух эллиптических кривых и их образующих точек.
+    \return ak_true, если параметры совпадают, в противном случае ak_false.                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_wcurve_is_equal( ak_wcurve ec, ak_wcurve wc )
+{
+  const size_t len = ec->size*sizeof( ak_uint64 );
+
+  if( ec == wc ) return ak_true;
+  if( ec->size != wc->size ) return ak_false;
+ return ( memcmp( ec->p, wc->p, len ) == 0 ) && ( memcmp( ec->a, wc->a, len ) == 0 ) &&
+        ( memcmp( ec->b, wc->b, len ) == 0 ) && ( memcmp( ec->q, wc->q, len ) == 0 ) &&
+        ( memcmp( ec->point.x, wc->point.x, len ) == 0 ) &&
+        ( memcmp( ec->point.y, wc->point.y, len ) == 0 ) &&
+        ( memcmp( ec->point.z, wc->point.z, len ) == 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет таблицу предвычислений для образующей точки заданной кривой.       */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_comb_create( ak_wpoint_comb comb, ak_wcurve ec )
+{
+  size_t i = 0, j = 0;
+  ak_wpoint table = comb->table.w;
+  ak_tcurve tc = ak_wcurve_get_tcurve( ec );
+  struct tpoint ttable[ak_wpoint_comb_table_size];
+  const size_t d = ( ec->size << 6 )/ak_wpoint_comb_width;
+
+ /* вычисляем точки вида [2^{id}]P, а потом все их возможные суммы */
+  ak_wpoint_set_as_unit( table, ec );
+  ak_wpoint_set( table+1, ec );
+  for( i = 2; i < ak_wpoint_comb_table_size; i <<= 1 ) {
+     ak_wpoint_set_wpoint( table+i, table+(i>>1), ec );
+     for( j = 0; j < d; j++ ) ak_wpoint_double( table+i, ec );
+     ak_wpoint_jacobian_set_affine( table+i, ec );
+  }
+  ak_wpoint_jacobian_set_affine( table+1, ec );
+  for( i = 3; i < ak_wpoint_comb_table_size; i++ ) {
+     if(( i&( i-1 )) == 0 ) continue;
+     ak_wpoint_set_wpoint( table+i, table+( i&( i-1 )), ec );
+     ak_wpoint_add( table+i, table+( i&( ~i+1 )), ec );
+     ak_wpoint_jacobian_set_affine( table+i, ec );
+  }
+
+ /* при наличии эквивалентной кривой Эдвардса заменяем точки таблицы */
+  comb->tc = NULL;
+  if( tc != NULL ) {
+    for( i = 0; i < ak_wpoint_comb_table_size; i++ )
+       if( !ak_tpoint_set_wpoint( ttable+i, table+i, tc )) break;
+    if( i == ak_wpoint_comb_table_size ) {
+      memcpy( comb->table.t, ttable, sizeof( ttable ));
+      comb->tc = tc;
+    }
+  }
+
+ /* для кривых в форме Вейерштрасса заменяем бесконечно удаленную точку начальной точкой S
+    и вычисляем точку -[2^d]S */
+  if( comb->tc == NULL ) {
+    ak_wpoint_set_wpoint( table, table+( ak_wpoint_comb_table_size-1 ), ec );
+    ak_wpoint_set_wpoint( &comb->offset, table, ec );
+    for( j = 0; j < d; j++ ) ak_wpoint_double( &comb->offset, ec );
+    ak_mpzn_sub( comb->offset.y, ec->p, comb->offset.y, ec->size );
+    ak_wpoint_jacobian_set_affine( &comb->offset, ec );
+  }
+  comb->wc = ec;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция создает таблицы предвычислений для всех эллиптических кривых, доступных
+    через механизм OID. Кривые, параметры которых доступны под несколькими идентификаторами,
+    получают одну таблицу.                                                                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_combs_create( void )
+{
+  size_t i = 0;
+  ak_oid oid = ak_oid_context_find_by_engine( identifier );
+
+  while(( oid != NULL ) && ( ak_wpoint_combs_count < ak_wpoint_comb_curves_count )) {
+    if(( oid->mode == wcurve_params ) && ( oid->data != NULL )) {
+      for( i = 0; i < ak_wpoint_combs_count; i++ )
+         if( ak_wcurve_is_equal( ak_wpoint_combs[i].wc, ( ak_wcurve ) oid->data )) break;
+      if( i == ak_wpoint_combs_count )
+        ak_wpoint_comb_create( ak_wpoint_combs + ak_wpoint_combs_count++, ( ak_wcurve ) oid->data );
+    }
+    oid = ak_oid_context_findnext_by_engine( oid, identifier );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает таблицу предвычислений для образующей точки кривой.
+    \details Таблица ищется по параметрам кривой, поэтому она находится и для копий параметров,
+    известных библиотеке. После однократного создания таблиц поиск выполняется без блокировок.
+    \return Указатель на таблицу или NULL, если кривая не известна библиотеке.                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_wpoint_comb ak_wpoint_comb_get( ak_wcurve ec )
+{
+  size_t i = 0;
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_once( &ak_wpoint_combs_once, ak_wpoint_combs_create );
+#else
+  if( !ak_wpoint_combs_ready ) {
+    ak_wpoint_combs_create();
+    ak_wpoint_combs_ready = ak_true;
+  }
+#endif
+ /* сначала ищем таблицу по указателю на параметры, потом по самим параметрам */
+  for( i = 0; i < ak_wpoint_combs_count; i++ )
+     if( ak_wpoint_combs[i].wc == ec ) return ak_wpoint_combs+i;
+  for( i = 0; i < ak_wpoint_combs_count; i++ )
+     if( ak_wcurve_is_equal( ak_wpoint_combs[i].wc, ec )) return ak_wpoint_combs+i;
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выбирает точку из таблицы предвычислений, просматривая все точки таблицы,
+    что делает время выполнения и последовательность обращений к памяти независимыми от индекса.
+
+    @param out Область памяти, в которую помещается точка.
+    @param table Таблица предвычислений.
+    @param words Размер одной точки таблицы в машинных словах.
+    @param idx Номер точки.                                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_comb_select( ak_uint64 *out, const ak_uint64 *table,
+                                                                     size_t words, ak_uint64 idx )
+{
+  size_t i = 0, j = 0;
+  ak_uint64 mask = 0;
+
+  memset( out, 0, words*sizeof( ak_uint64 ));
+  for( i = 0; i < ak_wpoint_comb_table_size; i++, table += words ) {
+    /* mask равна 0xff..ff только при совпадении номеров */
+     mask = ( ak_uint64 )i ^ idx;
+     mask = (( mask | ( ~mask + 1 )) >> 63 ) - 1;
+     for( j = 0; j < words; j++ ) out[j] |= table[j]&mask;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция копирует точку `in` в точку `out` только при ненулевом значении `flag`;
+    время выполнения и последовательность обращений к памяти от значения `flag` не зависят.
+
+    @param out Область памяти, в которую помещается точка.
+    @param in Копируемая точка.
+    @param words Размер точки в машинных словах.
+    @param flag Условие копирования.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_comb_cmov( ak_uint64 *out, const ak_uint64 *in,
+                                                                    size_t words, ak_uint64 flag )
+{
+  size_t j = 0;
+ /* mask равна 0xff..ff только при ненулевом значении flag */
+  ak_uint64 mask = 0 - (( flag | ( ~flag + 1 )) >> 63 );
+
+  for( j = 0; j < words; j++ ) out[j] = ( out[j]&~mask ) | ( in[j]&mask );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает номер точки таблицы, составленный из битов числа k с номерами
+    \f$ i, i+d, i+2d, i+3d \f$.                                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline ak_uint64 ak_wpoint_comb_index( ak_uint64 *k, size_t i, size_t d )
+{
+  size_t j = 0, bit = 0;
+  ak_uint64 idx = 0;
+
+  for( j = 0; j < ak_wpoint_comb_width; j++ ) {
+     bit = i + j*d;
+     idx |= (( k[bit >> 6] >> ( bit&0x3f ))&1 ) << j;
+  }
+ return idx;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Для образующей точки \f$ P \f$ эллиптической кривой и заданного целого числа (вычета) \f$ k \f$
+    функция вычисляет кратную точку \f$ Q = [k]P \f$.
+
+    Поскольку точка \f$ P \f$ является константой кривой, используется метод гребенки
+    (C.H.Lim, P.J.Lee, <a href="https://doi.org/10.1007/3-540-48658-5_11">More flexible
+    exponentiation with precomputation</a>, 1994) с таблицей из 16 точек. Таблицы для всех кривых,
+    известных библиотеке, вычисляются один раз при первом вызове функции. Для \f$ n \f$-битного числа \f$ k \f$ выполняется
+    \f$ n/4 \f$ удвоений и \f$ n/4 \f$ смешанных сложений в координатах Якоби, против \f$ n \f$ удвоений и
+    \f$ n \f$ сложений в лесенке Монтгомери. Количество операций не зависит от значения \f$ k \f$,
+    а выбор точки из таблицы выполняется просмотром всей таблицы. Для кривых, эквивалентных
+    скрученным кривым Эдвардса, используются полные формулы сложения, не содержащие ветвлений.
+
+    Для остальных кривых формулы смешанного сложения содержат ветвления для бесконечно
+    удаленной точки, поэтому вычисления начинаются не с бесконечно удаленной точки, а с точки
+    \f$ S \f$, и в конце к результату прибавляется предвычисленная точка \f$ -[2^d]S \f$.
+    Сложение выполняется на каждом шаге; для нулевой цифры к сумме прибавляется точка \f$ S \f$,
+    а результат сложения отбрасывается условным копированием, не содержащим ветвлений.
+    Тем самым ни одно из слагаемых не является бесконечно удаленной точкой, а совпадение
+    слагаемых возможно лишь для пренебрежимо малой доли значений \f$ k \f$ (в этом случае
+    результат остается корректным).
+
+    Если параметры кривой не известны библиотеке, либо длина числа \f$ k \f$ отлична от длины
+    параметров кривой, используется функция ak_wpoint_pow().
+
+    \b Для \b информации: функция не приводит результирующую точку \f$ Q \f$ к аффинной форме.
+
+    @param wq Точка \f$ Q \f$, в которую помещается результат.
+    @param k Степень кратности.
+    @param size Размер степени \f$ k \f$ в машинных словах.
+    @param ec Эллиптическая кривая, на которой происходят вычисления                               */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_wpoint_pow_base( ak_wpoint wq, ak_uint64 *k, size_t size, ak_wcurve ec )
+{
+  size_t i = 0;
+  ak_uint64 idx = 0;
+  struct wpoint Q, R, T;
+  ak_wpoint_comb comb = NULL;
+  ak_function_wpoint_double *dbl = NULL;
+  const size_t d = ( ec->size << 6 )/ak_wpoint_comb_width;
+
+  if(( size != ec->size ) || (( comb = ak_wpoint_comb_get( ec )) == NULL )) {
+    ak_wpoint_pow( wq, &ec->point, k, size, ec );
+    return;
+  }
+
+ /* на каждом шаге берем по одному биту из каждой четверти числа k */
+  if( comb->tc != NULL ) {
+    struct tpoint TQ, TR;
+    ak_tpoint_set_as_unit( &TQ, comb->tc );
+    for( i = d; i > 0; i-- ) {
+       ak_tpoint_double( &TQ, comb->tc );
+       ak_wpoint_comb_select( ( ak_uint64 *)&TR, ( ak_uint64 *)comb->table.t,
+                          sizeof( struct tpoint )/sizeof( ak_uint64 ), ak_wpoint_comb_index( k, i-1, d ));
+       ak_tpoint_add( &TQ, &TR, comb->tc );
+    }
+    ak_wpoint_set_tpoint( wq, &TQ, comb->tc );
+    return;
+  }
+
+  dbl = ak_wpoint_jacobian_double_function( ec );
+  ak_wpoint_set_wpoint( &Q, comb->table.w, ec ); /* начальная точка S */
+  for( i = d; i > 0; i-- ) {
+     dbl( &Q, ec );
+     idx = ak_wpoint_comb_index( k, i-1, d );
+     ak_wpoint_comb_select( ( ak_uint64 *)&R, ( ak_uint64 *)comb->table.w,
+                                                  sizeof( struct wpoint )/sizeof( ak_uint64 ), idx );
+     ak_wpoint_set_wpoint( &T, &Q, ec );
+     ak_wpoint_jacobian_add_mixed( &T, &R, ec );
+     ak_wpoint_comb_cmov( ( ak_uint64 *)&Q, ( ak_uint64 *)&T,
+                                                  sizeof( struct wpoint )/sizeof( ak_uint64 ), idx );
+  }
+  ak_wpoint_jacobian_add_mixed( &Q, &comb->offset, ec );
+  ak_wpoint_from_jacobian( wq, &Q, ec );
+  memset( &T, 0, sizeof( struct wpoint ));
+  memset( &R, 0, sizeof( struct wpoint ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                 одновременное вычисление суммы двух кратных точек (метод Штрауса)               */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Ширина окна w в представлении wNAF. */
+ #define ak_wpoint_wnaf_width        ( 4 )
+/*! \brief Количество нечетных кратных \f$ P, [3]P, \ldots, [2^{w-1}-1]P \f$ точки. */
+ #define ak_wpoint_wnaf_table_size   ( 1 << ( ak_wpoint_wnaf_width - 2 ))
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет представление числа \f$ k \f$ в форме wNAF.
+    \details Каждая цифра представления либо равна нулю, либо является нечетным числом,
+    по модулю меньшим \f$ 2^{w-1} \f$; среди любых \f$ w \f$ соседних цифр не более одной
+    отлично от нуля. Время работы функции зависит от значения \f$ k \f$.
+
+    @param naf Массив, в который помещаются цифры (младшая цифра по нулевому индексу);
+    длина массива должна быть не менее \f$ 64\cdot\texttt{size} + 1 \f$.
+    @param k Число, для которого вычисляется представление.
+    @param size Размер числа \f$ k \f$ в машинных словах.
+    @return Количество цифр в представлении.                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static size_t ak_wpoint_wnaf( signed char *naf, ak_uint64 *k, size_t size )
+{
+  size_t i = 0, len = 0;
+  ak_uint64 d = 0, carry = 0;
+  ak_mpznmax t = ak_mpznmax_zero;
+
+  memcpy( t, k, size*sizeof( ak_uint64 ));
+  while( !ak_mpzn_cmp_ui( t, size+1, 0 )) {
+    if( t[0]&1 ) {
+      d = t[0]&(( 1 << ak_wpoint_wnaf_width ) - 1 );
+      if( d >= ( 1 << ( ak_wpoint_wnaf_width - 1 ))) {
+       /* отрицательная цифра: t <- t + (2^w - d) */
+        naf[len] = ( signed char )( d - ( 1 << ak_wpoint_wnaf_width ));
+        carry = ( 1 << ak_wpoint_wnaf_width ) - d;
+        for( i = 0; ( i <= size ) && carry; i++ ) {
+           t[i] += carry;
+           carry = ( t[i] < carry );
+        }
+      } else {
+          naf[len] = ( signed char ) d;
+          t[0] -= d; /* младшие биты t равны d, заема не возникает */
+        }
+    } else naf[len] = 0;
+   /* t <- t/2 */
+    for( i = 0; i < size; i++ ) t[i] = ( t[i] >> 1 )^( t[i+1] << 63 );
+    t[size] >>= 1;
+    len++;
+  }
+ return len;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет нечетные кратные \f$ P, [3]P, \ldots \f$ заданной точки
+    в координатах Якоби.                                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_wnaf_table( ak_wpoint table, ak_wpoint wp,
+                                                  ak_function_wpoint_double *dbl, ak_wcurve ec )
+{
+  size_t i = 0;
+  struct wpoint P2;
+
+  ak_wpoint_to_jacobian( table, wp, ec );
+  ak_wpoint_set_wpoint( &P2, table, ec );
+  dbl( &P2, ec );
+  for( i = 1; i < ak_wpoint_wnaf_table_size; i++ ) {
+     ak_wpoint_set_wpoint( table+i, table+i-1, ec );
+     ak_wpoint_jacobian_add( table+i, &P2, ec );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция прибавляет к точке \f$ Q \f$ точку \f$ [d]P \f$, где \f$ d \f$ - ненулевая
+    цифра представления wNAF, а нечетные кратные точки \f$ P \f$ содержатся в таблице.             */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_wnaf_add( ak_wpoint wq, ak_wpoint table, signed char d, ak_wcurve ec )
+{
+  struct wpoint R;
+
+  if( d > 0 ) {
+    ak_wpoint_jacobian_add( wq, table + (( d - 1 ) >> 1 ), ec );
+    return;
+  }
+ /* для отрицательной цифры используем точку -R = (X:-Y:Z) */
+  ak_wpoint_set_wpoint( &R, table + (( -d - 1 ) >> 1 ), ec );
+  if( !ak_mpzn_cmp_ui( R.y, ec->size, 0 )) ak_mpzn_sub( R.y, ec->p, R.y, ec->size );
+  ak_wpoint_jacobian_add( wq, &R, ec );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет нечетные кратные \f$ P, [3]P, \ldots \f$ точки скрученной кривой
+    Эдвардса; первый элемент таблицы должен содержать точку \f$ P \f$.                            */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_tpoint_wnaf_table( ak_tpoint table, ak_tcurve tc )
+{
+  size_t i = 0;
+  struct tpoint P2;
+
+  memcpy( &P2, table, sizeof( struct tpoint ));
+  ak_tpoint_double( &P2, tc );
+  for( i = 1; i < ak_wpoint_wnaf_table_size; i++ ) {
+     memcpy( table+i, table+i-1, sizeof( struct tpoint ));
+     ak_tpoint_add( table+i, &P2, tc );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция прибавляет к точке \f$ Q \f$ скрученной кривой Эдвардса точку \f$ [d]P \f$,
+    где \f$ d \f$ - ненулевая цифра представления wNAF.                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_tpoint_wnaf_add( ak_tpoint tq, ak_tpoint table, signed char d, ak_tcurve tc )
+{
+  struct tpoint R;
+  ak_wcurve ec = tc->wc;
+
+  if( d > 0 ) {
+    ak_tpoint_add( tq, table + (( d - 1 ) >> 1 ), tc );
+    return;
+  }
+ /* для отрицательной цифры используем точку -R = (-X:Y:-T:Z) */
+  memcpy( &R, table + (( -d - 1 ) >> 1 ), sizeof( struct tpoint ));
+  if( !ak_mpzn_cmp_ui( R.x, ec->size, 0 )) ak_mpzn_sub( R.x, ec->p, R.x, ec->size );
+  if( !ak_mpzn_cmp_ui( R.t, ec->size, 0 )) ak_mpzn_sub( R.t, ec->p, R.t, ec->size );
+  ak_tpoint_add( tq, &R, tc );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Для двух точек \f$ P_1, P_2 \f$ эллиптической кривой и целых чисел \f$ k_1, k_2 \f$
+    функция вычисляет точку \f$ Q = [k_1]P_1 + [k_2]P_2 \f$.
+
+    Используется метод Штрауса (Shamir's trick) с представлением чисел \f$ k_1, k_2 \f$
+    в форме wNAF ширины 4: обе суммы вычисляются с общей цепочкой удвоений, а сложения
+    выполняются только с точками \f$ \pm P_i, \pm[3]P_i, \pm[5]P_i, \pm[7]P_i\f$,
+    вычисляемыми заранее; все вычисления выполняются в координатах Якоби. Для \f$ n \f$-битных чисел выполняется около \f$ n \f$ удвоений
+    и \f$ 2n/5 \f$ сложений, против \f$ 2n \f$ удвоений и \f$ 2n \f$ сложений при
+    двукратном вызове функции ak_wpoint_pow(). Для кривых, эквивалентных скрученным кривым
+    Эдвардса, вычисления выполняются на кривой Эдвардса.
+
+    \b Внимание! Время выполнения функции зависит от значений \f$ k_1, k_2 \f$, поэтому
+    функция может применяться только для открытых данных, например, при проверке подписи.
+
+    \b Для \b информации: функция не приводит результирующую точку \f$ Q \f$ к аффинной форме.
+
+    @param wq Точка \f$ Q \f$, в которую помещается результат.
+    @param wp1 Точка \f$ P_1 \f$.
+    @param k1 Степень кратности для точки \f$ P_1 \f$.
+    @param wp2 Точка \f$ P_2 \f$.
+    @param k2 Степень кратности для точки \f$ P_2 \f$.
+    @param size Размер степеней \f$ k_1, k_2 \f$ в машинных словах; значение не должно превышать
+    \ref ak_mpzn512_size.
+    @param ec Эллиптическая кривая, на которой происходят вычисления                               */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_wpoint_pow_double( ak_wpoint wq, ak_wpoint wp1, ak_uint64 *k1,
+                                               ak_wpoint wp2, ak_uint64 *k2, size_t size, ak_wcurve ec )
+{
+  size_t i = 0, len1 = 0, len2 = 0;
+  struct wpoint Q, T1[ak_wpoint_wnaf_table_size], T2[ak_wpoint_wnaf_table_size];
+  signed char naf1[64*ak_mpzn512_size+1], naf2[64*ak_mpzn512_size+1];
+  ak_function_wpoint_double *dbl = NULL;
+  ak_tcurve tc = ak_wcurve_get_tcurve( ec );
+
+  if( size > ak_mpzn512_size ) {
+    ak_wpoint_pow( wq, wp1, k1, size, ec );
+    ak_wpoint_pow( &Q, wp2, k2, size, ec );
+    ak_wpoint_add( wq, &Q, ec );
+    return;
+  }
+
+  len1 = ak_wpoint_wnaf( naf1, k1, size );
+  len2 = ak_wpoint_wnaf( naf2, k2, size );
+
+ /* для скрученных кривых Эдвардса используем полные формулы сложения */
+  if( tc != NULL ) {
+    struct tpoint TQ, S1[ak_wpoint_wnaf_table_size], S2[ak_wpoint_wnaf_table_size];
+    if( ak_tpoint_set_wpoint( S1, wp1, tc ) && ak_tpoint_set_wpoint( S2, wp2, tc )) {
+      ak_tpoint_wnaf_table( S1, tc );
+      ak_tpoint_wnaf_table( S2, tc );
+      ak_tpoint_set_as_unit( &TQ, tc );
+      for( i = ak_max( len1, len2 ); i > 0; i-- ) {
+         ak_tpoint_double( &TQ, tc );
+         if(( i <= len1 ) && naf1[i-1] ) ak_tpoint_wnaf_add( &TQ, S1, naf1[i-1], tc );
+         if(( i <= len2 ) && naf2[i-1] ) ak_tpoint_wnaf_add( &TQ, S2, naf2[i-1], tc );
+      }
+      ak_wpoint_set_tpoint( wq, &TQ, tc );
+      return;
+    }
+  }
+
+  dbl = ak_wpoint_jacobian_double_function( ec );
+  ak_wpoint_wnaf_table( T1, wp1, dbl, ec );
+  ak_wpoint_wnaf_table( T2, wp2, dbl, ec );
+
+  ak_wpoint_set_as_unit( &Q, ec );
+  for( i = ak_max( len1, len2 ); i > 0; i-- ) {
+     dbl( &Q, ec );
+     if(( i <= len1 ) && naf1[i-1] ) ak_wpoint_wnaf_add( &Q, T1, naf1[i-1], ec );
+     if(( i <= len2 ) && naf2[i-1] ) ak_wpoint_wnaf_add( &Q, T2, naf2[i-1], ec );
+  }
+  ak_wpoint_from_jacobian( wq, &Q, ec );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
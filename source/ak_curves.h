@@ -61,6 +61,12 @@ extern "C" {
  void ak_wpoint_reduce( ak_wpoint , ak_wcurve );
 /*! \brief Вычисление кратной точки эллиптической кривой. */
  void ak_wpoint_pow( ak_wpoint , ak_wpoint , ak_uint64 *, size_t , ak_wcurve );
+/*! \brief Вычисление кратной образующей точки эллиптической кривой с использованием
+    таблицы предвычислений. */
+ void ak_wpoint_pow_base( ak_wpoint , ak_uint64 *, size_t , ak_wcurve );
+/*! \brief Вычисление суммы двух кратных точек эллиптической кривой (с переменным временем). */
+ void ak_wpoint_pow_double( ak_wpoint , ak_wpoint , ak_uint64 *,
+                                                  ak_wpoint , ak_uint64 *, size_t , ak_wcurve );
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Класс, реализующий эллиптическую кривую, заданную в короткой форме Вейерштрасса
@@ -107,6 +113,41 @@ extern "C" {
   const char *pchar;
 };
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Класс, содержащий параметры скрученной кривой Эдвардса, бирационально эквивалентной
+    эллиптической кривой в короткой форме Вейерштрасса.
+
+    Скрученная кривая Эдвардса задается сравнением \f$ eu^2 + v^2 \equiv 1 + du^2v^2 \pmod{p} \f$.
+    Точки кривых связаны соотношениями
+    \f$ u = \frac{x - t}{y}, v = \frac{x - t - s}{x - t + s} \f$ и
+    \f$ x = \frac{s(1+v)}{1-v} + t, y = \frac{s(1+v)}{(1-v)u} \f$, где
+    \f$ s = \frac{e - d}{4} \f$ и \f$ t = \frac{e + d}{6} \f$
+    (см. рекомендации Р 50.1.114-2016).
+
+    Все параметры хранятся в представлении Монтгомери по модулю \f$ p \f$.                        */
+/* ----------------------------------------------------------------------------------------------- */
+ struct tcurve
+{
+ /*! \brief Эллиптическая кривая в короткой форме Вейерштрасса. */
+  ak_wcurve wc;
+ /*! \brief Коэффициент \f$ e \f$ скрученной кривой Эдвардса. */
+  ak_uint64 e[ak_mpzn512_size];
+ /*! \brief Коэффициент \f$ d \f$ скрученной кривой Эдвардса. */
+  ak_uint64 d[ak_mpzn512_size];
+ /*! \brief Величина \f$ s \f$, используемая при переходе между формами кривой. */
+  ak_uint64 s[ak_mpzn512_size];
+ /*! \brief Величина \f$ t \f$, используемая при переходе между формами кривой. */
+  ak_uint64 t[ak_mpzn512_size];
+};
+/*! \brief Контекст параметров скрученной кривой Эдвардса. */
+ typedef const struct tcurve *ak_tcurve;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Поиск скрученной кривой Эдвардса, эквивалентной заданной кривой. */
+ ak_tcurve ak_wcurve_get_tcurve( ak_wcurve );
+/*! \brief Проверка параметров скрученной кривой Эдвардса. */
+ int ak_tcurve_is_ok( ak_tcurve );
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Вычисление дискриминанта эллиптической кривой, заданной в короткой форме Вейерштрасса. */
  void ak_mpzn_set_wcurve_discriminant( ak_uint64 *, ak_wcurve );
@@ -20,6 +20,37 @@
 #ifdef _MSC_VER
  #include <stdlib.h>
  /* требуется для определени функции rand() */
+ #include <intrin.h>
+ /* требуется для определения функции __cpuid() */
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Используемая реализация умножения в поле \f$ \mathbb F_{2^{64}}\f$. */
+ ak_function_gfn_multiplication *ak_gf64_mul = ak_gf64_mul_uint64;
+/*! \brief Используемая реализация умножения в поле \f$ \mathbb F_{2^{128}}\f$. */
+ ak_function_gfn_multiplication *ak_gf128_mul = ak_gf128_mul_uint64;
+/*! \brief Используемая реализация умножения в поле \f$ \mathbb F_{2^{256}}\f$. */
+ ak_function_gfn_multiplication *ak_gf256_mul = ak_gf256_mul_uint64;
+/*! \brief Используемая реализация умножения в поле \f$ \mathbb F_{2^{512}}\f$. */
+ ak_function_gfn_multiplication *ak_gf512_mul = ak_gf512_mul_uint64;
+/*! \brief Используемая реализация суммы произведений в поле \f$ \mathbb F_{2^{64}}\f$. */
+ ak_function_gfn_multiplication_sum *ak_gf64_mul_sum = ak_gf64_mul_sum_uint64;
+/*! \brief Используемая реализация суммы произведений в поле \f$ \mathbb F_{2^{128}}\f$. */
+ ak_function_gfn_multiplication_sum *ak_gf128_mul_sum = ak_gf128_mul_sum_uint64;
+
+#ifdef LIBAKRYPT_HAVE_BUILTIN_CLMULEPI64
+/*! \brief Флаг, определяющий, поддерживается ли команда pclmulqdq процессором,
+    на котором выполняется библиотека. */
+ static bool_t gfn_pcmulqdq_implementation = ak_false;
+
+/*! \brief Атрибут функций, использующих команду pclmulqdq: компилятору разрешается
+    использовать команду только в этих функциях, остальной код библиотеки собирается
+    без нее. */
+ #ifdef __GNUC__
+  #define ak_attribute_pclmul __attribute__(( target( "pclmul" )))
+ #else
+  #define ak_attribute_pclmul
+ #endif
 #endif
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -285,6 +316,51 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму \f$ z = \sum_{i=0}^{count-1} x_i \cdot y_i \f$ попарных произведений
+    элементов конечного поля \f$ \mathbb F_{2^{64}}\f$, последовательно расположенных в массивах
+    `x` и `y`. Для умножения используется функция ak_gf64_mul_uint64().
+
+    @param z Указатель на область памяти, куда помещается результат.
+    @param x Указатель на массив из `count` элементов поля.
+    @param y Указатель на массив из `count` элементов поля.
+    @param count Количество слагаемых.                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf64_mul_sum_uint64( ak_pointer z, ak_pointer x, ak_pointer y, size_t count )
+{
+  size_t i = 0;
+  ak_uint64 t, sum = 0;
+
+  for( i = 0; i < count; i++ ) {
+     ak_gf64_mul_uint64( &t, (ak_uint64 *)x+i, (ak_uint64 *)y+i );
+     sum ^= t;
+  }
+  ((ak_uint64 *)z)[0] = sum;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму \f$ z = \sum_{i=0}^{count-1} x_i \cdot y_i \f$ попарных произведений
+    элементов конечного поля \f$ \mathbb F_{2^{128}}\f$, последовательно расположенных в массивах
+    `x` и `y`. Для умножения используется функция ak_gf128_mul_uint64().
+
+    @param z Указатель на область памяти, куда помещается результат.
+    @param x Указатель на массив из `count` элементов поля.
+    @param y Указатель на массив из `count` элементов поля.
+    @param count Количество слагаемых.                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf128_mul_sum_uint64( ak_pointer z, ak_pointer x, ak_pointer y, size_t count )
+{
+  size_t i = 0;
+  ak_uint64 t[2], sum[2] = { 0, 0 };
+
+  for( i = 0; i < count; i++ ) {
+     ak_gf128_mul_uint64( t, (ak_uint64 *)x+2*i, (ak_uint64 *)y+2*i );
+     sum[0] ^= t[0]; sum[1] ^= t[1];
+  }
+  ((ak_uint64 *)z)[0] = sum[0];
+  ((ak_uint64 *)z)[1] = sum[1];
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef LIBAKRYPT_HAVE_BUILTIN_CLMULEPI64
 
@@ -294,7 +370,7 @@
     \f$ f(x) = x^{64} + x^4 + x^3 + x + 1 \in \mathbb F_2[x]\f$. Для умножения используется
     реализация с помощью команды PCLMULQDQ.                                                        */
 /* ----------------------------------------------------------------------------------------------- */
- void ak_gf64_mul_pcmulqdq( ak_pointer z, ak_pointer x, ak_pointer y )
+ ak_attribute_pclmul void ak_gf64_mul_pcmulqdq( ak_pointer z, ak_pointer x, ak_pointer y )
 {
 #ifdef _MSC_VER
 	 __m128i gm, xm, ym, cm, cx;
@@ -334,7 +410,7 @@
     \f$ f(x) = x^{128} + x^7 + x^2 + x + 1 \in \mathbb F_2[x]\f$. Для умножения используется
     реализация с помощью команды PCLMULQDQ.                                                        */
 /* ----------------------------------------------------------------------------------------------- */
- void ak_gf128_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
+ ak_attribute_pclmul void ak_gf128_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
 {
 #ifdef _MSC_VER
 	 __m128i am, bm, cm, dm, em, fm;
@@ -380,13 +456,88 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму \f$ z = \sum_{i=0}^{count-1} x_i \cdot y_i \f$ попарных произведений
+    элементов конечного поля \f$ \mathbb F_{2^{64}}\f$. Произведения вычисляются командой
+    PCLMULQDQ и складываются без приведения; приведение по модулю многочлена
+    \f$ f(x) = x^{64} + x^4 + x^3 + x + 1 \f$ выполняется один раз для всей суммы.
+
+    @param z Указатель на область памяти, куда помещается результат.
+    @param x Указатель на массив из `count` элементов поля.
+    @param y Указатель на массив из `count` элементов поля.
+    @param count Количество слагаемых.                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_attribute_pclmul void ak_gf64_mul_sum_pcmulqdq( ak_pointer z, ak_pointer x, ak_pointer y, size_t count )
+{
+  size_t i = 0;
+  ak_uint64 c[2], t[2];
+  const __m128i gm = _mm_set_epi64x( 0, 0x1B );
+  __m128i cm = _mm_setzero_si128(), tm;
+
+ /* вычисляем сумму произведений без приведения */
+  for( i = 0; i < count; i++ )
+     cm = _mm_xor_si128( cm, _mm_clmulepi64_si128(
+                 _mm_loadl_epi64( (__m128i *)((ak_uint64 *)x+i) ),
+                                        _mm_loadl_epi64( (__m128i *)((ak_uint64 *)y+i) ), 0x00 ));
+  _mm_storeu_si128( (__m128i *)c, cm );
+
+ /* приведение: x^64 = x^4 + x^3 + x + 1, старшая часть произведения умножается дважды */
+  tm = _mm_clmulepi64_si128( _mm_set_epi64x( 0, c[1] ), gm, 0x00 );
+  _mm_storeu_si128( (__m128i *)t, tm );
+  c[0] ^= t[0];
+  tm = _mm_clmulepi64_si128( _mm_set_epi64x( 0, t[1] ), gm, 0x00 );
+  _mm_storeu_si128( (__m128i *)t, tm );
+
+  ((ak_uint64 *)z)[0] = c[0]^t[0];
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму \f$ z = \sum_{i=0}^{count-1} x_i \cdot y_i \f$ попарных произведений
+    элементов конечного поля \f$ \mathbb F_{2^{128}}\f$. Произведения вычисляются командой
+    PCLMULQDQ и складываются без приведения; приведение по модулю многочлена
+    \f$ f(x) = x^{128} + x^7 + x^2 + x + 1 \f$ выполняется один раз для всей суммы.
+
+    @param z Указатель на область памяти, куда помещается результат.
+    @param x Указатель на массив из `count` элементов поля.
+    @param y Указатель на массив из `count` элементов поля.
+    @param count Количество слагаемых.                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_attribute_pclmul void ak_gf128_mul_sum_pcmulqdq( ak_pointer z, ak_pointer x, ak_pointer y, size_t count )
+{
+  size_t i = 0;
+  ak_uint64 c[2], d[2], e[2], x3, D;
+  __m128i am, bm, cm = _mm_setzero_si128(), dm = _mm_setzero_si128(), em = _mm_setzero_si128();
+
+ /* вычисляем сумму произведений без приведения */
+  for( i = 0; i < count; i++ ) {
+     am = _mm_loadu_si128( (__m128i *)x+i );
+     bm = _mm_loadu_si128( (__m128i *)y+i );
+     cm = _mm_xor_si128( cm, _mm_clmulepi64_si128( am, bm, 0x00 )); /* c = a0*b0 */
+     dm = _mm_xor_si128( dm, _mm_clmulepi64_si128( am, bm, 0x11 )); /* d = a1*b1 */
+     em = _mm_xor_si128( em, _mm_clmulepi64_si128( am, bm, 0x10 )); /* e = a0*b1 + a1*b0 */
+     em = _mm_xor_si128( em, _mm_clmulepi64_si128( am, bm, 0x01 ));
+  }
+  _mm_storeu_si128( (__m128i *)c, cm );
+  _mm_storeu_si128( (__m128i *)d, dm );
+  _mm_storeu_si128( (__m128i *)e, em );
+
+ /* приведение */
+  x3 = d[1];
+  D = d[0] ^ e[1] ^ (x3 >> 63) ^ (x3 >> 62) ^ (x3 >> 57);
+  c[0] ^= D ^ (D << 1) ^ (D << 2) ^ (D << 7);
+  c[1] ^= e[0] ^ x3 ^ (x3 << 1) ^ (D >> 63) ^ (x3 << 2) ^ (D >> 62) ^ (x3 << 7) ^ (D >> 57);
+
+  ((ak_uint64 *)z)[0] = c[0];
+  ((ak_uint64 *)z)[1] = c[1];
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция реализует операцию умножения двух элементов конечного поля \f$ \mathbb F_{2^{256}}\f$,
     порожденного неприводимым многочленом
     \f$ f(x) = x^{256} + x^10 + x^5 + x^2 + 1 \in \mathbb F_2[x]\f$. Для умножения используется
     реализация с помощью команды PCLMULQDQ.                                                        */
 /* ----------------------------------------------------------------------------------------------- */
- void ak_gf256_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
+ ak_attribute_pclmul void ak_gf256_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
 {
 #ifdef _MSC_VER
      __m128i a1a0, a3a2, b1b0, b3b2;
@@ -503,7 +654,7 @@
     реализация с помощью команды PCLMULQDQ.
     \todo может быть имеет смысл разбить на 2 ifdef, а середину сделать общей?                     */
 /* ----------------------------------------------------------------------------------------------- */
-void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
+ ak_attribute_pclmul void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
 {
     //TODO не тестировалось
 #ifdef _MSC_VER
@@ -794,6 +945,49 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
 
 #endif
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция проверяет, поддерживает ли процессор, на котором выполняется библиотека, команду
+    pclmulqdq, и, в случае поддержки, устанавливает реализации операций умножения, использующие
+    эту команду. В противном случае используются реализации, не зависящие от процессора.
+    Функция вызывается при инициализации библиотеки.
+
+    @return Функция возвращает \ref ak_error_ok (ноль).                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_gfn_multiplication_init_implementation( void )
+{
+#ifdef LIBAKRYPT_HAVE_BUILTIN_CLMULEPI64
+ #ifdef _MSC_VER
+  int info[4];
+  __cpuid( info, 1 );
+  gfn_pcmulqdq_implementation = (( info[2] >> 1 )&1 ) ? ak_true : ak_false;
+ #else
+  __builtin_cpu_init();
+  gfn_pcmulqdq_implementation = __builtin_cpu_supports( "pclmul" ) ? ak_true : ak_false;
+ #endif
+
+  if( gfn_pcmulqdq_implementation ) {
+    ak_gf64_mul = ak_gf64_mul_pcmulqdq;
+    ak_gf128_mul = ak_gf128_mul_pcmulqdq;
+    ak_gf256_mul = ak_gf256_mul_pcmulqdq;
+    ak_gf512_mul = ak_gf512_mul_pcmulqdq;
+    ak_gf64_mul_sum = ak_gf64_mul_sum_pcmulqdq;
+    ak_gf128_mul_sum = ak_gf128_mul_sum_pcmulqdq;
+    if( ak_log_get_level() >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__,
+                                   "using pcmulqdq for multiplication in finite Galois fields" );
+    return ak_error_ok;
+  }
+#endif
+  ak_gf64_mul = ak_gf64_mul_uint64;
+  ak_gf128_mul = ak_gf128_mul_uint64;
+  ak_gf256_mul = ak_gf256_mul_uint64;
+  ak_gf512_mul = ak_gf512_mul_uint64;
+  ak_gf64_mul_sum = ak_gf64_mul_sum_uint64;
+  ak_gf128_mul_sum = ak_gf128_mul_sum_uint64;
+  if( ak_log_get_level() >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__,
+                              "using uint64 realization of multiplication in finite Galois fields" );
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Тестирование операции умножения в поле \f$ \mathbb F_{2^{64}}\f$. */
  static bool_t ak_gf64_multiplication_test( void )
@@ -848,6 +1042,8 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
   }
 
 #ifdef LIBAKRYPT_HAVE_BUILTIN_CLMULEPI64
+ /* команда pclmulqdq может не поддерживаться процессором */
+ if( !gfn_pcmulqdq_implementation ) return ak_true;
  if( ak_log_get_level() >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__, "comparison between two implementations included");
 
@@ -883,6 +1079,23 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
   }
  if( ak_log_get_level() >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__, "one thousand iterations for random values is Ok");
+
+ /* проверка суммы произведений с однократным приведением */
+ {
+   ak_uint64 xs[16], ys[16];
+   for( i = 0; i < 16; i++ ) { xs[i] = x ^ values[i&7]; ys[i] = y + values[(i+3)&7]; x = y; y = xs[i]; }
+   ak_gf64_mul_sum_uint64( &z, xs, ys, 16 );
+   ak_gf64_mul_sum_pcmulqdq( &z1, xs, ys, 16 );
+   if( z != z1 ) {
+     ak_error_message_fmt( ak_error_not_equal_data, __func__ , "uint64 sum calculated   %s",
+                                                               ak_ptr_to_hexstr( &z, 8, ak_true ));
+     ak_error_message_fmt( ak_error_not_equal_data, __func__ , "pcmulqdq sum calculated %s",
+                                                              ak_ptr_to_hexstr( &z1, 8, ak_true ));
+     return ak_false;
+   }
+ }
+ if( ak_log_get_level() >= ak_log_maximum )
+   ak_error_message( ak_error_ok, __func__, "aggregated multiplication is Ok");
 #endif
  return ak_true;
 }
@@ -937,6 +1150,8 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
  if( !ak_ptr_is_equal_with_log( result, m8, 16 )) goto lexit;
 
 #ifdef LIBAKRYPT_HAVE_BUILTIN_CLMULEPI64
+ /* команда pclmulqdq может не поддерживаться процессором */
+ if( !gfn_pcmulqdq_implementation ) return ak_true;
  if( ak_log_get_level() >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__, "comparison between two implementations included");
 
@@ -969,6 +1184,25 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
  }
  if( ak_log_get_level() >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__, "one thousand iterations for random values is Ok");
+
+ /* проверка суммы произведений с однократным приведением */
+ {
+   ak_uint64 xs[32], ys[32];
+   for( i = 0; i < 16; i++ ) {
+      xs[2*i] = a.q[0] ^ (ak_uint64)i; xs[2*i+1] = a.q[1];
+      ys[2*i] = b.q[1]; ys[2*i+1] = b.q[0] + (ak_uint64)i;
+      ak_gf128_mul_uint64( &a, xs+2*i, ys+2*i );
+   }
+   ak_gf128_mul_sum_uint64( result, xs, ys, 16 );
+   ak_gf128_mul_sum_pcmulqdq( result2, xs, ys, 16 );
+   if( !ak_ptr_is_equal_with_log( result, result2, 16 )) {
+     ak_error_message( ak_error_ok, __func__,
+                         "aggregated multiplication with pcmulqdq differs from standard method" );
+     goto lexit;
+   }
+ }
+ if( ak_log_get_level() >= ak_log_maximum )
+   ak_error_message( ak_error_ok, __func__, "aggregated multiplication is Ok");
 #endif
 
  return ak_true;
@@ -1011,6 +1245,8 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
   }
 
 #ifdef LIBAKRYPT_HAVE_BUILTIN_CLMULEPI64
+ /* команда pclmulqdq может не поддерживаться процессором */
+ if( !gfn_pcmulqdq_implementation ) return ak_true;
  if( ak_log_get_level() >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__, "comparison between two implementations included");
 
@@ -1095,6 +1331,8 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
   }
 
 #ifdef LIBAKRYPT_HAVE_BUILTIN_CLMULEPI64
+ /* команда pclmulqdq может не поддерживаться процессором */
+ if( !gfn_pcmulqdq_implementation ) return ak_true;
  if( ak_log_get_level() >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__, "comparison between two implementations included");
 
@@ -1152,7 +1390,7 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
    ak_error_message( ak_error_ok, __func__ , "testing the Galois fileds arithmetic started");
 
 #ifdef LIBAKRYPT_HAVE_BUILTIN_CLMULEPI64
- if( audit >= ak_log_maximum )
+ if(( audit >= ak_log_maximum ) && gfn_pcmulqdq_implementation )
    ak_error_message( ak_error_ok, __func__ ,
                                       "using pcmulqdq for multiplication in finite Galois fields");
 #endif
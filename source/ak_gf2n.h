@@ -37,6 +37,10 @@ extern "C" {
  void ak_gf256_mul_uint64( ak_pointer z, ak_pointer x, ak_pointer y );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{512}}\f$. */
  void ak_gf512_mul_uint64( ak_pointer z, ak_pointer x, ak_pointer y );
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{64}}\f$. */
+ void ak_gf64_mul_sum_uint64( ak_pointer z, ak_pointer x, ak_pointer y, size_t count );
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{128}}\f$. */
+ void ak_gf128_mul_sum_uint64( ak_pointer z, ak_pointer x, ak_pointer y, size_t count );
 
 #ifdef LIBAKRYPT_HAVE_BUILTIN_CLMULEPI64
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{64}}\f$. */
@@ -47,19 +51,45 @@ extern "C" {
  void ak_gf256_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{512}}\f$. */
  void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b );
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{64}}\f$
+    с однократным приведением по модулю. */
+ void ak_gf64_mul_sum_pcmulqdq( ak_pointer z, ak_pointer x, ak_pointer y, size_t count );
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{128}}\f$
+    с однократным приведением по модулю. */
+ void ak_gf128_mul_sum_pcmulqdq( ak_pointer z, ak_pointer x, ak_pointer y, size_t count );
 
- #define ak_gf64_mul ak_gf64_mul_pcmulqdq
- #define ak_gf128_mul ak_gf128_mul_pcmulqdq
- #define ak_gf256_mul ak_gf256_mul_pcmulqdq
- #define ak_gf512_mul ak_gf512_mul_pcmulqdq
-
-#else
- #define ak_gf64_mul ak_gf64_mul_uint64
- #define ak_gf128_mul ak_gf128_mul_uint64
- #define ak_gf256_mul ak_gf256_mul_uint64
- #define ak_gf512_mul ak_gf512_mul_uint64
 #endif
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция умножения двух элементов конечного поля характеристики 2. */
+ typedef void ( ak_function_gfn_multiplication )( ak_pointer , ak_pointer , ak_pointer );
+/*! \brief Функция вычисления суммы попарных произведений элементов конечного поля
+    характеристики 2. */
+ typedef void ( ak_function_gfn_multiplication_sum )( ak_pointer , ak_pointer , ak_pointer , size_t );
+
+/*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{64}}\f$
+    (реализация выбирается при инициализации библиотеки). */
+ extern ak_function_gfn_multiplication *ak_gf64_mul;
+/*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{128}}\f$
+    (реализация выбирается при инициализации библиотеки). */
+ extern ak_function_gfn_multiplication *ak_gf128_mul;
+/*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{256}}\f$
+    (реализация выбирается при инициализации библиотеки). */
+ extern ak_function_gfn_multiplication *ak_gf256_mul;
+/*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{512}}\f$
+    (реализация выбирается при инициализации библиотеки). */
+ extern ak_function_gfn_multiplication *ak_gf512_mul;
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{64}}\f$
+    (реализация выбирается при инициализации библиотеки). */
+ extern ak_function_gfn_multiplication_sum *ak_gf64_mul_sum;
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{128}}\f$
+    (реализация выбирается при инициализации библиотеки). */
+ extern ak_function_gfn_multiplication_sum *ak_gf128_mul_sum;
+
+/*! \brief Выбор реализации операций умножения в полях характеристики 2,
+    поддерживаемой процессором. */
+ int ak_gfn_multiplication_init_implementation( void );
+
 /*! \brief Функция тестирования корректности реализации операций умножения в полях характеристики 2. */
  bool_t ak_gfn_multiplication_test( void );
 
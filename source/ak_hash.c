@@ -20,7 +20,13 @@
 #else
  #error Library cannot be compiled without string.h header
 #endif
+#ifdef LIBAKRYPT_HAVE_BUILTIN_XOR_SI128
+ #include <emmintrin.h>
+#endif
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                            Реализация функции хеширования SHA-3                                 */
+/* ----------------------------------------------------------------------------------------------- */
 #if defined(_MSC_VER)
 #define SHA3_CONST(x) x
 #else
@@ -31,10 +37,6 @@
 #define SHA3_ROTL64(x, y) \
         (((x) << (y)) | ((x) >> ((sizeof(ak_uint64)*8) - (y))))
 
-/* ----------------------------------------------------------------------------------------------- */
-/*                            Реализация функции хеширования SHA-3                                 */
-/* ----------------------------------------------------------------------------------------------- */
-
 static const ak_uint64 keccakf_rndc[24] = {
     SHA3_CONST(0x0000000000000001UL), SHA3_CONST(0x0000000000008082UL),
     SHA3_CONST(0x800000000000808aUL), SHA3_CONST(0x8000000080008000UL),
@@ -50,81 +52,170 @@ static const ak_uint64 keccakf_rndc[24] = {
     SHA3_CONST(0x0000000080000001UL), SHA3_CONST(0x8000000080008008UL)
 };
 
-static const ak_uint8 keccakf_rotc[24] = {
-    1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62,
-    18, 39, 61, 20, 44
-};
-
-static const ak_uint8 keccakf_piln[24] = {
-    10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20,
-    14, 22, 9, 6, 1
-};
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Один раунд перестановки Keccak-f[1600], переводящий состояние A в состояние E.
+    \details Строки состояния обозначаются буквами b, g, k, m, s, столбцы - буквами a, e, i, o, u;
+    так, слово `Aki` имеет индекс 2 + 5*2 = 12. Преобразования theta, rho и pi полностью развернуты,
+    а преобразование chi вычисляется для состояния, в котором слова с индексами 1, 2, 8, 12, 17 и 20
+    хранятся в инвертированном виде (lane complementing). Это позволяет заменить пять операций
+    отрицания в каждой строке на одну, а остальные операции `~x & y` - на операции `x | y` и `x & y`. */
+/* ----------------------------------------------------------------------------------------------- */
+#define ak_hash_keccakf_round( A, E, rc )                                                          \
+   Ca = A##ba^A##ga^A##ka^A##ma^A##sa;                                                            \
+   Ce = A##be^A##ge^A##ke^A##me^A##se;                                                            \
+   Ci = A##bi^A##gi^A##ki^A##mi^A##si;                                                            \
+   Co = A##bo^A##go^A##ko^A##mo^A##so;                                                            \
+   Cu = A##bu^A##gu^A##ku^A##mu^A##su;                                                            \
+   Da = Cu^SHA3_ROTL64( Ce, 1 );                                                                  \
+   De = Ca^SHA3_ROTL64( Ci, 1 );                                                                  \
+   Di = Ce^SHA3_ROTL64( Co, 1 );                                                                  \
+   Do = Ci^SHA3_ROTL64( Cu, 1 );                                                                  \
+   Du = Co^SHA3_ROTL64( Ca, 1 );                                                                  \
+   A##ba ^= Da; Ba = A##ba;                                                                       \
+   A##ge ^= De; Be = SHA3_ROTL64( A##ge, 44 );                                                    \
+   A##ki ^= Di; Bi = SHA3_ROTL64( A##ki, 43 );                                                    \
+   A##mo ^= Do; Bo = SHA3_ROTL64( A##mo, 21 );                                                    \
+   A##su ^= Du; Bu = SHA3_ROTL64( A##su, 14 );                                                    \
+   E##ba = Ba^( Be|Bi );                                                                          \
+   E##be = Be^( (~Bi)|Bo );                                                                       \
+   E##bi = Bi^( Bo&Bu );                                                                          \
+   E##bo = Bo^( Bu|Ba );                                                                          \
+   E##bu = Bu^( Ba&Be );                                                                          \
+   A##bo ^= Do; Ba = SHA3_ROTL64( A##bo, 28 );                                                    \
+   A##gu ^= Du; Be = SHA3_ROTL64( A##gu, 20 );                                                    \
+   A##ka ^= Da; Bi = SHA3_ROTL64( A##ka, 3 );                                                     \
+   A##me ^= De; Bo = SHA3_ROTL64( A##me, 45 );                                                    \
+   A##si ^= Di; Bu = SHA3_ROTL64( A##si, 61 );                                                    \
+   E##ga = Ba^( Be|Bi );                                                                          \
+   E##ge = Be^( Bi&Bo );                                                                          \
+   E##gi = Bi^( Bo|(~Bu) );                                                                       \
+   E##go = Bo^( Bu|Ba );                                                                          \
+   E##gu = Bu^( Ba&Be );                                                                          \
+   A##be ^= De; Ba = SHA3_ROTL64( A##be, 1 );                                                     \
+   A##gi ^= Di; Be = SHA3_ROTL64( A##gi, 6 );                                                     \
+   A##ko ^= Do; Bi = SHA3_ROTL64( A##ko, 25 );                                                    \
+   A##mu ^= Du; Bo = SHA3_ROTL64( A##mu, 8 );                                                     \
+   A##sa ^= Da; Bu = SHA3_ROTL64( A##sa, 18 );                                                    \
+   E##ka = Ba^( Be|Bi );                                                                          \
+   E##ke = Be^( Bi&Bo );                                                                          \
+   E##ki = Bi^( (~Bo)&Bu );                                                                       \
+   E##ko = (~Bo)^( Bu|Ba );                                                                       \
+   E##ku = Bu^( Ba&Be );                                                                          \
+   A##bu ^= Du; Ba = SHA3_ROTL64( A##bu, 27 );                                                    \
+   A##ga ^= Da; Be = SHA3_ROTL64( A##ga, 36 );                                                    \
+   A##ke ^= De; Bi = SHA3_ROTL64( A##ke, 10 );                                                    \
+   A##mi ^= Di; Bo = SHA3_ROTL64( A##mi, 15 );                                                    \
+   A##so ^= Do; Bu = SHA3_ROTL64( A##so, 56 );                                                    \
+   E##ma = Ba^( Be&Bi );                                                                          \
+   E##me = Be^( Bi|Bo );                                                                          \
+   E##mi = Bi^( (~Bo)|Bu );                                                                       \
+   E##mo = (~Bo)^( Bu&Ba );                                                                       \
+   E##mu = Bu^( Ba|Be );                                                                          \
+   A##bi ^= Di; Ba = SHA3_ROTL64( A##bi, 62 );                                                    \
+   A##go ^= Do; Be = SHA3_ROTL64( A##go, 55 );                                                    \
+   A##ku ^= Du; Bi = SHA3_ROTL64( A##ku, 39 );                                                    \
+   A##ma ^= Da; Bo = SHA3_ROTL64( A##ma, 41 );                                                    \
+   A##se ^= De; Bu = SHA3_ROTL64( A##se, 2 );                                                     \
+   E##sa = Ba^( (~Be)&Bi );                                                                       \
+   E##se = (~Be)^( Bi|Bo );                                                                       \
+   E##si = Bi^( Bo&Bu );                                                                          \
+   E##so = Bo^( Bu|Ba );                                                                          \
+   E##su = Bu^( Ba&Be );                                                                          \
+   E##ba ^= rc;
 
-/*! \brief Функция перестановок в алгоритме keccak */
-static inline void ak_hash_keccakf(ak_uint64 s[25])
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция перестановок в алгоритме keccak.
+    \details Состояние загружается в локальные переменные, слова с индексами 1, 2, 8, 12, 17 и 20
+    инвертируются; после выполнения 24-х раундов инверсия снимается.                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hash_keccakf( ak_uint64 s[25] )
 {
-    int i, j, round;
-    ak_uint64 t, bc[5];
-    const ak_uint8 keccak_rounds = 24;
+  int round;
+  ak_uint64 Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu, Aka, Ake, Aki, Ako, Aku,
+            Ama, Ame, Ami, Amo, Amu, Asa, Ase, Asi, Aso, Asu;
+  ak_uint64 Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki, Eko, Eku,
+            Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu;
+  ak_uint64 Ba, Be, Bi, Bo, Bu, Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du;
+
+  Aba =  s[ 0]; Abe = ~s[ 1]; Abi = ~s[ 2]; Abo =  s[ 3]; Abu =  s[ 4];
+  Aga =  s[ 5]; Age =  s[ 6]; Agi =  s[ 7]; Ago = ~s[ 8]; Agu =  s[ 9];
+  Aka =  s[10]; Ake =  s[11]; Aki = ~s[12]; Ako =  s[13]; Aku =  s[14];
+  Ama =  s[15]; Ame =  s[16]; Ami = ~s[17]; Amo =  s[18]; Amu =  s[19];
+  Asa = ~s[20]; Ase =  s[21]; Asi =  s[22]; Aso =  s[23]; Asu =  s[24];
+
+  for( round = 0; round < 24; round += 2 ) {
+     ak_hash_keccakf_round( A, E, keccakf_rndc[round] );
+     ak_hash_keccakf_round( E, A, keccakf_rndc[round+1] );
+  }
 
-    for(round = 0; round < keccak_rounds; round++)
-    {
-        /* Theta */
-        for(i = 0; i < 5; i++)
-            bc[i] = s[i] ^ s[i + 5] ^ s[i + 10] ^ s[i + 15] ^ s[i + 20];
-
-        for(i = 0; i < 5; i++) {
-            t = bc[(i + 4) % 5] ^ SHA3_ROTL64(bc[(i + 1) % 5], 1);
-            for(j = 0; j < 25; j += 5)
-                s[j + i] ^= t;
-        }
+  s[ 0] =  Aba; s[ 1] = ~Abe; s[ 2] = ~Abi; s[ 3] =  Abo; s[ 4] =  Abu;
+  s[ 5] =  Aga; s[ 6] =  Age; s[ 7] =  Agi; s[ 8] = ~Ago; s[ 9] =  Agu;
+  s[10] =  Aka; s[11] =  Ake; s[12] = ~Aki; s[13] =  Ako; s[14] =  Aku;
+  s[15] =  Ama; s[16] =  Ame; s[17] = ~Ami; s[18] =  Amo; s[19] =  Amu;
+  s[20] = ~Asa; s[21] =  Ase; s[22] =  Asi; s[23] =  Aso; s[24] =  Asu;
+}
 
-        /* Rho Pi */
-        t = s[1];
-        for(i = 0; i < 24; i++) {
-            j = keccakf_piln[i];
-            bc[0] = s[j];
-            s[j] = SHA3_ROTL64(t, keccakf_rotc[i]);
-            t = bc[0];
-        }
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Чтение 64-х битного слова из последовательности октетов (младший октет - первый). */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline ak_uint64 ak_hash_sha3_load64( const ak_uint8 *buf )
+{
+#ifdef LIBAKRYPT_LITTLE_ENDIAN
+  ak_uint64 t;
+  memcpy( &t, buf, sizeof( t ));
+  return t;
+#else
+  return (ak_uint64) (buf[0]) |
+        ((ak_uint64) (buf[1]) << 8 * 1) |
+        ((ak_uint64) (buf[2]) << 8 * 2) |
+        ((ak_uint64) (buf[3]) << 8 * 3) |
+        ((ak_uint64) (buf[4]) << 8 * 4) |
+        ((ak_uint64) (buf[5]) << 8 * 5) |
+        ((ak_uint64) (buf[6]) << 8 * 6) |
+        ((ak_uint64) (buf[7]) << 8 * 7);
+#endif
+}
 
-        /* Chi */
-        for(j = 0; j < 25; j += 5) {
-            for(i = 0; i < 5; i++)
-                bc[i] = s[j + i];
-            for(i = 0; i < 5; i++)
-                s[j + i] ^= (~bc[(i + 1) % 5]) & bc[(i + 2) % 5];
-        }
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param cx Контекст алгоритма SHA-3.
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_clean_sha3( ak_pointer cx )
+{
+  ak_sha3 ctx = ( ak_sha3 ) cx;
+  if( ctx == NULL ) return ak_error_null_pointer;
 
-        /* Iota */
-        s[0] ^= keccakf_rndc[round];
-    }
+  memset( ctx->s, 0, sizeof( ctx->s ));
+  ctx->saved = 0;
+  ctx->byteIndex = ctx->wordIndex = 0;
+
+ return ak_error_ok;
 }
 
-/**
- * @brief Обновление контекста хэширования sha-3
- * @param[in, out] cx -- контекст функции хэширования
- * @param[in] in -- Указатель на входные данные, для которых вычисляется хеш-код.
- * @param[in] len -- длина сообщения
- * @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
-    возвращается код ошибки.
- */
-int ak_hash_context_update_sha3( ak_pointer cx, const void* in, size_t len)
+/* ----------------------------------------------------------------------------------------------- */
+/*! Длина обрабатываемых данных может быть произвольной: неполное 64-х битное слово сохраняется
+    в контексте и дополняется при следующем вызове функции.
+
+    @param cx Контекст алгоритма SHA-3.
+    @param in Указатель на входные данные, для которых вычисляется хеш-код.
+    @param size Длина данных в октетах.
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_update_sha3( ak_pointer cx, const ak_pointer in, const size_t size )
 {
     ak_sha3 ctx = (ak_sha3) cx;
+    size_t i, words, len = size;
+    unsigned tail, old_tail;
+    const ak_uint8 *buf = in;
 
     if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                  "using null pointer to internal sha3 context" );
+    if(( !size ) || ( in == NULL )) return ak_error_ok;
 
     /* Сколько осталось необработанного сообщения */
-    unsigned old_tail = (8 - ctx->byteIndex) & 7;
-
-    size_t words;
-    unsigned tail;
-    size_t i;
-
-    const ak_uint8 *buf = in;
-
+    old_tail = (8 - ctx->byteIndex) & 7;
     if(len < old_tail)
     {
         while (len--)
@@ -154,16 +245,7 @@ int ak_hash_context_update_sha3( ak_pointer cx, const void* in, size_t len)
 
     for(i = 0; i < words; i++, buf += sizeof(ak_uint64))
     {
-        const ak_uint64 t = (ak_uint64) (buf[0]) |
-                 ((ak_uint64) (buf[1]) << 8 * 1) |
-                 ((ak_uint64) (buf[2]) << 8 * 2) |
-                 ((ak_uint64) (buf[3]) << 8 * 3) |
-                 ((ak_uint64) (buf[4]) << 8 * 4) |
-                 ((ak_uint64) (buf[5]) << 8 * 5) |
-                 ((ak_uint64) (buf[6]) << 8 * 6) |
-                 ((ak_uint64) (buf[7]) << 8 * 7);
-
-        ctx->s[ctx->wordIndex] ^= t;
+        ctx->s[ctx->wordIndex] ^= ak_hash_sha3_load64( buf );
 
         if(++ctx->wordIndex == (SHA3_KECCAK_SPONGE_WORDS - ctx->capacityWords))
         {
@@ -179,77 +261,67 @@ int ak_hash_context_update_sha3( ak_pointer cx, const void* in, size_t len)
     return ak_error_ok;
 }
 
-/**
- * @param[in] cx -- контекст функции хэширования
- * @param[out] out -- Область памяти, куда будет помещен результат.
- * @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
-    возвращается код ошибки.
- */
-int ak_hash_context_finalize_sha3(ak_pointer cx, ak_pointer out)
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция обрабатывает последний фрагмент данных, выполняет дополнение сообщения и
+    помещает хеш-код в область памяти, на которую указывает `out`. Вычисления выполняются
+    над копией контекста, поэтому функция может вызываться многократно.
+
+    @param cx Контекст алгоритма SHA-3.
+    @param in Указатель на последний фрагмент входных данных (может быть равен NULL).
+    @param size Длина фрагмента в октетах.
+    @param out Область памяти, куда будет помещен результат.
+    @param out_size Размер области памяти (в октетах); если он меньше длины хеш-кода,
+    то копируется только `out_size` октетов.
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_finalize_sha3( ak_pointer cx,
+                   const ak_pointer in, const size_t size, ak_pointer out, const size_t out_size )
 {
-    ak_sha3 ctx = ( ak_sha3 ) cx;
-    if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+    size_t i, len;
+    ak_uint8 *ptr = out;
+    struct sha3_context sx; /* структура для хранения копии текущего состояния контекста */
+
+    if( cx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                  "using null pointer to internal sha3 context" );
     if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                  "using null pointer to external result buffer" );
-    ak_uint64 t;
-
-    t = (ak_uint64)(((ak_uint64)(0x02 | (1 << 2))) << ((ctx->byteIndex) * 8));
 
-    ctx->s[ctx->wordIndex] ^= ctx->saved ^ t;
+    /* при финализации мы изменяем копию существующей структуры */
+    memcpy( &sx, cx, sizeof( struct sha3_context ));
+    ak_hash_context_update_sha3( &sx, in, size );
 
-    ctx->s[SHA3_KECCAK_SPONGE_WORDS - ctx->capacityWords - 1] ^= SHA3_CONST(0x8000000000000000UL);
+    sx.s[sx.wordIndex] ^= sx.saved ^ ((ak_uint64)( 0x02 | (1 << 2)) << ((sx.byteIndex) * 8));
+    sx.s[SHA3_KECCAK_SPONGE_WORDS - sx.capacityWords - 1] ^= SHA3_CONST(0x8000000000000000UL);
+    ak_hash_keccakf(sx.s);
 
-    ak_hash_keccakf(ctx->s);
+    /* слова состояния выводятся, начиная с младшего октета */
+    len = ak_min( sx.hsize, out_size );
+    for( i = 0; i < len; i++ ) ptr[i] = ( ak_uint8 )( sx.s[i >> 3] >> (( i&7 ) << 3 ));
 
-#ifdef LIBAKRYPT_LITTLE_ENDIAN
-    {
-        unsigned i;
-        for(i = 0; i < SHA3_KECCAK_SPONGE_WORDS; i++)
-        {
-            const unsigned t1 = (ak_uint32) ctx->s[i];
-            const unsigned t2 = (ak_uint32) ((ctx->s[i] >> 16) >> 16);
-            ctx->sb[i * 8 + 0] = (ak_uint8) (t1);
-            ctx->sb[i * 8 + 1] = (ak_uint8) (t1 >> 8);
-            ctx->sb[i * 8 + 2] = (ak_uint8) (t1 >> 16);
-            ctx->sb[i * 8 + 3] = (ak_uint8) (t1 >> 24);
-            ctx->sb[i * 8 + 4] = (ak_uint8) (t2);
-            ctx->sb[i * 8 + 5] = (ak_uint8) (t2 >> 8);
-            ctx->sb[i * 8 + 6] = (ak_uint8) (t2 >> 16);
-            ctx->sb[i * 8 + 7] = (ak_uint8) (t2 >> 24);
-        }
-    }
-#endif
-    unsigned outBytes = sizeof(ctx->sb);
-    memcpy(out, ctx->sb, outBytes);
     return ak_error_ok;
 }
 
-/**
- * @param[in] bitSize -- версия sha-3 (256, 384, 512)
- * @param[in] in -- Указатель на входные данные, для которых вычисляется хеш-код.
- * @param[in] inSize -- размер входных данных
- * @param[out] out Область памяти, куда будет помещен результат.
- * @param[in] outSize -- размер области памяти, куда будет помещен результат
- * @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
-    возвращается код ошибки.
- */
-int ak_hash_context_ptr_sha3( unsigned bitSize, const void* in, size_t inSize, ak_pointer out, size_t outSize )
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param bitSize Версия sha-3 (256, 384, 512).
+    @param in Указатель на входные данные, для которых вычисляется хеш-код.
+    @param inSize Размер входных данных.
+    @param out Область памяти, куда будет помещен результат.
+    @param outSize Размер области памяти, куда будет помещен результат.
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_ptr_sha3( unsigned bitSize,
+                            const ak_pointer in, const size_t inSize, ak_pointer out, size_t outSize )
 {
     int error;
     struct sha3_context c;
-    ak_uint8 buf[bitSize];
-    if(( error = ak_hash_context_create_sha3( &c, bitSize )) != ak_error_ok )
-    {
-        ak_error_message( error, __func__ , "wrong initialization of sha3 context" );
-        return ak_false;
-    }
-    ak_hash_context_update_sha3(&c, in, inSize);
-    ak_hash_context_finalize_sha3(&c, buf);
 
-    if(outSize > bitSize/8) outSize = bitSize/8;
-    memcpy(out, buf, outSize);
-    return ak_error_ok;
+    if(( error = ak_hash_context_create_sha3( &c, bitSize )) != ak_error_ok )
+      return ak_error_message( error, __func__ , "wrong initialization of sha3 context" );
+    if(( error = ak_hash_context_update_sha3( &c, in, inSize )) != ak_error_ok )
+      return ak_error_message( error, __func__ , "wrong updating of sha3 context" );
+    return ak_hash_context_finalize_sha3( &c, NULL, 0, out, outSize );
 }
 
 
@@ -316,6 +388,175 @@ int ak_hash_context_ptr_sha3( unsigned bitSize, const void* in, size_t inSize, a
        for ( idx = 0; idx < 8; idx++ ) ctx->h[idx] ^= T[idx] ^ K[idx] ^ m[idx];
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Таблица преобразования LPS, в которую заранее подставлены значения нелинейного
+    преобразования \f$ \pi \f$; заполняется функцией ak_hash_context_streebog_init_implementation(). */
+ static ak_uint64 streebog_lps_table[8][256];
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Флаг использования оптимизированной реализации функции сжатия.
+    \details Значение флага определяется при инициализации библиотеки в зависимости от
+    возможностей процессора, см. ak_hash_context_streebog_init_implementation(). */
+ static bool_t streebog_fast_implementation = ak_false;
+
+#ifdef LIBAKRYPT_LITTLE_ENDIAN
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Совмещенное преобразование LPSX (result = LPS( k xor a )).
+    \details Байты вектора извлекаются сдвигами из 64-х битных слов, поэтому функция может
+    использоваться только на платформах с порядком байт little endian. Допускается совпадение
+    массива result с одним из массивов k или a.
+    \note Мы предполагаем, что данные содержат 64 байта.                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_hash_context_streebog_xlps( ak_uint64 *result,
+                                                       const ak_uint64 *k, const ak_uint64 *a )
+{
+  unsigned int idx = 0, s = 0;
+  ak_uint64 r[8];
+
+#ifdef LIBAKRYPT_HAVE_BUILTIN_XOR_SI128
+  for( idx = 0; idx < 4; idx++ )
+     _mm_storeu_si128( (__m128i *) r + idx, _mm_xor_si128(
+                _mm_loadu_si128(( const __m128i *) k + idx ),
+                                                 _mm_loadu_si128(( const __m128i *) a + idx )));
+#else
+  for( idx = 0; idx < 8; idx++ ) r[idx] = k[idx] ^ a[idx];
+#endif
+
+  for( idx = 0; idx < 8; idx++, s += 8 )
+     result[idx] = streebog_lps_table[0][( r[0] >> s )&0xff] ^
+                   streebog_lps_table[1][( r[1] >> s )&0xff] ^
+                   streebog_lps_table[2][( r[2] >> s )&0xff] ^
+                   streebog_lps_table[3][( r[3] >> s )&0xff] ^
+                   streebog_lps_table[4][( r[4] >> s )&0xff] ^
+                   streebog_lps_table[5][( r[5] >> s )&0xff] ^
+                   streebog_lps_table[6][( r[6] >> s )&0xff] ^
+                   streebog_lps_table[7][( r[7] >> s )&0xff];
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Оптимизированное преобразование G, использующее совмещенную таблицу LPS.
+    \note Мы предполагаем, что массивы n и m содержат по 64 байта.                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hash_context_streebog_g_fast( ak_streebog ctx, ak_uint64 *n, const ak_uint64 *m )
+{
+   int idx = 0;
+   ak_uint64 K[8], T[8];
+   static const ak_uint64 zero[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+   ak_hash_context_streebog_xlps( K, ctx->h, n == NULL ? zero : n );
+   for( idx = 0; idx < 8; idx++ ) T[idx] = m[idx];
+
+   for( idx = 0; idx < 12; idx++ ) {
+      ak_hash_context_streebog_xlps( T, T, K );                /* преобразуем текст */
+      ak_hash_context_streebog_xlps( K, K, streebog_c[idx] );  /* новый ключ */
+   }
+
+  /* изменяем значение переменной h */
+#ifdef LIBAKRYPT_HAVE_BUILTIN_XOR_SI128
+   for( idx = 0; idx < 4; idx++ ) {
+      __m128i *h = (__m128i *) ctx->h + idx;
+      _mm_storeu_si128( h, _mm_xor_si128( _mm_xor_si128( _mm_loadu_si128( h ),
+                                                 _mm_loadu_si128(( const __m128i *) m + idx )),
+         _mm_xor_si128( _mm_loadu_si128(( const __m128i *) T + idx ),
+                                                 _mm_loadu_si128(( const __m128i *) K + idx ))));
+   }
+#else
+   for ( idx = 0; idx < 8; idx++ ) ctx->h[idx] ^= T[idx] ^ K[idx] ^ m[idx];
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование G, одновременно применяемое к нескольким независимым состояниям.
+    \details Раунды для всех состояний выполняются поочередно, что позволяет процессору
+    совмещать по времени независимые цепочки табличных преобразований. Если значение `use_n`
+    ложно, то вместо векторов n состояний используется нулевой вектор (как при завершении
+    вычислений).
+    \note Мы предполагаем, что количество состояний не превышает \ref ak_hash_streebog_lanes. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hash_context_streebog_g_lanes( ak_streebog *ctx,
+                                  const ak_uint64 **m, const size_t lanes, const bool_t use_n )
+{
+   int idx = 0;
+   size_t l = 0;
+   ak_uint64 K[ak_hash_streebog_lanes][8], T[ak_hash_streebog_lanes][8];
+   static const ak_uint64 zero[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+   for( l = 0; l < lanes; l++ ) {
+      ak_hash_context_streebog_xlps( K[l], ctx[l]->h, use_n ? ctx[l]->n : zero );
+      for( idx = 0; idx < 8; idx++ ) T[l][idx] = m[l][idx];
+   }
+   for( idx = 0; idx < 12; idx++ ) {
+      for( l = 0; l < lanes; l++ ) ak_hash_context_streebog_xlps( T[l], T[l], K[l] );
+      for( l = 0; l < lanes; l++ ) ak_hash_context_streebog_xlps( K[l], K[l], streebog_c[idx] );
+   }
+   for( l = 0; l < lanes; l++ )
+      for( idx = 0; idx < 8; idx++ ) ctx[l]->h[idx] ^= T[l][idx] ^ K[l][idx] ^ m[l][idx];
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция сжатия, выбирающая реализацию преобразования G.                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_hash_context_streebog_compress( ak_streebog ctx,
+                                                                ak_uint64 *n, const ak_uint64 *m )
+{
+#ifdef LIBAKRYPT_LITTLE_ENDIAN
+  if( streebog_fast_implementation ) ak_hash_context_streebog_g_fast( ctx, n, m );
+    else
+#endif
+  ak_hash_context_streebog_g( ctx, n, m );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция сжатия для нескольких независимых состояний (см. ak_hash_context_streebog_g_lanes()). */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_hash_context_streebog_compress_lanes( ak_streebog *ctx,
+                                  const ak_uint64 **m, const size_t lanes, const bool_t use_n )
+{
+  size_t l = 0;
+#ifdef LIBAKRYPT_LITTLE_ENDIAN
+  if( streebog_fast_implementation ) {
+    ak_hash_context_streebog_g_lanes( ctx, m, lanes, use_n );
+    return;
+  }
+#endif
+  for( l = 0; l < lanes; l++ )
+     ak_hash_context_streebog_g( ctx[l], use_n ? ctx[l]->n : NULL, m[l] );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет таблицу преобразования LPS с совмещенной подстановкой \f$ \pi \f$ и,
+    на платформах с порядком байт little endian, устанавливает оптимизированную (табличную)
+    реализацию функции сжатия алгоритма Стрибог. В противном случае используется исходная
+    (скалярная) реализация. Команды sse2, используемые табличной реализацией при наличии
+    флага LIBAKRYPT_HAVE_BUILTIN_XOR_SI128, выбираются на этапе сборки библиотеки.
+    Функция вызывается при инициализации библиотеки.
+
+    @return Функция возвращает \ref ak_error_ok (ноль).                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_streebog_init_implementation( void )
+{
+  int i = 0, j = 0, audit = ak_log_get_level();
+
+  for( i = 0; i < 8; i++ )
+     for( j = 0; j < 256; j++ )
+        streebog_lps_table[i][j] = streebog_Areverse_expand[i][gost_pi[j]];
+
+#ifdef LIBAKRYPT_LITTLE_ENDIAN
+  streebog_fast_implementation = ak_true;
+#else
+  streebog_fast_implementation = ak_false;
+#endif
+
+  if( audit >= ak_log_maximum ) {
+    if( streebog_fast_implementation ) ak_error_message( ak_error_ok, __func__,
+                                      "using table driven realization of streebog hash function" );
+      else ak_error_message( ak_error_ok, __func__,
+                                            "using scalar realization of streebog hash function" );
+  }
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Преобразование Add (увеличение счетчика длины обработаного сообщения).                  */
 /* ----------------------------------------------------------------------------------------------- */
@@ -382,6 +623,17 @@ int ak_hash_context_ptr_sha3( unsigned bitSize, const void* in, size_t inSize, a
 }
 
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Длина обрабатываемых данных должна быть кратна 64 октетам. Данные, выровненные на границу
+    8 октетов, обрабатываются непосредственно в памяти вызывающей стороны; данные с произвольным
+    выравниванием поблочно копируются в выровненный локальный массив, поскольку преобразования
+    функции сжатия обращаются к данным как к массиву 64-х битных слов.
+
+    @param sctx Контекст алгоритма Стрибог.
+    @param in Указатель на обрабатываемые данные (выравнивание может быть произвольным).
+    @param size Длина данных в октетах.
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
 /* ----------------------------------------------------------------------------------------------- */
  int ak_hash_context_update_streebog( ak_pointer sctx, const ak_pointer in, const size_t size )
 {
@@ -393,8 +645,22 @@ int ak_hash_context_ptr_sha3( unsigned bitSize, const void* in, size_t inSize, a
   if(( !size ) || ( in == NULL )) return ak_error_ok;
   if(( size - ( quot << 6 )) != 0 ) return ak_error_message( ak_error_wrong_length, __func__,
                                       "data length is not a multiple of the length of the block" );
+  if((( size_t ) in )&( sizeof( ak_uint64 ) - 1 )) {
+    ak_uint64 m[8];
+    const ak_uint8 *ptr = ( const ak_uint8 *) in;
+    do{
+        memcpy( m, ptr, sizeof( m ));
+        ak_hash_context_streebog_compress( cx, cx->n, m );
+        ak_hash_context_streebog_add( cx, 512 );
+        ak_hash_context_streebog_sadd( cx, m );
+        quot--; ptr += sizeof( m );
+    } while( quot > 0 );
+    memset( m, 0, sizeof( m ));
+    return ak_error_ok;
+  }
+
   do{
-      ak_hash_context_streebog_g( cx, cx->n, dt );
+      ak_hash_context_streebog_compress( cx, cx->n, dt );
       ak_hash_context_streebog_add( cx, 512 );
       ak_hash_context_streebog_sadd( cx, dt );
       quot--; dt += 8;
@@ -428,11 +694,11 @@ int ak_hash_context_ptr_sha3( unsigned bitSize, const void* in, size_t inSize, a
 
   /* при финализации мы изменяем копию существующей структуры */
   memcpy( &sx, cx, sizeof( struct streebog ));
-  ak_hash_context_streebog_g( &sx, sx.n, m );
+  ak_hash_context_streebog_compress( &sx, sx.n, m );
   ak_hash_context_streebog_add( &sx, size << 3 );
   ak_hash_context_streebog_sadd( &sx, m );
-  ak_hash_context_streebog_g( &sx, NULL, sx.n );
-  ak_hash_context_streebog_g( &sx, NULL, sx.sigma );
+  ak_hash_context_streebog_compress( &sx, NULL, sx.n );
+  ak_hash_context_streebog_compress( &sx, NULL, sx.sigma );
 
  /* копируем нужную часть результирующего массива или выдаем сообщение об ошибке */
     if( cx->hsize == 64 ) memcpy( out, sx.h, ak_min( 64, out_size ));
@@ -440,6 +706,75 @@ int ak_hash_context_ptr_sha3( unsigned bitSize, const void* in, size_t inSize, a
  return result;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция продолжает вычисления для нескольких независимых состояний алгоритма Стрибог:
+    к каждому состоянию добавляется один полный блок данных (64 октета), после чего вычисление
+    хеш-кода завершается так же, как функцией ak_hash_context_finalize_streebog() с пустым
+    остатком сообщения. Все сжатия выполняются одновременно для всех состояний
+    (см. ak_hash_context_streebog_g_lanes()). Сами состояния не изменяются.
+
+    Функция предназначена для алгоритмов, многократно хеширующих сообщения фиксированной длины
+    от предвычисленных состояний, например, для итераций алгоритма PBKDF2.
+
+    @param ctx Массив указателей на состояния алгоритма Стрибог.
+    @param m Массив указателей на добавляемые блоки (64 октета, выровнены на границу 8 октетов).
+    @param out Массив указателей на области памяти для хеш-кодов (не менее `hsize` октетов);
+    область памяти может совпадать с соответствующим блоком `m`.
+    @param lanes Количество состояний, не более \ref ak_hash_streebog_lanes.
+
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_streebog_block_lanes( ak_streebog *ctx, const ak_uint64 **m,
+                                                            ak_uint8 **out, const size_t lanes )
+{
+  size_t l = 0;
+  struct streebog sx[ak_hash_streebog_lanes];
+  ak_streebog sctx[ak_hash_streebog_lanes];
+  const ak_uint64 *mx[ak_hash_streebog_lanes];
+  static const ak_uint64 pad[8] = {
+  #ifdef LIBAKRYPT_LITTLE_ENDIAN
+    1,
+  #else
+    0x0100000000000000LL,
+  #endif
+    0, 0, 0, 0, 0, 0, 0 };
+
+  if(( ctx == NULL ) || ( m == NULL ) || ( out == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer to lanes" );
+  if(( lanes == 0 ) || ( lanes > ak_hash_streebog_lanes ))
+    return ak_error_message( ak_error_wrong_length, __func__, "using wrong number of lanes" );
+
+  for( l = 0; l < lanes; l++ ) {
+     memcpy( sx+l, ctx[l], sizeof( struct streebog ));
+     sctx[l] = sx+l;
+  }
+ /* очередной блок данных */
+  ak_hash_context_streebog_compress_lanes( sctx, m, lanes, ak_true );
+  for( l = 0; l < lanes; l++ ) {
+     ak_hash_context_streebog_add( sx+l, 512 );
+     ak_hash_context_streebog_sadd( sx+l, m[l] );
+     mx[l] = pad;
+  }
+ /* дополнение пустого остатка сообщения */
+  ak_hash_context_streebog_compress_lanes( sctx, mx, lanes, ak_true );
+  for( l = 0; l < lanes; l++ ) {
+     ak_hash_context_streebog_sadd( sx+l, pad );
+     mx[l] = sx[l].n;
+  }
+ /* завершающие преобразования с длиной сообщения и контрольной суммой */
+  ak_hash_context_streebog_compress_lanes( sctx, mx, lanes, ak_false );
+  for( l = 0; l < lanes; l++ ) mx[l] = sx[l].sigma;
+  ak_hash_context_streebog_compress_lanes( sctx, mx, lanes, ak_false );
+
+  for( l = 0; l < lanes; l++ ) {
+     if( sx[l].hsize == 64 ) memcpy( out[l], sx[l].h, 64 );
+       else memcpy( out[l], sx[l].h+4, 32 );
+  }
+  memset( sx, 0, sizeof( sx ));
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                               Реализация функций класса ak_sha3 (контекст sha3)                 */
 /* ----------------------------------------------------------------------------------------------- */
@@ -451,23 +786,67 @@ int ak_hash_context_create_sha3( ak_sha3 ctx, unsigned bitSize)
      return ak_error_message( ak_error_invalid_value, __func__,
                               "incorrect size of sha3's output" );
  memset(ctx, 0, sizeof(*ctx));
+ ctx->hsize = bitSize >> 3;
  ctx->capacityWords = 2 * bitSize / (8 * sizeof(ak_uint64));
  return ak_error_ok;
 }
 
-int ak_hash_context_create_sha3_256( ak_sha3 ctx )
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Инициализация контекста бесключевого хеширования алгоритмом SHA-3 заданной длины.
+    \details Длина входного блока сжимающего отображения совпадает со скоростью губки
+    (200 - 2*bitSize/8 октетов), поэтому данные передаются функции обновления без копирования.
+
+    @param hctx Контекст функции хеширования
+    @param name Имя OID алгоритма хеширования
+    @param bitSize Длина хеш-кода в битах (256, 384 или 512)
+    @return Функция возвращает код ошибки или \ref ak_error_ok (в случае успеха)                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_context_create_sha3_oid( ak_hash hctx, const char *name, unsigned bitSize )
+{
+  int error = ak_error_ok;
+  if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to hash context" );
+  if(( error = ak_hash_context_create_sha3( &hctx->data.sha3, bitSize )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect initialization of sha3 context" );
+  if(( hctx->oid = ak_oid_context_find_by_name( name )) == NULL )
+    return ak_error_message_fmt( ak_error_wrong_oid, __func__,
+                                                   "incorrect internal search of %s identifier", name );
+  if(( error = ak_mac_context_create( &hctx->mctx,
+                      sizeof( ak_uint64 )*( SHA3_KECCAK_SPONGE_WORDS - hctx->data.sha3.capacityWords ),
+                                             &hctx->data.sha3,
+                                             ak_hash_context_clean_sha3,
+                                             ak_hash_context_update_sha3,
+                                             ak_hash_context_finalize_sha3 )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect initialization of internal mac context" );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param hctx Контекст функции хеширования
+    @return Функция возвращает код ошибки или \ref ak_error_ok (в случае успеха)                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_create_sha3_256( ak_hash hctx )
 {
- return ak_hash_context_create_sha3(ctx, 256);
+ return ak_hash_context_create_sha3_oid( hctx, "sha3-256", 256 );
 }
 
-int ak_hash_context_create_sha3_384( ak_sha3 ctx )
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param hctx Контекст функции хеширования
+    @return Функция возвращает код ошибки или \ref ak_error_ok (в случае успеха)                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_create_sha3_384( ak_hash hctx )
 {
- return ak_hash_context_create_sha3(ctx, 384);
+ return ak_hash_context_create_sha3_oid( hctx, "sha3-384", 384 );
 }
 
-int ak_hash_context_create_sha3_512( ak_sha3 ctx )
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param hctx Контекст функции хеширования
+    @return Функция возвращает код ошибки или \ref ak_error_ok (в случае успеха)                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_create_sha3_512( ak_hash hctx )
 {
- return ak_hash_context_create_sha3(ctx, 512);
+ return ak_hash_context_create_sha3_oid( hctx, "sha3-512", 512 );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -572,7 +951,7 @@ int ak_hash_context_create_sha3_512( ak_sha3 ctx )
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                        "destroying null pointer to hash context" );
   hctx->oid = NULL;
-  memset( &hctx->data.sctx, 0, sizeof( struct streebog ));
+  memset( &hctx->data, 0, sizeof( hctx->data ));
   if( ak_mac_context_destroy( &hctx->mctx ) != ak_error_ok )
     ak_error_message( ak_error_get_value(), __func__,
                                                     "incorrect cleaning of internal mac context" );
@@ -648,6 +1027,107 @@ int ak_hash_context_create_sha3_512( ak_sha3 ctx )
  return ak_mac_context_ptr( &hctx->mctx, in, size, out, out_size );
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет хеш-коды нескольких независимых сообщений. Для алгоритмов семейства Стрибог
+    до \ref ak_hash_streebog_lanes сообщений обрабатываются одновременно: очередные блоки всех
+    обрабатываемых сообщений сжимаются за один вызов функции сжатия, раунды которой
+    чередуются между сообщениями. Сообщение, все полные блоки которого обработаны,
+    завершается, а его место занимает следующее сообщение из массива заданий; поэтому
+    сообщения могут иметь разную длину. Для остальных алгоритмов хеширования сообщения
+    обрабатываются последовательно функцией ak_hash_context_ptr().
+
+    Текущее состояние контекста `hctx` не изменяется; контекст используется только для
+    определения алгоритма хеширования.
+
+    @param hctx Контекст функции хеширования.
+    @param jobs Массив заданий, каждое из которых содержит указатель на сообщение, его длину
+    и область памяти для хеш-кода.
+    @param count Количество заданий.
+
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_ptr_multi( ak_hash hctx, ak_hash_job jobs, const size_t count )
+{
+  size_t i = 0, active = 0, next = 0;
+  int error = ak_error_ok;
+  struct streebog lanes[ak_hash_streebog_lanes];
+  ak_hash_job current[ak_hash_streebog_lanes];
+  size_t blocks[ak_hash_streebog_lanes], index[ak_hash_streebog_lanes];
+  ak_streebog sctx[ak_hash_streebog_lanes];
+  const ak_uint64 *m[ak_hash_streebog_lanes];
+  ak_uint64 aligned[ak_hash_streebog_lanes][8];
+
+  if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to hash context" );
+  if(( jobs == NULL ) && ( count != 0 )) return ak_error_message( ak_error_null_pointer,
+                                                       __func__, "using null pointer to hash jobs" );
+  for( i = 0; i < count; i++ ) {
+     if(( jobs[i].in == NULL ) && ( jobs[i].size != 0 ))
+       return ak_error_message( ak_error_null_pointer, __func__, "using null pointer to message" );
+     if( jobs[i].out == NULL )
+       return ak_error_message( ak_error_null_pointer, __func__, "using null pointer to result" );
+  }
+
+ /* для алгоритмов, отличных от Стрибог, сообщения обрабатываются последовательно */
+  if( hctx->mctx.update != ak_hash_context_update_streebog ) {
+    struct hash ctx;
+    if(( error = ak_hash_context_create_oid( &ctx, hctx->oid )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect creation of hash context" );
+    for( i = 0; i < count; i++ )
+       if(( error = ak_hash_context_ptr( &ctx, jobs[i].in, jobs[i].size,
+                                                jobs[i].out, jobs[i].out_size )) != ak_error_ok ) {
+         ak_error_message( error, __func__, "incorrect hashing of message" );
+         break;
+       }
+    ak_hash_context_destroy( &ctx );
+    return error;
+  }
+
+  for( i = 0; i < ak_hash_streebog_lanes; i++ ) current[i] = NULL;
+  do{
+     for( i = 0, active = 0; i < ak_hash_streebog_lanes; i++ ) {
+        for( ;; ) {
+           if( current[i] != NULL ) {
+             if( blocks[i] ) break;
+            /* все полные блоки обработаны: завершаем вычисление хеш-кода */
+             ak_hash_context_finalize_streebog( lanes+i, (ak_uint8 *)m[i], current[i]->size%64,
+                                                        current[i]->out, current[i]->out_size );
+             current[i] = NULL;
+           }
+           if( next == count ) break;
+          /* помещаем на освободившееся место следующее сообщение */
+           current[i] = jobs + next++;
+           lanes[i].hsize = hctx->data.sctx.hsize;
+           ak_hash_context_clean_streebog( lanes+i );
+           m[i] = ( const ak_uint64 *) current[i]->in;
+           blocks[i] = current[i]->size >> 6;
+        }
+        if( current[i] != NULL ) { sctx[active] = lanes+i; index[active++] = i; }
+     }
+     if( active ) {
+       const ak_uint64 *mx[ak_hash_streebog_lanes];
+       for( i = 0; i < active; i++ ) {
+         /* невыровненные данные копируются в локальный массив (см. ak_hash_context_update_streebog()) */
+          if((( size_t ) m[index[i]] )&( sizeof( ak_uint64 ) - 1 )) {
+            memcpy( aligned[i], m[index[i]], sizeof( aligned[i] ));
+            mx[i] = aligned[i];
+          } else mx[i] = m[index[i]];
+       }
+       ak_hash_context_streebog_compress_lanes( sctx, mx, active, ak_true );
+       for( i = 0; i < active; i++ ) {
+          ak_hash_context_streebog_add( sctx[i], 512 );
+          ak_hash_context_streebog_sadd( sctx[i], mx[i] );
+          m[index[i]] += 8; blocks[index[i]]--;
+       }
+     }
+  } while( active );
+
+  memset( lanes, 0, sizeof( lanes ));
+  memset( aligned, 0, sizeof( aligned ));
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param hctx Контекст функции хеширования
     @param filename Имя файла, для котрого вычисляется хеш-код.
@@ -679,6 +1159,64 @@ int ak_hash_context_create_sha3_512( ak_sha3 ctx )
  return ak_mac_context_clean( &hctx->mctx );
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция создает в `dst` независимую копию контекста `src`: копируются внутреннее состояние
+    алгоритма хеширования и накопленный неполный блок данных. Функции создания контекста
+    не вызываются, поэтому контекст `dst` может быть не инициализирован; после использования
+    он уничтожается функцией ak_hash_context_destroy().
+
+    Функция позволяет один раз обработать общий префикс нескольких сообщений и затем продолжать
+    вычисления для каждого сообщения от сохраненного состояния.
+
+    @param dst Контекст функции хеширования, в который производится копирование.
+    @param src Копируемый контекст функции хеширования.
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_clone( ak_hash dst, ak_hash src )
+{
+  int error = ak_error_ok;
+  if(( dst == NULL ) || ( src == NULL )) return ak_error_message( ak_error_null_pointer,
+                                                  __func__, "using null pointer to hash context" );
+  if( src->oid == NULL ) return ak_error_message( ak_error_wrong_oid, __func__,
+                                                      "using uninitialized source hash context" );
+  if( dst == src ) return ak_error_ok;
+
+  dst->oid = src->oid;
+  memcpy( &dst->data, &src->data, sizeof( dst->data ));
+  if(( error = ak_mac_context_clone( &dst->mctx, &src->mctx, &dst->data )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect copying of internal mac context" );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция переносит в контекст `dst` состояние контекста `src`. В отличие от функции
+    ak_hash_context_clone() контекст `dst` должен быть создан для того же алгоритма хеширования;
+    это позволяет многократно возвращать рабочий контекст к заранее вычисленному состоянию.
+
+    @param dst Контекст функции хеширования, состояние которого восстанавливается.
+    @param src Контекст функции хеширования, содержащий сохраненное состояние.
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_restore( ak_hash dst, ak_hash src )
+{
+  int error = ak_error_ok;
+  if(( dst == NULL ) || ( src == NULL )) return ak_error_message( ak_error_null_pointer,
+                                                  __func__, "using null pointer to hash context" );
+  if(( src->oid == NULL ) || ( dst->oid != src->oid ))
+    return ak_error_message( ak_error_wrong_oid, __func__,
+                                                "using hash contexts of different algorithms" );
+  if( dst == src ) return ak_error_ok;
+
+  if(( error = ak_mac_context_restore( &dst->mctx, &src->mctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect restoring of internal mac context" );
+  memcpy( &dst->data, &src->data, sizeof( dst->data ));
+
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param hctx Контекст функции хеширования
     @param in Указатель на входные данные для которых вычисляется хеш-код.
@@ -783,6 +1321,7 @@ int ak_hash_context_create_sha3_512( ak_sha3 ctx )
 bool_t ak_hash_test_sha3_256( void )
 {
     ak_uint8 buf[200];  /* 200 раз повторяется A3 в тестовом сообщении */
+    struct hash hctx;
     struct sha3_context c;
     bool_t result = ak_true;
     ak_uint8 out[256 / 8];
@@ -794,7 +1333,7 @@ bool_t ak_hash_test_sha3_256( void )
     }
 
     /* Тестирование пустого буффера */
-    ak_hash_context_finalize_sha3(&c, &out);
+    ak_hash_context_finalize_sha3( &c, NULL, 0, out, sizeof( out ));
     if(ak_ptr_is_equal_with_log(sha3_256_empty, out, sizeof(sha3_256_empty)) != ak_true)
     {
          ak_error_message( ak_error_not_equal_data, __func__ , "the zero length vector test is wrong" );
@@ -819,19 +1358,35 @@ bool_t ak_hash_test_sha3_256( void )
          result = ak_false;
     }
     ak_hash_context_update_sha3(&c, buf, sizeof(buf));
-    ak_hash_context_finalize_sha3(&c, out);
+    ak_hash_context_finalize_sha3( &c, NULL, 0, out, sizeof( out ));
 
     if(ak_ptr_is_equal_with_log(sha3_256_NIST_test, out, sizeof(sha3_256_NIST_test)) != ak_true)
     {
          ak_error_message( ak_error_not_equal_data, __func__ , "incorrect hashing of NIST 1600-bit testing message" );
          result = ak_false;
     }
+
+    /* Тот же пример, вычисляемый с помощью контекста бесключевой функции хеширования */
+    if(( error = ak_hash_context_create_sha3_256( &hctx )) != ak_error_ok )
+    {
+         ak_error_message( error, __func__ , "wrong initialization of hash context" );
+         return ak_false;
+    }
+    memset( out, 0, sizeof( out ));
+    ak_hash_context_ptr( &hctx, buf, sizeof( buf ), out, sizeof( out ));
+    ak_hash_context_destroy( &hctx );
+    if(ak_ptr_is_equal_with_log(sha3_256_NIST_test, out, sizeof(sha3_256_NIST_test)) != ak_true)
+    {
+         ak_error_message( ak_error_not_equal_data, __func__ , "incorrect hashing of NIST testing message by hash context" );
+         result = ak_false;
+    }
     return result;
 }
 
 bool_t ak_hash_test_sha3_384( void )
 {
     ak_uint8 buf[200];  /* 200 раз повторяется A3 в тестовом сообщении */
+    struct hash hctx;
     struct sha3_context c;
     bool_t result = ak_true;
     ak_uint8 out[384 / 8];
@@ -843,7 +1398,7 @@ bool_t ak_hash_test_sha3_384( void )
     }
 
     /* Тестирование пустого буффера */
-    ak_hash_context_finalize_sha3(&c, &out);
+    ak_hash_context_finalize_sha3( &c, NULL, 0, out, sizeof( out ));
     if(ak_ptr_is_equal_with_log(sha3_384_empty, out, sizeof(sha3_384_empty)) != ak_true)
     {
          ak_error_message( ak_error_not_equal_data, __func__ , "the zero length vector test is wrong" );
@@ -869,19 +1424,35 @@ bool_t ak_hash_test_sha3_384( void )
     }
 
     ak_hash_context_update_sha3(&c, buf, sizeof(buf));
-    ak_hash_context_finalize_sha3(&c, out);
+    ak_hash_context_finalize_sha3( &c, NULL, 0, out, sizeof( out ));
 
     if(ak_ptr_is_equal_with_log(sha3_384_NIST_test, out, sizeof(sha3_384_NIST_test)) != ak_true)
     {
          ak_error_message( ak_error_not_equal_data, __func__ , "incorrect hashing of NIST testing message" );
          result = ak_false;
     }
+
+    /* Тот же пример, вычисляемый с помощью контекста бесключевой функции хеширования */
+    if(( error = ak_hash_context_create_sha3_384( &hctx )) != ak_error_ok )
+    {
+         ak_error_message( error, __func__ , "wrong initialization of hash context" );
+         return ak_false;
+    }
+    memset( out, 0, sizeof( out ));
+    ak_hash_context_ptr( &hctx, buf, sizeof( buf ), out, sizeof( out ));
+    ak_hash_context_destroy( &hctx );
+    if(ak_ptr_is_equal_with_log(sha3_384_NIST_test, out, sizeof(sha3_384_NIST_test)) != ak_true)
+    {
+         ak_error_message( ak_error_not_equal_data, __func__ , "incorrect hashing of NIST testing message by hash context" );
+         result = ak_false;
+    }
     return result;
 }
 
 bool_t ak_hash_test_sha3_512( void )
 {
     ak_uint8 buf[200];  /* 200 раз повторяется A3 в тестовом сообщении */
+    struct hash hctx;
     struct sha3_context c;
     bool_t result = ak_true;
     ak_uint8 out[512 / 8];
@@ -893,7 +1464,7 @@ bool_t ak_hash_test_sha3_512( void )
     }
 
     /* Тестирование пустого буффера */
-    ak_hash_context_finalize_sha3(&c, &out);
+    ak_hash_context_finalize_sha3( &c, NULL, 0, out, sizeof( out ));
     if(ak_ptr_is_equal_with_log(sha3_512_empty, out, sizeof(sha3_512_empty)) != ak_true)
     {
          ak_error_message( ak_error_not_equal_data, __func__ , "the zero length vector test is wrong" );
@@ -921,7 +1492,7 @@ bool_t ak_hash_test_sha3_512( void )
     }
 
     ak_hash_context_update_sha3(&c, buf, sizeof(buf));
-    ak_hash_context_finalize_sha3(&c, out);
+    ak_hash_context_finalize_sha3( &c, NULL, 0, out, sizeof( out ));
 
     if(ak_ptr_is_equal_with_log(sha3_512_NIST_test, out, sizeof(sha3_512_NIST_test)) != ak_true)
     {
@@ -929,6 +1500,21 @@ bool_t ak_hash_test_sha3_512( void )
          printf("512 nist\n");
          result = ak_false;
     }
+
+    /* Тот же пример, вычисляемый с помощью контекста бесключевой функции хеширования */
+    if(( error = ak_hash_context_create_sha3_512( &hctx )) != ak_error_ok )
+    {
+         ak_error_message( error, __func__ , "wrong initialization of hash context" );
+         return ak_false;
+    }
+    memset( out, 0, sizeof( out ));
+    ak_hash_context_ptr( &hctx, buf, sizeof( buf ), out, sizeof( out ));
+    ak_hash_context_destroy( &hctx );
+    if(ak_ptr_is_equal_with_log(sha3_512_NIST_test, out, sizeof(sha3_512_NIST_test)) != ak_true)
+    {
+         ak_error_message( ak_error_not_equal_data, __func__ , "incorrect hashing of NIST testing message by hash context" );
+         result = ak_false;
+    }
     return result;
 }
 
@@ -21,20 +21,21 @@ extern "C" {
 /*! \brief Структура для хранения внутренних данных функций хеширования семейства Стрибог. */
 /* ----------------------------------------------------------------------------------------------- */
  typedef struct streebog {
+ /*! \brief Размер блока выходных данных (хеш-кода)*/
+  size_t hsize;
  /*! \brief Вектор h - временный */
   ak_uint64 h[8];
  /*! \brief Вектор n - временный */
   ak_uint64 n[8];
  /*! \brief Вектор  \f$ \Sigma \f$ - контрольная сумма */
   ak_uint64 sigma[8];
- /*! \brief Размер блока выходных данных (хеш-кода)*/
-  size_t hsize;
 } *ak_streebog;
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Структура для хранения внутренних данных функции хеширования SHA-3 (Keccak) */
 /* ----------------------------------------------------------------------------------------------- */
 typedef struct sha3_context {
+    size_t hsize;               /*! Размер блока выходных данных (хеш-кода) */
     ak_uint64 saved;
     union {                     // Состояние (из алгоритма Keccak)
         ak_uint64 s[SHA3_KECCAK_SPONGE_WORDS];
@@ -45,6 +46,18 @@ typedef struct sha3_context {
     unsigned capacityWords;     // Увеличенная в два раза длина выходного хэша
 } *ak_sha3;
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Внутреннее состояние бесключевой функции хеширования.
+    \details Все структуры, входящие в объединение, начинаются с поля `hsize`, содержащего длину
+    хеш-кода в октетах, поэтому значение `sctx.hsize` корректно для любого алгоритма.              */
+/* ----------------------------------------------------------------------------------------------- */
+ typedef union hash_state {
+  /*! \brief Структура алгоритмов семейства Стрибог. */
+   struct streebog sctx;
+  /*! \brief Структура алгоритмов семейства SHA-3. */
+   struct sha3_context sha3;
+ } *ak_hash_state;
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция создания контекста хеширования. */
  typedef int ( ak_function_hash_context_create )( ak_pointer );
@@ -56,6 +69,7 @@ typedef struct sha3_context {
     с использованием класса \ref hash реализованы следующие отечественные алгоритмы хеширования
      - Стрибог256,
      - Стрибог512,
+     - SHA3-256, SHA3-384 и SHA3-512 (FIPS 202),
      - ГОСТ Р 34.11-94 (в настоящее время стандарт выведен из обращения).
 
   Перед началом работы контекст функции хэширования должен быть инициализирован
@@ -70,10 +84,7 @@ typedef struct sha3_context {
   /*! \brief Контекст итерационного сжатия. */
    struct mac mctx;
   /*! \brief Внутренние данные контекста */
-   union {
-   /*! \brief Структура алгоритмов семейства Стрибог. */
-    struct streebog sctx;
-   } data;
+   union hash_state data;
  } *ak_hash;
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -82,15 +93,24 @@ typedef struct sha3_context {
 /*! \brief Инициализация контекста функции бесключевого хеширования ГОСТ Р 34.11-2012 (Стрибог512). */
  int ak_hash_context_create_streebog512( ak_hash );
 
+/*! \brief Инициализация контекста функции бесключевого хеширования SHA3-256. */
+ int ak_hash_context_create_sha3_256( ak_hash );
+/*! \brief Инициализация контекста функции бесключевого хеширования SHA3-384. */
+ int ak_hash_context_create_sha3_384( ak_hash );
+/*! \brief Инициализация контекста функции бесключевого хеширования SHA3-512. */
+ int ak_hash_context_create_sha3_512( ak_hash );
+
 /*! \brief Инициализация контекста функции хеширования SHA3 (Keccak). */
 int ak_hash_context_create_sha3( ak_sha3 ctx, unsigned bitSize);
-
+/*! \brief Очистка контекста функции хеширования SHA3 (Keccak). */
+ int ak_hash_context_clean_sha3( ak_pointer );
 /*! \brief Обновление контекста функции хеширования SHA3 (Keccak). */
-int ak_hash_context_update_sha3( ak_pointer cx, const void* in, size_t len);
+ int ak_hash_context_update_sha3( ak_pointer , const ak_pointer , const size_t );
 /*! \brief Обновление состояния и вычисление результата применения функции хеширования SHA3 (Keccak). */
-int ak_hash_context_finalize_sha3(ak_pointer cx, ak_pointer out);
+ int ak_hash_context_finalize_sha3( ak_pointer ,
+                                     const ak_pointer , const size_t , ak_pointer , const size_t );
 /*! \brief Применение функции хеширования SHA3 (Keccak) для заданной области памяти. */
-int ak_hash_context_ptr_sha3( unsigned bitSize, const void* in, size_t inSize, ak_pointer out, size_t outSize);
+ int ak_hash_context_ptr_sha3( unsigned , const ak_pointer , const size_t , ak_pointer , size_t );
 /*! \brief Тест функции хеширования SHA3-256 (Keccak). */
 bool_t ak_hash_test_sha3_256( void );
 /*! \brief Тест функции хеширования SHA3-384 (Keccak). */
@@ -113,6 +133,10 @@ bool_t ak_hash_test_sha3_512( void );
  size_t ak_hash_context_get_block_size( ak_hash );
 /*! \brief Очистка контекста алгоритма хеширования. */
  int ak_hash_context_clean( ak_hash );
+/*! \brief Создание независимой копии контекста хеширования. */
+ int ak_hash_context_clone( ak_hash , ak_hash );
+/*! \brief Восстановление ранее сохраненного состояния контекста хеширования. */
+ int ak_hash_context_restore( ak_hash , ak_hash );
 /*! \brief Обновление состояния контекста хеширования. */
  int ak_hash_context_update( ak_hash , const ak_pointer , const size_t );
 /*! \brief Обновление состояния и вычисление результата применения алгоритма хеширования. */
@@ -122,6 +146,68 @@ bool_t ak_hash_test_sha3_512( void );
 /*! \brief Хеширование заданного файла. */
  int ak_hash_context_file( ak_hash , const char*, ak_pointer , const size_t );
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальное количество сообщений, одновременно обрабатываемых функцией сжатия Стрибог. */
+ #define ak_hash_streebog_lanes    ( 4 )
+
+/*! \brief Задание на вычисление хеш-кода одного сообщения из набора независимых сообщений. */
+ typedef struct hash_job {
+  /*! \brief Указатель на сообщение. */
+   ak_pointer in;
+  /*! \brief Длина сообщения (в октетах). */
+   size_t size;
+  /*! \brief Область памяти, куда помещается хеш-код. */
+   ak_pointer out;
+  /*! \brief Размер области памяти для хеш-кода (в октетах). */
+   size_t out_size;
+ } *ak_hash_job;
+
+/*! \brief Хеширование набора независимых сообщений. */
+ int ak_hash_context_ptr_multi( ak_hash , ak_hash_job , const size_t );
+/*! \brief Хеширование одного блока с завершением вычислений для нескольких состояний Стрибог. */
+ int ak_hash_context_streebog_block_lanes( ak_streebog * , const ak_uint64 ** ,
+                                                                     ak_uint8 ** , const size_t );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Дескриптор древовидного хеширования (дерева Меркла).
+    \details Данные разбиваются на листья фиксированной длины `leaf_size`; хеш-коды листьев
+    объединяются во внутренние вершины дерева, каждая из которых содержит не более `fanout`
+    потомков. Значения полей дескриптора входят в хеш-коды всех вершин дерева, поэтому
+    дескриптора достаточно для того, чтобы пересчитать произвольное поддерево.                     */
+/* ----------------------------------------------------------------------------------------------- */
+ typedef struct hash_tree {
+  /*! \brief Длина листа (в октетах), кратная длине блока функции хеширования. */
+   ak_uint64 leaf_size;
+  /*! \brief Максимальное количество потомков внутренней вершины дерева. */
+   ak_uint32 fanout;
+  /*! \brief Длина хеш-кода вершины дерева (в октетах). */
+   ak_uint32 tag_size;
+  /*! \brief Длина хешируемых данных (в октетах). */
+   ak_uint64 total_size;
+ } *ak_hash_tree;
+
+/*! \brief Инициализация дескриптора древовидного хеширования. */
+ int ak_hash_tree_create( ak_hash_tree , ak_hash , const ak_uint64 , const ak_uint32 );
+/*! \brief Количество листьев дерева. */
+ ak_uint64 ak_hash_tree_get_leaves_count( ak_hash_tree );
+/*! \brief Количество вершин дерева на заданном уровне. */
+ ak_uint64 ak_hash_tree_get_nodes_count( ak_hash_tree , const ak_uint32 );
+/*! \brief Вычисление хеш-кода листа дерева. */
+ int ak_hash_context_tree_leaf( ak_hash , ak_hash_tree , const ak_uint64 ,
+                                                      const ak_pointer , const size_t , ak_pointer );
+/*! \brief Вычисление хеш-кода внутренней вершины дерева по хеш-кодам ее потомков. */
+ int ak_hash_context_tree_node( ak_hash , ak_hash_tree , const ak_uint32 , const ak_uint64 ,
+                                                      const ak_pointer , const size_t , ak_pointer );
+/*! \brief Древовидное хеширование заданной области памяти. */
+ int ak_hash_context_tree_ptr( ak_hash , ak_hash_tree , const ak_pointer , const size_t ,
+                                                                         ak_pointer , const size_t );
+/*! \brief Древовидное хеширование заданного файла. */
+ int ak_hash_context_tree_file( ak_hash , ak_hash_tree , const char * , ak_pointer , const size_t );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Выбор реализации функции сжатия алгоритма Стрибог. */
+ int ak_hash_context_streebog_init_implementation( void );
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Проверка корректной работы функции хеширования Стрибог-256 */
  bool_t ak_hash_test_streebog256( void );
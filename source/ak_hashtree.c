@@ -0,0 +1,518 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Copyright (c) 2019 by Axel Kenzo, axelkenzo@mail.ru                                            */
+/*                                                                                                 */
+/*  Файл ak_hashtree.c                                                                             */
+/*  - содержит реализацию древовидного хеширования (дерева Меркла) больших объемов данных          */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <ak_hash.h>
+ #include <ak_tools.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef LIBAKRYPT_HAVE_STDLIB_H
+ #include <stdlib.h>
+#else
+ #error Library cannot be compiled without stdlib.h header
+#endif
+#ifdef LIBAKRYPT_HAVE_STRING_H
+ #include <string.h>
+#else
+ #error Library cannot be compiled without string.h header
+#endif
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ #include <pthread.h>
+ #include <unistd.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Длина листа, используемая по-умолчанию (в октетах). */
+ #define ak_hash_tree_default_leaf_size  ( 1048576 )
+/*! \brief Количество потомков внутренней вершины, используемое по-умолчанию. */
+ #define ak_hash_tree_default_fanout     ( 16 )
+/*! \brief Максимальная длина фрагмента файла, считываемого за одно обращение (в октетах). */
+ #define ak_hash_tree_read_size          ( 1048576 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Типы вершин дерева, используемые для разделения областей хеширования. */
+ typedef enum {
+  /*! \brief Лист дерева (хеш-код фрагмента данных). */
+   hash_tree_leaf = 0x00,
+  /*! \brief Внутренняя вершина дерева. */
+   hash_tree_node = 0x01,
+  /*! \brief Корень дерева. */
+   hash_tree_root = 0x02
+ } hash_tree_vertex_t;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция записывает 64-х битное целое в массив октетов (младшие октеты вперед). */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_hash_tree_put_uint64( ak_uint8 *out, ak_uint64 value )
+{
+  int i = 0;
+  for( i = 0; i < 8; i++, value >>= 8 ) out[i] = ( ak_uint8 )( value&0xFF );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция формирует блок, предшествующий данным вершины дерева.
+    \details Блок имеет длину 64 октета и содержит тип вершины, ее уровень и номер, а также
+    значения полей дескриптора. Тем самым хеш-коды листьев, внутренних вершин и корня дерева
+    вычисляются от заведомо различных сообщений.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hash_tree_header( ak_hash_tree tree, hash_tree_vertex_t type,
+                                     const ak_uint32 level, const ak_uint64 index, ak_uint8 *header )
+{
+  memset( header, 0, 64 );
+  header[0] = ( ak_uint8 )type;
+  ak_hash_tree_put_uint64( header +  8, level );
+  ak_hash_tree_put_uint64( header + 16, index );
+  ak_hash_tree_put_uint64( header + 24, tree->leaf_size );
+  ak_hash_tree_put_uint64( header + 32, tree->fanout );
+  ak_hash_tree_put_uint64( header + 40, tree->total_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param tree Дескриптор древовидного хеширования.
+    @param hctx Контекст функции хеширования, используемой для вычисления хеш-кодов вершин.
+    @param leaf_size Длина листа в октетах; должна быть кратна длине блока функции хеширования.
+    Нулевое значение означает длину, используемую по-умолчанию (1 Мб).
+    @param fanout Максимальное количество потомков внутренней вершины (не менее двух).
+    Нулевое значение означает значение, используемое по-умолчанию (16).
+
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_tree_create( ak_hash_tree tree, ak_hash hctx,
+                                                const ak_uint64 leaf_size, const ak_uint32 fanout )
+{
+  size_t bsize = 0;
+
+  if( tree == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to hash tree descriptor" );
+  if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to hash context" );
+  if(( bsize = ak_hash_context_get_block_size( hctx )) == 0 )
+    return ak_error_message( ak_error_wrong_length, __func__, "using hash context with zero block size" );
+
+  tree->leaf_size = leaf_size ? leaf_size : ak_hash_tree_default_leaf_size;
+  if( tree->leaf_size%bsize )
+    return ak_error_message( ak_error_wrong_length, __func__,
+                                "leaf size is not a multiple of the length of hash function block" );
+  tree->fanout = fanout ? fanout : ak_hash_tree_default_fanout;
+  if( tree->fanout < 2 )
+    return ak_error_message( ak_error_wrong_length, __func__, "using fanout less than two" );
+  tree->tag_size = ( ak_uint32 ) ak_hash_context_get_tag_size( hctx );
+  tree->total_size = 0;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Для данных нулевой длины дерево содержит один (пустой) лист.
+
+    @param tree Дескриптор древовидного хеширования.
+    @return Функция возвращает количество листьев дерева.                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_uint64 ak_hash_tree_get_leaves_count( ak_hash_tree tree )
+{
+  if( tree == NULL ) return 0;
+  if( tree->total_size == 0 ) return 1;
+ return ( tree->total_size + tree->leaf_size - 1 )/tree->leaf_size;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Уровень 0 образуют листья дерева; на каждом следующем уровне вершина объединяет
+    не более `fanout` последовательных вершин предыдущего уровня. Корнем дерева является
+    единственная вершина наименьшего уровня, большего нуля, содержащего одну вершину.
+
+    @param tree Дескриптор древовидного хеширования.
+    @param level Уровень дерева.
+    @return Функция возвращает количество вершин на заданном уровне.                               */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_uint64 ak_hash_tree_get_nodes_count( ak_hash_tree tree, const ak_uint32 level )
+{
+  ak_uint32 i = 0;
+  ak_uint64 count = ak_hash_tree_get_leaves_count( tree );
+
+  for( i = 0; i < level; i++ ) count = ( count + tree->fanout - 1 )/tree->fanout;
+ return count;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает уровень корня дерева. */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint32 ak_hash_tree_get_height( ak_hash_tree tree )
+{
+  ak_uint32 level = 1;
+  ak_uint64 count = ak_hash_tree_get_leaves_count( tree );
+
+  while(( count = ( count + tree->fanout - 1 )/tree->fanout ) > 1 ) level++;
+ return level;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param hctx Контекст функции хеширования.
+    @param tree Дескриптор древовидного хеширования; поле `total_size` должно содержать
+    длину всех хешируемых данных.
+    @param index Номер листа (нумерация с нуля).
+    @param in Указатель на данные листа.
+    @param size Длина данных листа; для всех листов, кроме последнего, она должна совпадать
+    со значением `leaf_size`.
+    @param out Область памяти, куда помещается хеш-код листа (не менее `tag_size` октетов).
+
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_tree_leaf( ak_hash hctx, ak_hash_tree tree, const ak_uint64 index,
+                                         const ak_pointer in, const size_t size, ak_pointer out )
+{
+  int error = ak_error_ok;
+  ak_uint8 header[64];
+
+  if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to hash context" );
+  if( tree == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to hash tree descriptor" );
+  if( index >= ak_hash_tree_get_leaves_count( tree ))
+    return ak_error_message( ak_error_wrong_index, __func__, "using wrong index of tree leaf" );
+  if(( ak_uint64 )size != ak_min( tree->leaf_size, tree->total_size - index*tree->leaf_size ))
+    return ak_error_message( ak_error_wrong_length, __func__, "using wrong length of tree leaf" );
+
+  ak_hash_tree_header( tree, hash_tree_leaf, 0, index, header );
+  if(( error = ak_hash_context_clean( hctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect cleaning of hash context" );
+  if(( error = ak_hash_context_update( hctx, header, sizeof( header ))) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect updating of hash context" );
+ return ak_hash_context_finalize( hctx, in, size, out, tree->tag_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Хеш-код вершины вычисляется от блока, содержащего тип, уровень и номер вершины,
+    и следующей за ним последовательности хеш-кодов потомков. Для корня дерева используется
+    отдельный тип вершины.
+
+    @param hctx Контекст функции хеширования.
+    @param tree Дескриптор древовидного хеширования.
+    @param level Уровень вершины (не менее единицы).
+    @param index Номер вершины на уровне (нумерация с нуля).
+    @param children Последовательно расположенные хеш-коды потомков вершины.
+    @param count Количество потомков; должно совпадать с количеством вершин предыдущего уровня,
+    объединяемых данной вершиной.
+    @param out Область памяти, куда помещается хеш-код вершины (не менее `tag_size` октетов).
+    Область может совпадать с областью, содержащей хеш-коды потомков.
+
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_tree_node( ak_hash hctx, ak_hash_tree tree, const ak_uint32 level,
+              const ak_uint64 index, const ak_pointer children, const size_t count, ak_pointer out )
+{
+  int error = ak_error_ok;
+  ak_uint8 header[64];
+  ak_uint64 below = 0;
+  ak_uint32 height = 0;
+
+  if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to hash context" );
+  if( tree == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to hash tree descriptor" );
+  if( children == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to children hashes" );
+  height = ak_hash_tree_get_height( tree );
+  if(( level == 0 ) || ( level > height ) || ( index >= ak_hash_tree_get_nodes_count( tree, level )))
+    return ak_error_message( ak_error_wrong_index, __func__, "using wrong position of tree node" );
+  below = ak_hash_tree_get_nodes_count( tree, level - 1 );
+  if(( ak_uint64 )count != ak_min( tree->fanout, below - index*tree->fanout ))
+    return ak_error_message( ak_error_wrong_length, __func__, "using wrong count of children" );
+
+  ak_hash_tree_header( tree, level == height ? hash_tree_root : hash_tree_node,
+                                                                            level, index, header );
+  if(( error = ak_hash_context_clean( hctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect cleaning of hash context" );
+  if(( error = ak_hash_context_update( hctx, header, sizeof( header ))) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect updating of hash context" );
+ return ak_hash_context_finalize( hctx, children, count*tree->tag_size, out, tree->tag_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет хеш-код корня дерева по хеш-кодам его листьев.
+    \details Хеш-коды вершин каждого следующего уровня записываются на место хеш-кодов
+    предыдущего уровня, поэтому содержимое массива `hashes` изменяется.                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_tree_reduce( ak_hash hctx, ak_hash_tree tree, ak_uint8 *hashes,
+                                                           ak_pointer out, const size_t out_size )
+{
+  ak_uint32 level = 0, height = ak_hash_tree_get_height( tree );
+  ak_uint64 i = 0, count = ak_hash_tree_get_leaves_count( tree );
+  int error = ak_error_ok;
+
+  for( level = 1; level <= height; level++ ) {
+     ak_uint64 upper = ( count + tree->fanout - 1 )/tree->fanout;
+     for( i = 0; i < upper; i++ ) {
+        ak_uint8 node[64];
+        size_t children = ( size_t ) ak_min( tree->fanout, count - i*tree->fanout );
+        if(( error = ak_hash_context_tree_node( hctx, tree, level, i,
+             hashes + i*tree->fanout*tree->tag_size, children, node )) != ak_error_ok )
+          return ak_error_message( error, __func__, "incorrect hashing of tree node" );
+        memcpy( hashes + i*tree->tag_size, node, tree->tag_size );
+     }
+     count = upper;
+  }
+  memcpy( out, hashes, ak_min( out_size, tree->tag_size ));
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание для потока, вычисляющего хеш-коды последовательных листьев дерева. */
+ typedef struct hash_tree_worker {
+  /*! \brief Собственный контекст функции хеширования. */
+   struct hash hctx;
+  /*! \brief Дескриптор дерева. */
+   ak_hash_tree tree;
+  /*! \brief Хешируемые данные (если данные считываются из файла, то NULL). */
+   ak_uint8 *in;
+  /*! \brief Файл с хешируемыми данными. */
+   ak_file file;
+  /*! \brief Массив, куда помещаются хеш-коды листьев. */
+   ak_uint8 *hashes;
+  /*! \brief Номер первого обрабатываемого листа. */
+   ak_uint64 first;
+  /*! \brief Количество обрабатываемых листьев. */
+   ak_uint64 count;
+  /*! \brief Код ошибки, возникшей при работе потока. */
+   int error;
+ } *ak_hash_tree_worker;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет хеш-код листа, данные которого последовательно считываются из файла. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_tree_worker_file_leaf( ak_hash_tree_worker worker, ak_uint8 *buffer,
+                                                           const size_t buffer_size, ak_uint64 index )
+{
+  ssize_t len = 0;
+  ak_uint8 header[64];
+  int error = ak_error_ok;
+  ak_hash_tree tree = worker->tree;
+  ak_int64 offset = ( ak_int64 )( index*tree->leaf_size );
+  ak_uint64 size = ak_min( tree->leaf_size, tree->total_size - index*tree->leaf_size );
+
+  ak_hash_tree_header( tree, hash_tree_leaf, 0, index, header );
+  if(( error = ak_hash_context_clean( &worker->hctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect cleaning of hash context" );
+  if(( error = ak_hash_context_update( &worker->hctx, header, sizeof( header ))) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect updating of hash context" );
+  while( size > 0 ) {
+    if(( len = ak_file_read_offset( worker->file, buffer,
+                                     ( size_t ) ak_min( size, buffer_size ), offset )) <= 0 )
+      return ak_error_message( ak_error_read_data, __func__, "unable to read leaf of hash tree" );
+    if(( error = ak_hash_context_update( &worker->hctx, buffer, ( size_t )len )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect updating of hash context" );
+    offset += len; size -= ( ak_uint64 )len;
+  }
+ return ak_hash_context_finalize( &worker->hctx, NULL, 0,
+                                     worker->hashes + index*tree->tag_size, tree->tag_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока: вычисление хеш-кодов последовательных листьев дерева. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_hash_tree_worker_run( void *ptr )
+{
+  ak_uint64 i = 0;
+  ak_uint8 *buffer = NULL;
+  size_t buffer_size = 0;
+  ak_hash_tree_worker worker = ( ak_hash_tree_worker )ptr;
+  ak_hash_tree tree = worker->tree;
+
+  if( worker->in == NULL ) {
+    buffer_size = ( size_t ) ak_min( tree->leaf_size, ak_hash_tree_read_size );
+    if(( buffer = ak_libakrypt_aligned_malloc( buffer_size )) == NULL ) {
+      worker->error = ak_error_message( ak_error_out_of_memory, __func__,
+                                                        "memory allocation error for read buffer" );
+      return NULL;
+    }
+  }
+
+  for( i = worker->first; i < worker->first + worker->count; i++ ) {
+     if( worker->in == NULL )
+       worker->error = ak_hash_tree_worker_file_leaf( worker, buffer, buffer_size, i );
+      else worker->error = ak_hash_context_tree_leaf( &worker->hctx, tree, i,
+                   worker->in + i*tree->leaf_size,
+                   ( size_t ) ak_min( tree->leaf_size, tree->total_size - i*tree->leaf_size ),
+                                                       worker->hashes + i*tree->tag_size );
+     if( worker->error != ak_error_ok ) break;
+  }
+
+  if( buffer != NULL ) free( buffer );
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция распределяет листья дерева между потоками и вычисляет хеш-код корня.
+    \details Количество потоков определяется опцией `hash_thread_count`; нулевое значение
+    опции означает количество доступных процессоров.                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_tree_compute( ak_hash hctx, ak_hash_tree tree, ak_uint8 *in, ak_file file,
+                                                           ak_pointer out, const size_t out_size )
+{
+  size_t i = 0, started = 0;
+  ak_uint8 *hashes = NULL;
+  ak_hash_tree_worker workers = NULL;
+  int error = ak_error_ok;
+  ak_uint64 offset = 0, leaves = ak_hash_tree_get_leaves_count( tree );
+  ak_int64 threads_count = ak_libakrypt_get_option( "hash_thread_count" );
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_t *threads = NULL;
+#endif
+
+  if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to result buffer" );
+ /* определяем количество потоков */
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  if( threads_count <= 0 ) {
+   #ifdef _SC_NPROCESSORS_ONLN
+    threads_count = ( ak_int64 ) sysconf( _SC_NPROCESSORS_ONLN );
+   #endif
+    if( threads_count <= 0 ) threads_count = 1;
+  }
+#else
+  threads_count = 1;
+#endif
+  threads_count = ( ak_int64 ) ak_min( ( ak_uint64 )threads_count, leaves );
+
+  if(( hashes = malloc(( size_t )( leaves*tree->tag_size ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                                   "memory allocation error for leaves hashes" );
+  if(( workers = calloc(( size_t )threads_count, sizeof( struct hash_tree_worker ))) == NULL ) {
+    error = ak_error_message( ak_error_out_of_memory, __func__, "wrong allocation of workers" );
+    goto lexit;
+  }
+
+ /* каждый поток получает непрерывный диапазон листьев */
+  for( i = 0; i < ( size_t )threads_count; i++, started++ ) {
+     ak_hash_tree_worker worker = workers + i;
+     if(( error = ak_hash_context_create_oid( &worker->hctx, hctx->oid )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect creation of worker hash context" );
+       goto lexit;
+     }
+     worker->tree = tree;
+     worker->in = in;
+     worker->file = file;
+     worker->hashes = hashes;
+     worker->first = offset;
+     worker->count = ( leaves*( i+1 ))/( ak_uint64 )threads_count - offset;
+     offset += worker->count;
+  }
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  if( threads_count > 1 ) {
+    size_t running = 0;
+    if(( threads = calloc(( size_t )threads_count, sizeof( pthread_t ))) == NULL ) {
+      error = ak_error_message( ak_error_out_of_memory, __func__, "wrong allocation of threads" );
+      goto lexit;
+    }
+    for( i = 0; i < ( size_t )threads_count; i++, running++ )
+       if( pthread_create( threads+i, NULL, ak_hash_tree_worker_run, workers+i ) != 0 ) {
+         error = ak_error_message( ak_error_undefined_function, __func__,
+                                                                 "wrong creation of worker thread" );
+         break;
+       }
+    for( i = 0; i < running; i++ ) pthread_join( threads[i], NULL );
+    free( threads );
+    if( error != ak_error_ok ) goto lexit;
+  } else
+#endif
+  ak_hash_tree_worker_run( workers );
+
+  for( i = 0; i < ( size_t )threads_count; i++ )
+     if(( error = workers[i].error ) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect hashing of tree leaves" );
+       goto lexit;
+     }
+ /* объединяем хеш-коды листьев */
+  error = ak_hash_tree_reduce( hctx, tree, hashes, out, out_size );
+
+  lexit:
+   if( workers != NULL ) {
+     for( i = 0; i < started; i++ ) ak_hash_context_destroy( &workers[i].hctx );
+     free( workers );
+   }
+   free( hashes );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Данные разбиваются на листья, хеш-коды которых вычисляются одновременно несколькими
+    потоками (см. опцию `hash_thread_count`), после чего хеш-коды листьев объединяются
+    в дерево. Результатом является хеш-код корня дерева; он отличается от результата функции
+    ak_hash_context_ptr(), вычисленного для тех же данных.
+
+    @param hctx Контекст функции хеширования, определяющий алгоритм хеширования вершин.
+    @param tree Дескриптор, созданный функцией ak_hash_tree_create(); в поле `total_size`
+    помещается длина хешируемых данных.
+    @param in Указатель на хешируемые данные.
+    @param size Длина данных в октетах.
+    @param out Область памяти, куда помещается хеш-код корня дерева.
+    @param out_size Размер области памяти (в октетах), в которую будет помещен результат.
+
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_tree_ptr( ak_hash hctx, ak_hash_tree tree, const ak_pointer in,
+                                         const size_t size, ak_pointer out, const size_t out_size )
+{
+  int error = ak_error_ok;
+
+  if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to hash context" );
+  if( tree == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to hash tree descriptor" );
+  if(( in == NULL ) && ( size != 0 )) return ak_error_message( ak_error_null_pointer, __func__,
+                                                                 "using null pointer to input data" );
+  tree->total_size = size;
+  if(( error = ak_hash_tree_compute( hctx, tree,
+                    size ? ( ak_uint8 *)in : ( ak_uint8 *)"", NULL, out, out_size )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect tree hashing of data" );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция аналогична функции ak_hash_context_tree_ptr(); каждый поток самостоятельно считывает
+    из файла данные своих листьев, не изменяя текущую позицию файла.
+
+    @param hctx Контекст функции хеширования, определяющий алгоритм хеширования вершин.
+    @param tree Дескриптор, созданный функцией ak_hash_tree_create(); в поле `total_size`
+    помещается длина файла.
+    @param filename Имя хешируемого файла.
+    @param out Область памяти, куда помещается хеш-код корня дерева.
+    @param out_size Размер области памяти (в октетах), в которую будет помещен результат.
+
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_context_tree_file( ak_hash hctx, ak_hash_tree tree, const char *filename,
+                                                           ak_pointer out, const size_t out_size )
+{
+  struct file file;
+  int error = ak_error_ok;
+
+  if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to hash context" );
+  if( tree == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to hash tree descriptor" );
+  if( filename == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                                "use a null pointer to filename" );
+  if(( error = ak_file_open_to_read( &file, filename )) != ak_error_ok )
+    return ak_error_message_fmt( error, __func__, "incorrect access to file %s", filename );
+
+  tree->total_size = ( ak_uint64 )file.size;
+  if(( error = ak_hash_tree_compute( hctx, tree,
+                     file.size ? NULL : ( ak_uint8 *)"", &file, out, out_size )) != ak_error_ok )
+    ak_error_message_fmt( error, __func__, "incorrect tree hashing of file %s", filename );
+
+  ak_file_close( &file );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                                  ak_hashtree.c  */
+/* ----------------------------------------------------------------------------------------------- */
@@ -18,9 +18,110 @@
 #else
  #error Library cannot be compiled without string.h header
 #endif
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ #include <pthread.h>
+ #include <unistd.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Смена маски предвычисленных состояний функции хеширования.
+    \param hctx Контекст алгоритма HMAC выработки имитовставки.
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hmac_context_remask_pads( ak_hmac hctx )
+{
+  size_t idx = 0;
+  int error = ak_error_ok;
+  ak_uint8 newmask[ sizeof( union hash_state ) ],
+           *ipad = ( ak_uint8 *) hctx->pads, *opad = ( ak_uint8 *)( hctx->pads+1 );
+
+  if(( error = ak_random_context_random( &hctx->key.generator,
+                                                  newmask, sizeof( newmask ))) != ak_error_ok )
+    return ak_error_message( error, __func__ , "wrong generation a random mask for hmac states" );
+  for( idx = 0; idx < sizeof( newmask ); idx++ ) {
+     ak_uint8 diff = newmask[idx] ^ hctx->pads_mask[idx];
+     ipad[idx] ^= diff;
+     opad[idx] ^= diff;
+     hctx->pads_mask[idx] = newmask[idx];
+  }
+  memset( newmask, 0, sizeof( newmask ));
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Снятие маски с предвычисленного состояния функции хеширования.
+    \param hctx Контекст алгоритма HMAC выработки имитовставки.
+    \param idx Номер состояния: 0 - после обработки блока ipad, 1 - после обработки блока opad.
+    \param state Состояние функции хеширования, в которое помещается результат.                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hmac_context_get_pad( ak_hmac hctx, const int idx, ak_hash_state state )
+{
+  size_t i = 0;
+  ak_uint8 *out = ( ak_uint8 *) state;
+  const ak_uint8 *pad = ( const ak_uint8 *)( hctx->pads + idx );
+
+  for( i = 0; i < sizeof( union hash_state ); i++ ) out[i] = pad[i] ^ hctx->pads_mask[i];
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление состояний функции хеширования после обработки блоков ipad и opad.
+    \details Функция вызывается при каждой установке значения ключа. Далее алгоритм HMAC
+    не использует ключ непосредственно, а восстанавливает вычисленные состояния; тем самым
+    при вычислении каждой имитовставки не выполняется повторное сжатие блоков ipad и opad.
+    \param hctx Контекст алгоритма HMAC выработки имитовставки.
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hmac_context_set_pads( ak_hmac hctx )
+{
+  int pad = 0;
+  int error = ak_error_ok;
+  size_t idx = 0, jdx = 0, len = 0;
+  const ak_uint8 value[2] = { 0x36, 0x5C };
+  ak_uint8 buffer[ ak_mac_context_max_buffer_size ]; /* буффер для хранения промежуточных значений */
+
+  if( hctx->mctx.bsize > sizeof( buffer )) return ak_error_message( ak_error_wrong_length,
+                                            __func__, "using hash function with huge block size" );
+  for( pad = 0; pad < 2; pad++ ) {
+    /* фомируем маскированное значение ключа */
+     len = ak_min( hctx->mctx.bsize, jdx = hctx->key.key_size );
+     for( idx = 0; idx < len; idx++, jdx++ ) {
+        buffer[idx] = hctx->key.key[idx] ^ value[pad];
+        buffer[idx] ^= hctx->key.key[jdx];
+     }
+     for( ; idx < hctx->mctx.bsize; idx++ ) buffer[idx] = value[pad];
+
+    /* вычисляем и сохраняем состояние функции хеширования */
+     if(( error = ak_hash_context_clean( &hctx->ctx )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "wrong cleaning of hash function context" );
+       break;
+     }
+     if(( error = ak_hash_context_update( &hctx->ctx, buffer, hctx->mctx.bsize )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "invalid iteration for hmac key context" );
+       break;
+     }
+     memcpy( hctx->pads+pad, &hctx->ctx.data, sizeof( union hash_state ));
+  }
+  ak_ptr_context_wipe( buffer, sizeof( buffer ), &hctx->key.generator );
+  ak_hash_context_clean( &hctx->ctx );
+  if( error != ak_error_ok ) return error;
+
+ /* накладываем маску на вычисленные состояния */
+  memset( hctx->pads_mask, 0, sizeof( hctx->pads_mask ));
+  if(( error = ak_hmac_context_remask_pads( hctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect masking of hmac states" );
+  hctx->key.set_mask( &hctx->key );
+  hctx->key.flags |= ak_key_flag_hmac_pads_set;
+
+ return ak_error_ok;
+}
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Очистка контекста алгоритма hmac.
+    \details Функция восстанавливает состояние функции хеширования после обработки блока ipad,
+    вычисленное при установке ключа.
     \param ctx Контекст алгоритма HMAC выработки имитовставки.
     \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
     возвращается код ошибки.                                                                       */
@@ -29,8 +130,6 @@
 {
   int error = ak_error_ok;
   ak_hmac hctx = ( ak_hmac ) ctx;
-  size_t idx = 0, jdx = 0, len = 0;
-  ak_uint8 buffer[64]; /* буффер для хранения промежуточных значений */
 
   if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                       "using a null pointer to hmac key context" );
@@ -41,30 +140,22 @@
   if( hctx->key.resource.value.counter <= 1 ) return ak_error_message( ak_error_low_key_resource,
                                             __func__, "using hmac key context with low resource" );
                       /* нам надо два раза использовать ключ => ресурс должен быть не менее двух */
-  if( hctx->mctx.bsize > sizeof( buffer )) return ak_error_message( ak_error_wrong_length,
-                                            __func__, "using hash function with huge block size" );
 
- /* фомируем маскированное значение ключа */
-  len = ak_min( hctx->mctx.bsize, jdx = hctx->key.key_size );
-  for( idx = 0; idx < len; idx++, jdx++ ) {
-     buffer[idx] = hctx->key.key[idx] ^ 0x36;
-     buffer[idx] ^= hctx->key.key[jdx];
-  }
-  for( ; idx < hctx->mctx.bsize; idx++ ) buffer[idx] = 0x36;
+ /* ключ мог быть присвоен в обход функций ak_hmac_context_set_key(), например, при импорте
+    из ключевого контейнера; в этом случае вычисляем состояния ipad и opad сейчас */
+  if( !((hctx->key.flags)&ak_key_flag_hmac_pads_set ))
+    if(( error = ak_hmac_context_set_pads( hctx )) != ak_error_ok )
+      return ak_error_message( error, __func__, "wrong computation of hmac states" );
 
- /* инициализируем начальное состояние контекста хеширования */
+ /* восстанавливаем состояние контекста хеширования после обработки блока ipad */
   if(( error = ak_hash_context_clean( &hctx->ctx )) != ak_error_ok )
     return ak_error_message( error, __func__, "wrong cleaning of hash function context" );
-
- /* обновляем состояние контекста хеширования */
-  if(( error = ak_hash_context_update( &hctx->ctx, buffer, hctx->mctx.bsize )) != ak_error_ok )
-    ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
-
- /* очищаем буффер */
-  ak_ptr_context_wipe( buffer, sizeof( buffer ), &hctx->key.generator );
+  ak_hmac_context_get_pad( hctx, 0, &hctx->ctx.data );
 
  /* перемаскируем ключ и меняем его ресурс */
   hctx->key.set_mask( &hctx->key );
+  if(( error = ak_hmac_context_remask_pads( hctx )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect remasking of hmac states" );
   hctx->key.resource.value.counter--; /* мы использовали ключ один раз */
 
  return error;
@@ -95,6 +186,9 @@
   if( hctx->key.resource.value.counter <= 0 ) return ak_error_message( ak_error_low_key_resource,
                                             __func__, "using hmac key context with low resource" );
 
+/* внутренний буффер функции хеширования здесь всегда пуст, поскольку длины всех
+   обрабатываемых фрагментов кратны длине блока, поэтому передаем данные напрямую */
+  if( hctx->ctx.mctx.length == 0 ) return hctx->ctx.mctx.update( hctx->ctx.mctx.ctx, in, size );
   return ak_hash_context_update( &hctx->ctx, in, size );
 }
 
@@ -113,9 +207,7 @@
 {
   int error = ak_error_ok;
   ak_hmac hctx = ( ak_hmac ) ctx;
-  size_t idx = 0, jdx = 0, len = 0;
-  ak_uint8 temporary[128]; /* первый буффер для хранения промежуточных значений */
-  ak_uint8 keybuffer[128]; /* второй буффер для хранения промежуточных значений */
+  ak_uint8 temporary[128]; /* буффер для хранения промежуточных значений */
 
  /* выполняем проверки */
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
@@ -135,27 +227,15 @@
                                                             sizeof( temporary ))) != ak_error_ok )
     return ak_error_message( error, __func__ , "wrong updating of finalized data" );
 
- /* фомируем маскированное значение ключа */
-  len = ak_min( hctx->mctx.bsize, jdx = hctx->key.key_size );
-  for( idx = 0; idx < len; idx++ , jdx++ ) {
-     keybuffer[idx] = hctx->key.key[idx] ^ 0x5C;
-     keybuffer[idx] ^= hctx->key.key[jdx];
-  }
-  for( ; idx < hctx->mctx.bsize; idx++ ) keybuffer[idx] = 0x5C;
-
- /* возвращаем контекст хеширования в начальное состояние */
+ /* восстанавливаем состояние контекста хеширования после обработки блока opad */
   if(( error = ak_hash_context_clean( &hctx->ctx )) != ak_error_ok )
     return ak_error_message( error, __func__, "wrong cleaning of hash function context" );
-
- /* обновляем состояние контекста хеширования */
-  if(( error = ak_hash_context_update( &hctx->ctx, keybuffer, hctx->mctx.bsize )) != ak_error_ok )
-    return ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
-
- /* очищаем буффер */
-  ak_ptr_context_wipe( keybuffer, sizeof( keybuffer ), &hctx->key.generator );
+  ak_hmac_context_get_pad( hctx, 1, &hctx->ctx.data );
 
  /* ресурс ключа */
   hctx->key.set_mask( &hctx->key );
+  if(( error = ak_hmac_context_remask_pads( hctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect remasking of hmac states" );
   hctx->key.resource.value.counter--; /* мы использовали ключ один раз */
 
  /* последний update/finalize и возврат результата */
@@ -221,6 +301,8 @@
   }
  /* доопределяем oid ключа */
   hctx->key.oid = oid;
+  memset( hctx->pads, 0, sizeof( hctx->pads ));
+  memset( hctx->pads_mask, 0, sizeof( hctx->pads_mask ));
 
  return error;
 }
@@ -241,6 +323,30 @@
  int ak_hmac_context_create_streebog512( ak_hmac hctx )
 { return ak_hmac_context_create_oid( hctx, ak_oid_context_find_by_name( "hmac-streebog512" )); }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param hctx Контекст алгоритма HMAC выработки имитовставки.
+    \return В случае успешного завершения функций возвращает \ref ak_error_ok. В случае
+    возникновения ошибки возвращеется ее код.                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hmac_context_create_sha3_256( ak_hmac hctx )
+{ return ak_hmac_context_create_oid( hctx, ak_oid_context_find_by_name( "hmac-sha3-256" )); }
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param hctx Контекст алгоритма HMAC выработки имитовставки.
+    \return В случае успешного завершения функций возвращает \ref ak_error_ok. В случае
+    возникновения ошибки возвращеется ее код.                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hmac_context_create_sha3_384( ak_hmac hctx )
+{ return ak_hmac_context_create_oid( hctx, ak_oid_context_find_by_name( "hmac-sha3-384" )); }
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param hctx Контекст алгоритма HMAC выработки имитовставки.
+    \return В случае успешного завершения функций возвращает \ref ak_error_ok. В случае
+    возникновения ошибки возвращеется ее код.                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hmac_context_create_sha3_512( ak_hmac hctx )
+{ return ak_hmac_context_create_oid( hctx, ak_oid_context_find_by_name( "hmac-sha3-512" )); }
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \param hctx Контекст алгоритма HMAC выработки имитовставки.
     \return В случае успешного завершения функций возвращает \ref ak_error_ok. В случае
@@ -251,6 +357,8 @@
   int error = ak_error_ok;
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                             "using null pointer to hmac context" );
+  memset( hctx->pads, 0, sizeof( hctx->pads ));
+  memset( hctx->pads_mask, 0, sizeof( hctx->pads_mask ));
   if(( error = ak_hash_context_destroy( &hctx->ctx )) != ak_error_ok )
     ak_error_message( error, __func__, "incorrect destroying of hash context" );
   if(( error = ak_skey_context_destroy( &hctx->key )) != ak_error_ok )
@@ -320,6 +428,9 @@
   if(( error = ak_skey_context_set_resource_values( &hctx->key,
                           key_using_resource, "hmac_key_count_resource", 0, 0 )) != ak_error_ok )
     ak_error_message( error, __func__, "incorrect assigning \"hmac_key_count_resource\" option" );
+ /* вычисляем состояния функции хеширования для блоков ipad и opad */
+  if(( error = ak_hmac_context_set_pads( hctx )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect precomputation of hmac states" );
  return error;
 }
 
@@ -347,6 +458,9 @@
   if(( error = ak_skey_context_set_resource_values( &hctx->key,
                           key_using_resource, "hmac_key_count_resource", 0, 0 )) != ak_error_ok )
     ak_error_message( error, __func__, "incorrect assigning \"hmac_key_count_resource\" option" );
+ /* вычисляем состояния функции хеширования для блоков ipad и opad */
+  if(( error = ak_hmac_context_set_pads( hctx )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect precomputation of hmac states" );
 
  return error;
 }
@@ -384,6 +498,9 @@
   if(( error = ak_skey_context_set_resource_values( &hctx->key,
                           key_using_resource, "hmac_key_count_resource", 0, 0 )) != ak_error_ok )
     ak_error_message( error, __func__, "incorrect assigning \"hmac_key_count_resource\" option" );
+ /* вычисляем состояния функции хеширования для блоков ipad и opad */
+  if(( error = ak_hmac_context_set_pads( hctx )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect precomputation of hmac states" );
 
  return error;
 }
@@ -400,6 +517,55 @@
  return ak_mac_context_clean( &hctx->mctx );
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция переносит в контекст `dst` состояние вычислений контекста `src`: внутреннее состояние
+    функции хеширования (после обработки блока ipad и уже переданных данных) и накопленный неполный
+    блок данных. Секретный ключ не копируется; контекст `dst` должен быть создан для того же
+    алгоритма и содержать тот же ключ, что проверяется по контрольной сумме ключа.
+    После восстановления вычисления могут быть продолжены функциями ak_hmac_context_update() и
+    ak_hmac_context_finalize().
+
+    Восстановление начинает новое вычисление имитовставки на ключе контекста `dst`, поэтому,
+    так же как и при очистке контекста, функция проверяет ресурс ключа, уменьшает его на единицу
+    и перемаскирует ключ.
+
+    \param dst Контекст алгоритма HMAC, состояние которого восстанавливается.
+    \param src Контекст алгоритма HMAC, содержащий сохраненное состояние.
+    \return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hmac_context_restore( ak_hmac dst, ak_hmac src )
+{
+  int error = ak_error_ok;
+  if(( dst == NULL ) || ( src == NULL )) return ak_error_message( ak_error_null_pointer,
+                                                  __func__, "using null pointer to hmac context" );
+  if( dst == src ) return ak_error_ok;
+  if( !((dst->key.flags)&ak_key_flag_set_key ) || !((src->key.flags)&ak_key_flag_set_key ))
+    return ak_error_message( ak_error_key_value, __func__ , "using hmac key with unassigned value" );
+  if(( dst->key.oid != src->key.oid ) || ( dst->key.key_size != src->key.key_size ) ||
+                                                               ( dst->key.icode != src->key.icode ))
+    return ak_error_message( ak_error_key_value, __func__,
+                                                     "using hmac contexts with different keys" );
+  if( dst->key.resource.value.counter <= 1 ) return ak_error_message( ak_error_low_key_resource,
+                                            __func__, "using hmac key context with low resource" );
+ /* состояние opad потребуется при завершении вычислений */
+  if( !((dst->key.flags)&ak_key_flag_hmac_pads_set ))
+    if(( error = ak_hmac_context_set_pads( dst )) != ak_error_ok )
+      return ak_error_message( error, __func__, "wrong computation of hmac states" );
+  if(( error = ak_hash_context_restore( &dst->ctx, &src->ctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect restoring of hash function context" );
+  if(( error = ak_mac_context_restore( &dst->mctx, &src->mctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect restoring of mac context" );
+
+ /* перемаскируем ключ и меняем его ресурс */
+  dst->key.set_mask( &dst->key );
+  if(( error = ak_hmac_context_remask_pads( dst )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect remasking of hmac states" );
+  dst->key.resource.value.counter--; /* мы использовали ключ один раз */
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \param hctx Контекст алгоритма HMAC выработки имитовставки.
     \param in Указатель на входные данные для которых вычисляется хеш-код.
@@ -507,50 +673,31 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! Пароль должен представлять собой ненулевую строку символов в utf8
-    кодировке. Размер вырабатываемого ключевого вектора может колебаться от 32-х до 64-х байт.
-    При выработке используется алгоритм hmac-streebog512.
-
-    @param pass Пароль, строка символов в utf8 кодировке.
-    @param pass_size Размер пароля в байтах, должен быть отличен от нуля.
-    @param salt Строка с инициализационным вектором (произвольная область памяти). Данное значение
-    не является секретным и может храниться или передаваться в открытом виде.
-    @param salt_size Размер инициализионного вектора в байтах.
-    @param cnt Параметр, определяющий количество однотипных итераций для выработки ключа; данный
-    параметр определяет время работы алгоритма; параметр не является секретным и может храниться или
-    передаваться в открытом виде.
-    @param dklen Длина вырабатываемого ключевого вектора в байтах, величина должна принимать
-    значение от 32-х до 64-х.
-    @param out Указатель на массив, куда будет помещен результат; под данный массив должна быть
-    заранее выделена память не менее, чем dklen байт.
-
-    @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
-    возвращается код ошибки.                                                                       */
+/*! \brief Начальный этап выработки ключевого вектора: проверка параметров задания, создание
+    ключа алгоритма hmac-streebog512 и вычисление первой строки U1.
+    \details В случае успеха контекст `hctx` остается созданным, строка U1 помещается в массив
+    `result` (64 октета) и в выходной массив задания. В случае ошибки контекст уничтожается.     */
 /* ----------------------------------------------------------------------------------------------- */
- int ak_hmac_context_pbkdf2_streebog512( const ak_pointer pass,
-         const size_t pass_size, const ak_pointer salt, const size_t salt_size, const size_t cnt,
-                                                               const size_t dklen, ak_pointer out )
+ static int ak_hmac_context_pbkdf2_streebog512_start( ak_hmac hctx, ak_pbkdf2_task task,
+                                                                               ak_uint8 *result )
 {
-  struct hmac hctx;
-  ak_uint8 result[64];
   int error = ak_error_ok;
-  size_t idx = 0, jdx = 0;
 
  /* в начале, многочисленные проверки входных параметров */
-  if( pass == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+  if( task->password == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                                  "using null pointer to password" );
-  if( !pass_size ) return ak_error_message( ak_error_wrong_length, __func__ ,
+  if( !task->password_size ) return ak_error_message( ak_error_wrong_length, __func__ ,
                                                                    "using a zero length password" );
-  if( salt == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+  if( task->salt == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                                      "using null pointer to salt" );
-  if(( dklen < 32 ) || ( dklen > 64 )) return ak_error_message( ak_error_wrong_length,
+  if(( task->dklen < 32 ) || ( task->dklen > 64 )) return ak_error_message( ak_error_wrong_length,
                                        __func__ , "using a wrong length for resulting key vector" );
-  if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+  if( task->out == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                      "using null pointer to resulting key vector" );
  /* создаем контекст алгоритма hmac и определяем его ключ */
-  if(( error = ak_hmac_context_create_streebog512( &hctx )) != ak_error_ok )
+  if(( error = ak_hmac_context_create_streebog512( hctx )) != ak_error_ok )
     return ak_error_message( error, __func__, "wrong creation of hmac-streebog512 key context" );
-  if(( error = ak_hmac_context_set_key( &hctx, pass, pass_size )) != ak_error_ok ) {
+  if(( error = ak_hmac_context_set_key( hctx, task->password, task->password_size )) != ak_error_ok ) {
     ak_error_message( error, __func__, "wrong initialization of hmac-streebog512 secret key" );
     goto lab_exit;
   }
@@ -560,32 +707,265 @@
   result[3] = 1;
 
  /* вычисляем значение первой строки U1  */
-  if(( error = ak_hmac_context_clean( &hctx )) != ak_error_ok ) {
+  if(( error = ak_hmac_context_clean( hctx )) != ak_error_ok ) {
     ak_error_message( error, __func__, "incorrect cleaning of internal hmac context");
     goto lab_exit;
   }
-  if(( error = ak_hmac_context_update( &hctx, salt, salt_size )) != ak_error_ok ) {
+  if(( error = ak_hmac_context_update( hctx, task->salt, task->salt_size )) != ak_error_ok ) {
     ak_error_message( error, __func__, "incorrect updating of internal hmac context");
     goto lab_exit;
   }
-  if(( error = ak_hmac_context_finalize( &hctx, result, 4,
-                                                      result, sizeof( result ))) != ak_error_ok ) {
+  if(( error = ak_hmac_context_finalize( hctx, result, 4, result, 64 )) != ak_error_ok ) {
     ak_error_message( error, __func__, "incorrect finalizing of internal mac context");
     goto lab_exit;
   }
-  memcpy( out, result+64-dklen, dklen );
+  memcpy( task->out, result+64-task->dklen, task->dklen );
 
- /* теперь основной цикл по значению аргумента c */
-  for( idx = 1; idx < cnt; idx++ ) {
-     ak_hmac_context_ptr( &hctx, result, 64, result, sizeof( result ));
-     for( jdx = 0; jdx < dklen; jdx++ ) ((ak_uint8 *)out)[jdx] ^= result[64-dklen+jdx];
+ /* каждая из оставшихся итераций дважды использует ключ */
+  if(( task->count > 1 ) &&
+                 (( ssize_t )( task->count - 1 ) > hctx->key.resource.value.counter/2 )) {
+    ak_error_message( error = ak_error_low_key_resource, __func__,
+                                                      "using hmac key context with low resource" );
+    goto lab_exit;
   }
-  memset( result, 0, 64 );
+ return ak_error_ok;
 
-  lab_exit: ak_hmac_context_destroy( &hctx );
+  lab_exit: ak_hmac_context_destroy( hctx );
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Выработка ключевых векторов для нескольких заданий, итерации которых выполняются
+    одновременно.
+    \details После вычисления первых строк U1 итерации всех заданий выполняются совместно:
+    каждая итерация начинается от предвычисленных состояний ipad и opad и требует хеширования
+    одного блока для внутреннего и одного блока для внешнего преобразования. Эти блоки всех еще
+    не завершенных заданий обрабатываются одним вызовом функции
+    ak_hash_context_streebog_block_lanes(), раунды функции сжатия которой чередуются между
+    заданиями. Результат выполнения каждого задания помещается в его поле `error`.
+
+    Предвычисленные состояния остаются маскированными в контекстах ключей: в каждой итерации
+    маска снимается во временное состояние непосредственно перед его использованием, после чего
+    временное состояние обнуляется, а при выходе из функции - заполняется случайными данными.
+    \note Мы предполагаем, что количество заданий не превышает \ref ak_hash_streebog_lanes.      */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hmac_context_pbkdf2_streebog512_lanes( ak_pbkdf2_task tasks, const size_t lanes )
+{
+  size_t l = 0, idx = 0, jdx = 0, active = 0;
+  struct hmac hctx[ak_hash_streebog_lanes];
+  union hash_state state[ak_hash_streebog_lanes];
+  ak_uint64 result[ak_hash_streebog_lanes][8];
+  ak_streebog si[ak_hash_streebog_lanes];
+  const ak_uint64 *m[ak_hash_streebog_lanes];
+  ak_uint8 *out[ak_hash_streebog_lanes];
+  size_t index[ak_hash_streebog_lanes];
+
+  for( l = 0; l < lanes; l++ )
+     tasks[l].error = ak_hmac_context_pbkdf2_streebog512_start( hctx+l, tasks+l,
+                                                                       ( ak_uint8 *)result[l] );
+
+ /* основной цикл по значению аргумента c; механизм буфферизации класса mac не используется */
+  for( idx = 1; ; idx++ ) {
+     for( l = 0, active = 0; l < lanes; l++ ) {
+        if(( tasks[l].error != ak_error_ok ) || ( idx >= tasks[l].count )) continue;
+        si[active] = &state[l].sctx;
+        m[active] = result[l];
+        out[active] = ( ak_uint8 *)result[l];
+        index[active++] = l;
+     }
+     if( !active ) break;
+     for( l = 0; l < active; l++ ) ak_hmac_context_get_pad( hctx+index[l], 0, state+index[l] );
+     ak_hash_context_streebog_block_lanes( si, m, out, active );
+     for( l = 0; l < active; l++ ) ak_hmac_context_get_pad( hctx+index[l], 1, state+index[l] );
+     ak_hash_context_streebog_block_lanes( si, m, out, active );
+     memset( state, 0, sizeof( state ));
+     for( l = 0; l < active; l++ ) {
+        ak_pbkdf2_task task = tasks + index[l];
+        for( jdx = 0; jdx < task->dklen; jdx++ )
+           (( ak_uint8 *)task->out )[jdx] ^= (( ak_uint8 *)result[index[l]] )[64-task->dklen+jdx];
+     }
+  }
+
+  for( l = 0; l < lanes; l++ ) {
+     if( tasks[l].error != ak_error_ok ) continue;
+     if( tasks[l].count > 1 )
+       hctx[l].key.resource.value.counter -= 2*( ssize_t )( tasks[l].count - 1 );
+     ak_ptr_context_wipe( state+l, sizeof( union hash_state ), &hctx[l].key.generator );
+     ak_hmac_context_destroy( hctx+l );
+  }
+  memset( result, 0, sizeof( result ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Пароль должен представлять собой ненулевую строку символов в utf8
+    кодировке. Размер вырабатываемого ключевого вектора может колебаться от 32-х до 64-х байт.
+    При выработке используется алгоритм hmac-streebog512.
+
+    @param pass Пароль, строка символов в utf8 кодировке.
+    @param pass_size Размер пароля в байтах, должен быть отличен от нуля.
+    @param salt Строка с инициализационным вектором (произвольная область памяти). Данное значение
+    не является секретным и может храниться или передаваться в открытом виде.
+    @param salt_size Размер инициализионного вектора в байтах.
+    @param cnt Параметр, определяющий количество однотипных итераций для выработки ключа; данный
+    параметр определяет время работы алгоритма; параметр не является секретным и может храниться или
+    передаваться в открытом виде.
+    @param dklen Длина вырабатываемого ключевого вектора в байтах, величина должна принимать
+    значение от 32-х до 64-х.
+    @param out Указатель на массив, куда будет помещен результат; под данный массив должна быть
+    заранее выделена память не менее, чем dklen байт.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hmac_context_pbkdf2_streebog512( const ak_pointer pass,
+         const size_t pass_size, const ak_pointer salt, const size_t salt_size, const size_t cnt,
+                                                               const size_t dklen, ak_pointer out )
+{
+  struct pbkdf2_task task;
+
+  task.password = pass;
+  task.password_size = pass_size;
+  task.salt = salt;
+  task.salt_size = salt_size;
+  task.count = cnt;
+  task.dklen = dklen;
+  task.out = out;
+  task.error = ak_error_ok;
+  ak_hmac_context_pbkdf2_streebog512_lanes( &task, 1 );
+
+ return task.error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Общие данные потоков, выполняющих пакетную выработку ключевых векторов. */
+ typedef struct pbkdf2_batch {
+  /*! \brief Массив заданий. */
+   ak_pbkdf2_task tasks;
+  /*! \brief Количество заданий. */
+   size_t count;
+  /*! \brief Номер следующего невыполненного задания. */
+   size_t next;
+  /*! \brief Количество заданий, одновременно выполняемых одним потоком. */
+   size_t lanes;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  /*! \brief Мьютекс, защищающий номер следующего задания. */
+   pthread_mutex_t mutex;
+#endif
+ } *ak_pbkdf2_batch;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока: выполнение еще не распределенных заданий.
+    \details Поток выбирает до `batch->lanes` заданий и выполняет их итерации одновременно
+    (см. ak_hmac_context_pbkdf2_streebog512_lanes()), поэтому потоки, получившие задания
+    с небольшим количеством итераций, продолжают работу с оставшимися заданиями.                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_hmac_context_pbkdf2_batch_run( void *ptr )
+{
+  size_t idx = 0, cnt = 0;
+  ak_pbkdf2_batch batch = ( ak_pbkdf2_batch )ptr;
+
+  for( ;; ) {
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+     pthread_mutex_lock( &batch->mutex );
+#endif
+     idx = batch->next;
+     cnt = ( idx < batch->count ) ? ak_min( batch->lanes, batch->count - idx ) : 0;
+     batch->next += cnt;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+     pthread_mutex_unlock( &batch->mutex );
+#endif
+     if( !cnt ) break;
+     ak_hmac_context_pbkdf2_streebog512_lanes( batch->tasks + idx, cnt );
+  }
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вырабатывает ключевые векторы для набора паролей, инициализационных векторов и
+    количеств итераций; результат каждого задания совпадает с результатом функции
+    ak_hmac_context_pbkdf2_streebog512(). Задания выполняются одновременно несколькими потоками,
+    количество которых определяется опцией `pbkdf2_thread_count`; нулевое значение опции
+    означает количество доступных процессоров. Внутри каждого потока итерации нескольких
+    (до \ref ak_hash_streebog_lanes) заданий выполняются одновременно, при этом раунды функции
+    сжатия Стрибог чередуются между заданиями.
+
+    Результат выполнения каждого задания помещается в поле `error` соответствующей структуры;
+    ошибка в одном из заданий не прерывает выполнение остальных.
+
+    @param tasks Массив заданий.
+    @param count Количество заданий в массиве.
+
+    @return В случае успешного выполнения всех заданий функция возвращает \ref ak_error_ok.
+    В противном случае возвращается код ошибки первого из невыполненных заданий.                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hmac_context_pbkdf2_streebog512_batch( ak_pbkdf2_task tasks, const size_t count )
+{
+  size_t idx = 0;
+  struct pbkdf2_batch batch;
+  ak_int64 threads_count = ak_libakrypt_get_option( "pbkdf2_thread_count" );
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  size_t running = 0;
+  pthread_t *threads = NULL;
+#endif
+
+  if( tasks == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                               "using null pointer to task array" );
+  if( !count ) return ak_error_message( ak_error_zero_length, __func__ ,
+                                                                  "using empty array of tasks" );
+  for( idx = 0; idx < count; idx++ ) tasks[idx].error = ak_error_undefined_value;
+  batch.tasks = tasks;
+  batch.count = count;
+  batch.next = 0;
+
+ /* определяем количество потоков */
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  if( threads_count <= 0 ) {
+   #ifdef _SC_NPROCESSORS_ONLN
+    threads_count = ( ak_int64 ) sysconf( _SC_NPROCESSORS_ONLN );
+   #endif
+    if( threads_count <= 0 ) threads_count = 1;
+  }
+#else
+  threads_count = 1;
+#endif
+  threads_count = ( ak_int64 ) ak_min( ( size_t )threads_count, count );
+ /* каждый поток одновременно выполняет до ak_hash_streebog_lanes заданий, но задания
+    распределяются так, чтобы работу получили все потоки */
+  batch.lanes = ( count + ( size_t )threads_count - 1 )/( size_t )threads_count;
+  batch.lanes = ak_min( batch.lanes, ak_hash_streebog_lanes );
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_init( &batch.mutex, NULL );
+  if( threads_count > 1 ) {
+    if(( threads = calloc(( size_t )threads_count, sizeof( pthread_t ))) == NULL ) {
+      pthread_mutex_destroy( &batch.mutex );
+      return ak_error_message( ak_error_out_of_memory, __func__, "wrong allocation of threads" );
+    }
+    for( idx = 0; idx < ( size_t )threads_count; idx++, running++ )
+       if( pthread_create( threads+idx, NULL, ak_hmac_context_pbkdf2_batch_run, &batch ) != 0 ) {
+         ak_error_message( ak_error_undefined_function, __func__,
+                                                                 "wrong creation of worker thread" );
+         break;
+       }
+   /* задания распределяются динамически, поэтому их выполнят уже созданные потоки;
+      если ни один поток не создан, выполняем задания в текущем потоке */
+    if( !running ) ak_hmac_context_pbkdf2_batch_run( &batch );
+    for( idx = 0; idx < running; idx++ ) pthread_join( threads[idx], NULL );
+    free( threads );
+  } else
+#endif
+  ak_hmac_context_pbkdf2_batch_run( &batch );
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_destroy( &batch.mutex );
+#endif
+
+  for( idx = 0; idx < count; idx++ )
+     if( tasks[idx].error != ak_error_ok )
+       return ak_error_message_fmt( tasks[idx].error, __func__,
+                                          "incorrect key derivation for task %u", (unsigned int) idx );
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                            функции для тестирования алгоритма hmac                              */
 /* ----------------------------------------------------------------------------------------------- */
@@ -38,13 +38,46 @@ extern "C" {
    struct mac mctx;
   /*! \brief Контекст функции хеширования */
    struct hash ctx;
+  /*! \brief Состояния функции хеширования после обработки блоков ipad и opad,
+      вычисляемые при установке ключа и хранящиеся в маскированном виде. */
+   union hash_state pads[2];
+  /*! \brief Маска, наложенная на состояния pads. */
+   ak_uint8 pads_mask[ sizeof( union hash_state ) ];
 } *ak_hmac;
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание на выработку ключевого вектора из пароля для пакетной функции
+    ak_hmac_context_pbkdf2_streebog512_batch(). */
+ typedef struct pbkdf2_task {
+  /*! \brief Пароль, строка символов в utf8 кодировке. */
+   ak_pointer password;
+  /*! \brief Размер пароля в байтах. */
+   size_t password_size;
+  /*! \brief Инициализационный вектор (соль). */
+   ak_pointer salt;
+  /*! \brief Размер инициализационного вектора в байтах. */
+   size_t salt_size;
+  /*! \brief Количество итераций алгоритма. */
+   size_t count;
+  /*! \brief Длина вырабатываемого ключевого вектора в байтах (от 32-х до 64-х). */
+   size_t dklen;
+  /*! \brief Указатель на область памяти, куда помещается результат. */
+   ak_pointer out;
+  /*! \brief Код ошибки, возникшей при выполнении задания. */
+   int error;
+} *ak_pbkdf2_task;
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Создание контекста ключевой функции хеширования HMAC на основе функции Стреебог256. */
  int ak_hmac_context_create_streebog256( ak_hmac );
 /*! \brief Создание контекста ключевой функции хеширования HMAC на основе функции Стреебог512. */
  int ak_hmac_context_create_streebog512( ak_hmac );
+/*! \brief Создание контекста ключевой функции хеширования HMAC на основе функции SHA3-256. */
+ int ak_hmac_context_create_sha3_256( ak_hmac );
+/*! \brief Создание контекста ключевой функции хеширования HMAC на основе функции SHA3-384. */
+ int ak_hmac_context_create_sha3_384( ak_hmac );
+/*! \brief Создание контекста ключевой функции хеширования HMAC на основе функции SHA3-512. */
+ int ak_hmac_context_create_sha3_512( ak_hmac );
 /*! \brief Создание контекста ключевой функции хеширования HMAC c помощью заданного oid. */
  int ak_hmac_context_create_oid( ak_hmac , ak_oid );
 /*! \brief Уничтожение контекста функции хеширования. */
@@ -68,6 +101,8 @@ extern "C" {
 /*! \brief Очистка контекста секретного ключа алгоритма выработки имитовставки HMAC, а также
     проверка ресурса ключа. */
  int ak_hmac_context_clean( ak_hmac );
+/*! \brief Восстановление состояния вычислений из другого контекста с тем же ключом. */
+ int ak_hmac_context_restore( ak_hmac , ak_hmac );
 /*! \brief Обновление текущего состояния контекста алгоритма выработки имитовставки HMAC. */
  int ak_hmac_context_update( ak_hmac , const ak_pointer , const size_t );
 /*! \brief Завершение алгоритма выработки имитовставки HMAC. */
@@ -81,6 +116,8 @@ extern "C" {
 /*! \brief Развертка ключевого вектора из пароля (согласно Р 50.1.111-2016, раздел 4) */
  int ak_hmac_context_pbkdf2_streebog512( const ak_pointer , const size_t ,
                    const ak_pointer , const size_t, const size_t , const size_t , ak_pointer );
+/*! \brief Развертка ключевых векторов для набора паролей несколькими потоками. */
+ int ak_hmac_context_pbkdf2_streebog512_batch( ak_pbkdf2_task , const size_t );
 /*! \brief Тестирование алгоритмов выработки имитовставки HMAC с отечественными
     функциями хеширования семейства Стрибог (ГОСТ Р 34.11-2012). */
  bool_t ak_hmac_test_streebog( void );
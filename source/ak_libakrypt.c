@@ -188,17 +188,17 @@
     return ak_false;
   }
 
-// /* тестируем дополнительные режимы работы */
-//  if( ak_bckey_test_mgm()  != ak_true ) {
-//    ak_error_message( ak_error_get_value(), __func__ ,
-//                                               "incorrect testing of mgm mode for block ciphers" );
-//    return ak_false;
-//  }
-//  if( ak_bckey_test_acpkm()  != ak_true ) {
-//    ak_error_message( ak_error_get_value(), __func__ ,
-//                                  "incorrect testing of acpkm encryption mode for block ciphers" );
-//    return ak_false;
-//  }
+ /* тестируем дополнительные режимы работы */
+  if( ak_bckey_test_mgm()  != ak_true ) {
+    ak_error_message( ak_error_get_value(), __func__ ,
+                                               "incorrect testing of mgm mode for block ciphers" );
+    return ak_false;
+  }
+  if( ak_bckey_test_acpkm()  != ak_true ) {
+    ak_error_message( ak_error_get_value(), __func__ ,
+                                  "incorrect testing of acpkm encryption mode for block ciphers" );
+    return ak_false;
+  }
 
   if( audit >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__ , "testing block ciphers ended successfully" );
@@ -398,6 +398,12 @@
      return ak_false;
    }
 
+ /* выбираем реализацию операций умножения в конечных полях, поддерживаемую процессором */
+  if(( error = ak_gfn_multiplication_init_implementation()) != ak_error_ok ) {
+    ak_error_message( error, __func__, "selection of finite field multiplication is wrong" );
+    return ak_false;
+  }
+
 #ifdef LIBAKRYPT_CRYPTO_FUNCTIONS
  /* инициализируем константные таблицы для алгоритма Кузнечик */
   if(( error = ak_bckey_context_kuznechik_init_gost_tables()) != ak_error_ok ) {
@@ -405,6 +411,18 @@
     return ak_false;
   }
 
+ /* выбираем реализацию алгоритма Кузнечик, определенную при сборке библиотеки */
+  if(( error = ak_bckey_context_kuznechik_init_vector_implementation()) != ak_error_ok ) {
+    ak_error_message( error, __func__, "selection of kuznechik implementation is wrong" );
+    return ak_false;
+  }
+
+ /* выбираем реализацию функции сжатия алгоритма Стрибог */
+  if(( error = ak_hash_context_streebog_init_implementation()) != ak_error_ok ) {
+    ak_error_message( error, __func__, "selection of streebog implementation is wrong" );
+    return ak_false;
+  }
+
  /* инициализируем структуру управления контекстами */
    if(( error = ak_libakrypt_create_context_manager()) != ak_error_ok ) {
      ak_error_message( error, __func__, "initialization of context manager is wrong" );
@@ -18,6 +18,10 @@
 #else
  #error Library cannot be compiled without string.h header
 #endif
+#if defined(LIBAKRYPT_HAVE_SYSMMAN_H) && !defined(LIBAKRYPT_HAVE_WINDOWS_H)
+ #include <sys/mman.h>
+ #define LIBAKRYPT_HAVE_FILE_MAPPING
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
  int ak_mac_context_create( ak_mac mctx, const size_t size, ak_pointer ictx,
@@ -84,7 +88,65 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! @param mctx Указатель на контекст итерационного сжатия.
+/*! Функция копирует в контекст `dst` все поля контекста `src`, включая накопленный во внутреннем
+    буффере неполный блок данных, и устанавливает указатель на внутренний контекст равным `ictx`.
+    Функции создания контекста не вызываются, поэтому контекст `dst` может быть не инициализирован.
+    Копирование внутреннего состояния алгоритма сжатия, на которое указывает `ictx`,
+    выполняется вызывающей стороной (класс-родитель знает размер этого состояния).
+
+    @param dst Указатель на контекст итерационного сжатия, в который производится копирование.
+    @param src Указатель на копируемый контекст итерационного сжатия.
+    @param ictx Указатель на копию внутреннего состояния алгоритма сжатия.
+    @return В случае успеха возвращается \ref ak_error_ok (ноль). В случае возникновения ошибки
+    возвращается ее код.                                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mac_context_clone( ak_mac dst, ak_mac src, ak_pointer ictx )
+{
+  if(( dst == NULL ) || ( src == NULL )) return ak_error_message( ak_error_null_pointer,
+                                                 __func__, "using a null pointer to mac context" );
+  if( ictx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to internal context" );
+  if( dst != src ) memcpy( dst, src, sizeof( struct mac ));
+  dst->ctx = ictx;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция копирует в контекст `dst` неполный блок данных, накопленный во внутреннем буффере
+    контекста `src`. Оба контекста должны быть созданы для одного и того же алгоритма сжатия.
+    Внутреннее состояние алгоритма сжатия копируется классом-родителем.
+
+    @param dst Указатель на контекст итерационного сжатия, состояние которого восстанавливается.
+    @param src Указатель на контекст итерационного сжатия, содержащий сохраненное состояние.
+    @return В случае успеха возвращается \ref ak_error_ok (ноль). В случае возникновения ошибки
+    возвращается ее код.                                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mac_context_restore( ak_mac dst, ak_mac src )
+{
+  if(( dst == NULL ) || ( src == NULL )) return ak_error_message( ak_error_null_pointer,
+                                                 __func__, "using a null pointer to mac context" );
+  if(( dst->bsize != src->bsize ) || ( dst->update != src->update ) ||
+                                                                ( dst->finalize != src->finalize ))
+    return ak_error_message( ak_error_not_equal_data, __func__,
+                                                "using mac contexts of different algorithms" );
+  if( dst == src ) return ak_error_ok;
+  memcpy( dst->data, src->data, sizeof( dst->data ));
+  dst->length = src->length;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Если внутренний буффер пуст, то все полные блоки данных передаются функции сжатия
+    непосредственно из памяти, на которую указывает `in`; во внутренний буффер копируется
+    только оставшаяся неполная часть блока. Данные, длина которых кратна длине блока,
+    передаются функции сжатия за один вызов без каких-либо копирований.
+
+    \note Указатель `in` может иметь произвольное выравнивание. Функции сжатия, вызываемые
+    через поле `update`, обязаны корректно обрабатывать невыровненные данные.
+
+    @param mctx Указатель на контекст итерационного сжатия.
     @param in Сжимаемые данные
     @param size Размер сжимаемых данных в байтах. Данное значение может
     быть произвольным, в том числе равным нулю и/или не кратным длине блока обрабатываемых данных
@@ -93,6 +155,7 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_mac_context_update( ak_mac mctx, const ak_pointer in, const size_t size )
 {
+  int error = ak_error_ok;
   ak_uint8 *ptrin = (ak_uint8 *) in;
   size_t quot = 0, offset = 0, newsize = size;
 
@@ -100,6 +163,10 @@
                                                   "using a null pointer to internal mac context" );
   if( mctx->update == NULL ) return ak_error_message( ak_error_undefined_function, __func__ ,
                                                             "using an undefined update function" );
+ /* быстрый путь: буффер пуст и длина данных кратна длине блока */
+  if(( mctx->length == 0 ) && ( size != 0 ) && ( size%mctx->bsize == 0 ))
+    return mctx->update( mctx->ctx, in, size );
+
  /* в начале проверяем, есть ли данные во временном буфере */
   if( mctx->length != 0 ) {
    /* если новых данных мало, то добавляем во временный буффер и выходим */
@@ -113,8 +180,9 @@
     memcpy( mctx->data + mctx->length, ptrin, offset );
 
    /* обновляем значение контекста функции и очищаем временный буффер */
-    mctx->update( mctx->ctx, mctx->data, mctx->bsize );
+    error = mctx->update( mctx->ctx, mctx->data, mctx->bsize );
     memset( mctx->data, 0, mctx->bsize );
+    if( error != ak_error_ok ) return error;
     mctx->length = 0;
     ptrin += offset;
     newsize -= offset;
@@ -125,7 +193,8 @@
     quot = newsize/mctx->bsize;
     offset = quot*mctx->bsize;
    /* обрабатываем часть, кратную величине bsize */
-    if( quot > 0 ) mctx->update( mctx->ctx, ptrin, offset );
+    if(( quot > 0 ) && (( error = mctx->update( mctx->ctx, ptrin, offset )) != ak_error_ok ))
+      return error;
    /* хвост оставляем на следующий раз */
     if( offset < newsize ) {
       mctx->length = newsize - offset;
@@ -199,10 +268,61 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обработки фрагмента файла, считанного функцией ak_file_process(). */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_mac_context_file_update( ak_pointer mctx, const ak_pointer in, const size_t size )
+{
+ return ak_mac_context_update(( ak_mac )mctx, in, size );
+}
+
+#ifdef LIBAKRYPT_HAVE_FILE_MAPPING
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет результат сжимающего отображения для файла, отображенного в память.
+    \details Содержимое файла передается функции сжатия напрямую из отображенной области,
+    без копирования во внутренние буфферы. Если отобразить файл в память не удалось,
+    то функция возвращает \ref ak_error_undefined_function, и вызывающая функция
+    должна считать данные с помощью ak_file_read().
+
+    \note Уменьшение длины файла другим процессом во время хеширования приводит
+    к получению процессом сигнала SIGBUS. Поэтому отображение используется только в том случае,
+    когда оно явно разрешено ненулевым значением опции `mmap_file_threshold`.                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_mac_context_file_mapped( ak_mac mctx, ak_file file,
+                                                           ak_pointer out, const size_t out_size )
+{
+  int error = ak_error_ok;
+  ak_uint8 *addr = NULL;
+
+  if(( ak_uint64 )file->size != ( ak_uint64 )(( size_t )file->size ))
+    return ak_error_undefined_function; /* файл не помещается в адресное пространство */
+  if(( addr = mmap( NULL, ( size_t )file->size, PROT_READ, MAP_PRIVATE, file->fd, 0 )) == MAP_FAILED ) {
+    if( ak_log_get_level() >= ak_log_maximum )
+      ak_error_message( ak_error_undefined_function, __func__,
+                                                "file mapping failed, using read() instead of it" );
+    return ak_error_undefined_function;
+  }
+ #ifdef MADV_SEQUENTIAL
+  madvise( addr, ( size_t )file->size, MADV_SEQUENTIAL );
+ #endif
+
+  error = ak_mac_context_finalize( mctx, addr, ( size_t )file->size, out, out_size );
+  munmap( addr, ( size_t )file->size );
+ return error;
+}
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция вычисляет результат сжимающего отображения для заданного файла и помещает
     его в область памяти, на которую указывает out.
 
+    Файл считывается фрагментами с помощью функции ak_file_process(), которая совмещает чтение
+    следующих фрагментов с обработкой текущего. Если значение опции `mmap_file_threshold`
+    отлично от нуля, то файлы, длина которых не меньше этого значения, отображаются в память
+    и обрабатываются без промежуточного копирования. Отображение следует разрешать только для
+    файлов, длина которых не может быть уменьшена во время хеширования: в противном случае
+    процесс получит сигнал SIGBUS.
+
     @param mctx Указатель на контекст итерационного сжатия.
     @param filename имя сжимаемого файла
     @param out Область памяти, куда будет помещен результат. Память должна быть заранее выделена.
@@ -215,11 +335,11 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_mac_context_file( ak_mac mctx, const char* filename, ak_pointer out, const size_t out_size )
 {
-  size_t len = 0;
   struct file file;
   int error = ak_error_ok;
-  size_t block_size = 4096; /* оптимальная длина блока для Windows пока не ясна */
-  ak_uint8 *localbuffer = NULL; /* место для локального считывания информации */
+#ifdef LIBAKRYPT_HAVE_FILE_MAPPING
+  ak_int64 threshold = 0;
+#endif
 
  /* выполняем необходимые проверки */
   if( mctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
@@ -238,31 +358,30 @@
     return ak_mac_context_finalize( mctx, "", 0, out, out_size );
   }
 
- /* готовим область для хранения данных */
-  block_size = ak_max( ( size_t )file.blksize, mctx->bsize );
- /* здесь мы выделяем локальный буффер для считывания/обработки данных */
-  if(( localbuffer = ( ak_uint8 * ) ak_libakrypt_aligned_malloc( block_size )) == NULL ) {
-    ak_file_close( &file );
-    return ak_error_message( ak_error_out_of_memory, __func__ ,
-                                                      "memory allocation error for local buffer" );
+#ifdef LIBAKRYPT_HAVE_FILE_MAPPING
+ /* большие файлы отображаются в память и обрабатываются без копирования */
+  threshold = ak_libakrypt_get_option( "mmap_file_threshold" );
+  if(( threshold > 0 ) && ( file.size >= threshold )) {
+    if(( error = ak_mac_context_file_mapped( mctx, &file, out, out_size ))
+                                                               != ak_error_undefined_function ) {
+      ak_mac_context_clean( mctx );
+      ak_file_close( &file );
+      return error;
+    }
+    error = ak_error_ok;
   }
- /* теперь обрабатываем файл с данными */
-  read_label: len = ( size_t ) ak_file_read( &file, localbuffer, block_size );
-  if( len == block_size ) {
-    ak_mac_context_update( mctx, localbuffer, block_size ); /* добавляем считанные данные */
-    goto read_label;
-  } else {
-           size_t qcnt = len / mctx->bsize,
-                  tail = len - qcnt*mctx->bsize;
-           if( qcnt ) ak_mac_context_update( mctx, localbuffer, qcnt*mctx->bsize );
-           error = ak_mac_context_finalize( mctx,
-                                             localbuffer + qcnt*mctx->bsize, tail, out, out_size );
-         }
+#endif
+
+ /* остальные файлы считываются фрагментами; при наличии нескольких буфферов
+    чтение следующих фрагментов выполняется одновременно с обработкой текущего */
+  if(( error = ak_file_process( &file, ak_mac_context_file_update, mctx )) == ak_error_ok )
+    error = ak_mac_context_finalize( mctx, "", 0, out, out_size );
+   else ak_error_message_fmt( error, __func__, "incorrect processing of file %s", filename );
+
  /* очищаем за собой данные, содержащиеся в контексте */
   ak_mac_context_clean( mctx );
  /* закрываем данные */
   ak_file_close( &file );
-  free( localbuffer );
  return error;
 }
 
@@ -24,8 +24,10 @@ extern "C" {
                                      const ak_pointer , const size_t , ak_pointer , const size_t );
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \brief Максимальный размер блока входных данных. */
- #define ak_mac_context_max_buffer_size (64)
+/*! \brief Максимальный размер блока входных данных.
+    \details Значение определяется наибольшей скоростью губки функций хеширования SHA-3
+    (136 октетов для SHA3-256), округленной до кратного 16 октетам.                              */
+ #define ak_mac_context_max_buffer_size (144)
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Контекст алгоритима итерационного сжатия. */
@@ -57,6 +59,10 @@ extern "C" {
  int ak_mac_context_destroy( ak_mac );
 /*! \brief Очистка контекста сжимающего отображения. */
  int ak_mac_context_clean( ak_mac );
+/*! \brief Копирование контекста сжимающего отображения без его повторного создания. */
+ int ak_mac_context_clone( ak_mac , ak_mac , ak_pointer );
+/*! \brief Восстановление накопленных данных контекста сжимающего отображения. */
+ int ak_mac_context_restore( ak_mac , ak_mac );
 /*! \brief Обновление состояния контекста сжимающего отображения. */
  int ak_mac_context_update( ak_mac , const ak_pointer , const size_t );
 /*! \brief Обновление состояния и вычисление результата применения сжимающего отображения. */
@@ -20,6 +20,14 @@
 #else
  #error Library cannot be compiled without string.h header
 #endif
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ #include <pthread.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество случайных траекторий, вырабатываемых за одно обращение к генератору
+    (4 килобайта). */
+ #define ak_magma_trajectory_count     ( 1024 )
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief  Структура для хранения внутренних данных в маскированной реализации Магмы. */
@@ -29,8 +37,64 @@
   /*! \brief  Две маски для двух ключевых последовательностей, соответственно,
       прямой и инвертированной. */
   ak_uint32 inmask[2][8];
+  /*! \brief  Буффер заранее выработанных случайных траекторий. */
+  ak_uint32 trajectory[ak_magma_trajectory_count];
+  /*! \brief  Индекс первой неиспользованной траектории в буффере. */
+  size_t tpos;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  /*! \brief  Мьютекс, защищающий буффер траекторий и генератор ключа. */
+  pthread_mutex_t mutex;
+#endif
 };
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выбирает из буффера `count` очередных значений случайных траекторий.
+
+    Значения траекторий вырабатываются генератором ключа не для каждого блока, а заполнением
+    всего буффера за одно обращение к генератору. Выбор траекторий и заполнение буффера
+    выполняются под защитой мьютекса, поскольку ни буффер, ни генератор ключа не допускают
+    одновременного изменения несколькими потоками. Мьютекс захватывается однократно для всех
+    выбираемых значений, поэтому многоблочные функции резервируют траектории для всех
+    обрабатываемых блоков одним вызовом и далее используют их без блокировки.                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_magma_next_trajectories( ak_skey skey, ak_uint32 *mv, size_t count )
+{
+  struct magma_encrypted_keys *data = ( struct magma_encrypted_keys *)skey->data;
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_lock( &data->mutex );
+#endif
+  while( count-- > 0 ) {
+    if( data->tpos >= ak_magma_trajectory_count ) {
+      skey->generator.random( &skey->generator, data->trajectory, sizeof( data->trajectory ));
+      data->tpos = 0;
+    }
+    *mv++ = data->trajectory[data->tpos++];
+  }
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_unlock( &data->mutex );
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция уничтожает временные данные, вычисленные с использованием ключа,
+    заполняя их случайными значениями.
+
+    Используется генератор ключа, поэтому, как и при выработке траекторий, обращение к нему
+    выполняется под защитой мьютекса.                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_context_wipe( ak_skey skey, ak_pointer ptr, size_t size )
+{
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  struct magma_encrypted_keys *data = ( struct magma_encrypted_keys *)skey->data;
+  pthread_mutex_lock( &data->mutex );
+#endif
+  ak_ptr_context_wipe( ptr, size, &skey->generator );
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_unlock( &data->mutex );
+#endif
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция реализует один такт шифрующего преобразования ГОСТ 34.12-2015 (Mагма).
 
@@ -54,15 +118,13 @@
  static void ak_magma_encrypt_with_random_walk( ak_skey skey, ak_pointer in, ak_pointer out )
 {
   ak_uint8 m[34];
-  ak_uint32 i, mv = 0;
+  ak_uint32 i;
   ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
   ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
   register ak_uint32 n3, n4, p = 0;
 
- /* вырабатываем случайную траекторию */
-  skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 ));
-
- /* формируем вектор раундовых поворотов */
+ /* формируем вектор раундовых поворотов
+    (в данной функции случайная траектория не используется, поэтому и не вырабатывается) */
   m[0] = m[33] = 0;
   for( i = 0; i < 32; i++ ) m[i+1] = 0; // (ak_uint8)(( mv >> i) & 0x01 );
 
@@ -124,19 +186,18 @@
 
     @param skey Контекст секретного ключа.
     @param in Блок входной информации (шифртекст).
-    @param out Блок выходной информации (открытый текст).                                          */
+    @param out Блок выходной информации (открытый текст).
+    @param mv Случайная траектория.                                                                */
 /* ----------------------------------------------------------------------------------------------- */
- static void ak_magma_decrypt_with_random_walk( ak_skey skey, ak_pointer in, ak_pointer out )
+ static inline void ak_magma_decrypt_walk( ak_skey skey, ak_pointer in, ak_pointer out,
+                                                                               const ak_uint32 mv )
 {
   ak_uint8 m[34];
-  ak_uint32 i, mv = 0;
+  ak_uint32 i;
   ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
   ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
   register ak_uint32 n3, n4, p = 0;
 
- /* вырабатываем случайную траекторию */
-  skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 ));
-
  /* формируем вектор раундовых поворотов */
   m[0] = m[33] = 0;
   for( i = 0; i < 32; i++ ) m[i+1] = (ak_uint8)((mv >> i) & 0x01 );
@@ -193,25 +254,36 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования одного блока информации со случайной траекторией,
+    выбираемой из буффера траекторий ключа.                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_decrypt_with_random_walk( ak_skey skey, ak_pointer in, ak_pointer out )
+{
+  ak_uint32 mv = 0;
+
+  ak_magma_next_trajectories( skey, &mv, 1 );
+  ak_magma_decrypt_walk( skey, in, out, mv );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция зашифрования одного блока информации алгоритмом ГОСТ 34.12-2015 (Магма).
     Функция реализует режим совместимости с псевдопреобразованием, реализуемым библиотекой openssl.
 
     @param skey Контекст секретного ключа.
     @param in Блок входной информации (открытый текст).
-    @param out Блок выходной информации (шифртекст).                                               */
+    @param out Блок выходной информации (шифртекст).
+    @param mv Случайная траектория.                                                                */
 /* ----------------------------------------------------------------------------------------------- */
- static void ak_magma_encrypt_with_random_walk_oc( ak_skey skey, ak_pointer in, ak_pointer out )
+ static inline void ak_magma_encrypt_walk_oc( ak_skey skey, ak_pointer in, ak_pointer out,
+                                                                               const ak_uint32 mv )
 {
   ak_uint8 m[34];
-  ak_uint32 i, mv = 0;
+  ak_uint32 i;
   ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
   ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
   register ak_uint32 n3, n4, p = 0;
 
- /* вырабатываем случайную траекторию */
-  skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 ));
-
  /* формируем вектор раундовых поворотов */
   m[0] = m[1] = m[32] = m[33] = 0;
   for( i = 1; i < 31; i++ ) m[i+1] = (ak_uint8)(( mv >> i) & 0x01 );
@@ -268,6 +340,18 @@
  #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования одного блока информации со случайной траекторией,
+    выбираемой из буффера траекторий ключа.                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_encrypt_with_random_walk_oc( ak_skey skey, ak_pointer in, ak_pointer out )
+{
+  ak_uint32 mv = 0;
+
+  ak_magma_next_trajectories( skey, &mv, 1 );
+  ak_magma_encrypt_walk_oc( skey, in, out, mv );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция расшифрования одного блока информации маскированного
     алгоритмом ГОСТ 34.12-2015 (Магма).
@@ -275,19 +359,18 @@
 
     @param skey Контекст секретного ключа.
     @param in Блок входной информации (шифртекст).
-    @param out Блок выходной информации (открытый текст).                                          */
+    @param out Блок выходной информации (открытый текст).
+    @param mv Случайная траектория.                                                                */
 /* ----------------------------------------------------------------------------------------------- */
- static void ak_magma_decrypt_with_random_walk_oc( ak_skey skey, ak_pointer in, ak_pointer out )
+ static inline void ak_magma_decrypt_walk_oc( ak_skey skey, ak_pointer in, ak_pointer out,
+                                                                               const ak_uint32 mv )
 {
   ak_uint8 m[34];
-  ak_uint32 i, mv = 0;
+  ak_uint32 i;
   ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
   ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
   register ak_uint32 n3, n4, p = 0;
 
- /* вырабатываем случайную траекторию */
-  skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 ));
-
  /* формируем вектор раундовых поворотов */
   m[0] = m[1] = m[32] = m[33] = 0;
   for( i = 1; i < 31; i++ ) m[i+1] = (ak_uint8)((mv >> i) & 0x01 );
@@ -344,6 +427,356 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования одного блока информации со случайной траекторией,
+    выбираемой из буффера траекторий ключа.                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_decrypt_with_random_walk_oc( ak_skey skey, ak_pointer in, ak_pointer out )
+{
+  ak_uint32 mv = 0;
+
+  ak_magma_next_trajectories( skey, &mv, 1 );
+  ak_magma_decrypt_walk_oc( skey, in, out, mv );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                    bitslice реализация алгоритма блочного шифрования Магма                      */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Таблицы истинности узлов замены алгоритма Магма.
+    \details Элемент `[s][b]` содержит таблицу истинности `b`-го выходного бита `s`-го узла
+    замены \f$ \pi_s \f$ из ГОСТ Р 34.12-2015: бит с номером `v` равен `b`-му биту
+    значения \f$ \pi_s(v) \f$.                                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static const ak_uint32 magma_bitslice_boxes[8][4] = {
+  { 0xece0, 0x695c, 0x4d27, 0x47d1 },
+  { 0xb958, 0x9a2d, 0xaec1, 0xb2b2 },
+  { 0x26a7, 0x4573, 0x5da4, 0x31e9 },
+  { 0xd958, 0xb5c4, 0x29f1, 0xe453 },
+  { 0x16a7, 0x5c4b, 0xa8c7, 0x9a9a },
+  { 0x2b17, 0x63ac, 0x524f, 0x45d6 },
+  { 0xd568, 0xe516, 0x939a, 0x35a3 },
+  { 0x52ab, 0xce86, 0x2b2e, 0x764c }
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Порядок использования раундовых ключей при зашифровании. */
+ static const ak_uint8 magma_bitslice_encrypt_order[32] = {
+   7, 6, 5, 4, 3, 2, 1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+/*! \brief Порядок использования раундовых ключей при расшифровании. */
+ static const ak_uint8 magma_bitslice_decrypt_order[32] = {
+   7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Временные данные bitslice реализации, вычисляемые с использованием ключа.
+    \details Все значения, зависящие от ключа, размещаются в одной структуре, которая создается
+    однократно при вызове многоблочной функции и уничтожается при выходе из нее. */
+ struct magma_bitslice {
+  /*! \brief Обрабатываемые блоки в bitslice представлении. */
+   ak_uint64 x[64];
+  /*! \brief Сумма половины блока и раундового ключа. */
+   ak_uint64 p[32];
+  /*! \brief Результат применения узлов замены. */
+   ak_uint64 q[32];
+  /*! \brief Поразрядные суммы маскированных раундовых ключей и масок. */
+   ak_uint32 kx[8];
+  /*! \brief Поразрядные произведения маскированных раундовых ключей и масок. */
+   ak_uint32 ka[8];
+};
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Транспонирование битовой матрицы размера 64х64.
+
+    После выполнения функции `j`-й бит слова `a[i]` равен `i`-му биту исходного слова `a[j]`.
+    Функция является инволюцией и используется как для перехода к bitslice представлению,
+    так и для обратного перехода.                                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_magma_bitslice_transpose( ak_uint64 *a )
+{
+  int j, k;
+  ak_uint64 m, t;
+
+  for( j = 32, m = 0x00000000ffffffffLL; j != 0; j >>= 1, m ^= ( m << j )) {
+     for( k = 0; k < 64; k = (( k | j ) + 1 ) & ~j ) {
+        t = (( a[k] >> j ) ^ a[k|j] ) & m;
+        a[k|j] ^= t; a[k] ^= t << j;
+     }
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Сложение по модулю \f$ 2^{32} \f$ 64-х значений, записанных в bitslice представлении,
+    с маскированным раундовым ключом.
+
+    Вычисляется сумма \f$ x + k + m \f$, где \f$ k \f$ - маскированный ключ, а \f$ m \f$ - маска,
+    взятая с противоположным знаком. Сначала три слагаемых сводятся к двум (поразрядная сумма и
+    вектор переносов), затем выполняется одно сложение с последовательным переносом.
+    Значение ключа без маски при этом не вычисляется.
+
+    Биты величин \f$ k \oplus m \f$ и \f$ k \wedge m \f$ разворачиваются в слова непосредственно
+    перед использованием, поэтому развернутые значения ключа в памяти не хранятся.
+
+    @param x Слагаемое (32 слова, по одному слову на каждый бит).
+    @param y Результат сложения.
+    @param kx Значение \f$ k \oplus m \f$.
+    @param ka Значение \f$ k \wedge m \f$.                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_magma_bitslice_add( const ak_uint64 *x, ak_uint64 *y,
+                                                             const ak_uint32 kx, const ak_uint32 ka )
+{
+  int i;
+  ak_uint64 s, t, c, xb, ab, cprev = 0, carry = 0;
+
+  for( i = 0; i < 32; i++ ) {
+     xb = 0 - ( ak_uint64 )(( kx >> i )&1 );
+     ab = 0 - ( ak_uint64 )(( ka >> i )&1 );
+     s = x[i] ^ xb;
+     c = ( x[i] & ( xb | ab )) | ab;
+     t = s ^ cprev;
+     y[i] = t ^ carry;
+     carry = ( s & cprev ) | ( carry & t );
+     cprev = c;
+  }
+}
+
+/*! \brief Функция двух входных битов, заданная таблицей истинности `c` и выраженная
+    через минтермы `m[0]`, ..., `m[3]`; при константном значении `c` лишние слагаемые
+    удаляются компилятором. */
+ #define ak_magma_bitslice_function( c, m ) \
+   ((( (c)&1 ) ? m[0] : 0 ) | (( (c)&2 ) ? m[1] : 0 ) | (( (c)&4 ) ? m[2] : 0 ) | (( (c)&8 ) ? m[3] : 0 ))
+
+/*! \brief Выходной бит узла замены с таблицей истинности `c`: четыре функции от младших входных
+    битов объединяются мультиплексорами, управляемыми двумя старшими входными битами. */
+ #define ak_magma_bitslice_output( c, m, x2, x3 ) do { \
+   ak_uint64 f0 = ak_magma_bitslice_function( (c), m ), \
+             f1 = ak_magma_bitslice_function( (c) >> 4, m ), \
+             f2 = ak_magma_bitslice_function( (c) >> 8, m ), \
+             f3 = ak_magma_bitslice_function( (c) >> 12, m ); \
+   f0 ^= ( f0 ^ f1 )&( x2 ); f2 ^= ( f2 ^ f3 )&( x2 ); \
+   yv = f0 ^ (( f0 ^ f2 )&( x3 )); \
+ } while( 0 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление узла замены с номером `s` для 64-х значений, записанных в bitslice
+    представлении.
+
+    Каждый выходной бит вычисляется по таблице истинности узла замены. Таблицы являются
+    открытыми константами, поэтому последовательность выполняемых операций не зависит
+    от обрабатываемых данных и ключа. Функция оформлена в виде макроса, чтобы значения
+    таблиц были известны на этапе компиляции.                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ #define ak_magma_bitslice_sbox( s, x, y ) do { \
+   ak_uint64 m[4], yv; \
+   m[0] = ~( (x)[0] | (x)[1] ); m[1] = (x)[0] & ~(x)[1]; \
+   m[2] = ~(x)[0] & (x)[1]; m[3] = (x)[0] & (x)[1]; \
+   ak_magma_bitslice_output( magma_bitslice_boxes[s][0], m, (x)[2], (x)[3] ); (y)[0] = yv; \
+   ak_magma_bitslice_output( magma_bitslice_boxes[s][1], m, (x)[2], (x)[3] ); (y)[1] = yv; \
+   ak_magma_bitslice_output( magma_bitslice_boxes[s][2], m, (x)[2], (x)[3] ); (y)[2] = yv; \
+   ak_magma_bitslice_output( magma_bitslice_boxes[s][3], m, (x)[2], (x)[3] ); (y)[3] = yv; \
+ } while( 0 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Один такт сети Фейстеля для 64-х блоков, записанных в bitslice представлении.
+
+    Ключ добавляется в маскированном виде: сначала прибавляется маскированный ключ, затем
+    вычитается маска, так что истинное значение раундового ключа в явном виде не вычисляется.
+
+    Промежуточные значения помещаются в структуру `bs` и уничтожаются вызывающей функцией.
+
+    @param bs Временные данные bitslice реализации.
+    @param a Половина блока, подаваемая на вход раундовой функции.
+    @param b Половина блока, к которой прибавляется результат раундовой функции.
+    @param k Номер раундового ключа.                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_magma_bitslice_round( struct magma_bitslice *bs, const ak_uint64 *a,
+                                                                    ak_uint64 *b, const int k )
+{
+  int i;
+  ak_uint64 *p = bs->p, *q = bs->q;
+
+  ak_magma_bitslice_add( a, p, bs->kx[k], bs->ka[k] );
+  ak_magma_bitslice_sbox( 0, p, q );
+  ak_magma_bitslice_sbox( 1, p+4, q+4 );
+  ak_magma_bitslice_sbox( 2, p+8, q+8 );
+  ak_magma_bitslice_sbox( 3, p+12, q+12 );
+  ak_magma_bitslice_sbox( 4, p+16, q+16 );
+  ak_magma_bitslice_sbox( 5, p+20, q+20 );
+  ak_magma_bitslice_sbox( 6, p+24, q+24 );
+  ak_magma_bitslice_sbox( 7, p+28, q+28 );
+ /* циклический сдвиг на 11 разрядов влево сводится к перенумерации слов */
+  for( i = 0; i < 32; i++ ) b[(i+11)&31] ^= q[i];
+}
+
+ #undef ak_magma_bitslice_sbox
+ #undef ak_magma_bitslice_output
+ #undef ak_magma_bitslice_function
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования/расшифрования 64-х блоков в bitslice представлении.
+
+    @param bs Временные данные bitslice реализации с вычисленными значениями `kx` и `ka`.
+    @param in Указатель на 64 последовательно расположенных блока входных данных.
+    @param out Указатель на область памяти, куда помещаются 64 блока результата.
+    @param order Порядок использования раундовых ключей.
+    @param oc Флаг совместимости с библиотекой openssl.                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_bitslice_blocks( struct magma_bitslice *bs, ak_pointer in, ak_pointer out,
+                                                          const ak_uint8 *order, const int oc )
+{
+  int i;
+  ak_uint64 *x = bs->x;
+  ak_uint32 n3, n4, *inptr = ( ak_uint32 *)in, *outptr = ( ak_uint32 *)out;
+
+ /* считываем данные: младшая половина слова содержит n3, старшая - n4 */
+  for( i = 0; i < 64; i++ ) {
+   #ifdef LIBAKRYPT_LITTLE_ENDIAN
+    if( oc ) { n4 = bswap_32( inptr[2*i] ); n3 = bswap_32( inptr[2*i+1] ); }
+      else { n3 = inptr[2*i]; n4 = inptr[2*i+1]; }
+   #else
+    if( oc ) { n4 = inptr[2*i]; n3 = inptr[2*i+1]; }
+      else { n3 = bswap_32( inptr[2*i] ); n4 = bswap_32( inptr[2*i+1] ); }
+   #endif
+    x[i] = (( ak_uint64 )n4 << 32 ) | n3;
+  }
+  ak_magma_bitslice_transpose( x );
+
+ /* 32 такта сети Фейстеля: x[0..31] содержит n3, x[32..63] содержит n4 */
+  for( i = 0; i < 32; i += 2 ) {
+     ak_magma_bitslice_round( bs, x, x+32, order[i] );
+     ak_magma_bitslice_round( bs, x+32, x, order[i+1] );
+  }
+
+ /* возвращаемся к обычному представлению и записываем результат */
+  ak_magma_bitslice_transpose( x );
+  for( i = 0; i < 64; i++ ) {
+     n3 = ( ak_uint32 )x[i]; n4 = ( ak_uint32 )( x[i] >> 32 );
+   #ifdef LIBAKRYPT_LITTLE_ENDIAN
+    if( oc ) { outptr[2*i+1] = bswap_32( n4 ); outptr[2*i] = bswap_32( n3 ); }
+      else { outptr[2*i] = n4; outptr[2*i+1] = n3; }
+   #else
+    if( oc ) { outptr[2*i+1] = n4; outptr[2*i] = n3; }
+      else { outptr[2*i] = bswap_32( n4 ); outptr[2*i+1] = bswap_32( n3 ); }
+   #endif
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает в bitslice представлении все полные группы из 64-х блоков.
+
+    Значения `kx` и `ka` вычисляются однократно для всех групп. В отличие от функций, реализующих
+    случайное блуждание, bitslice реализация использует только первый экземпляр маскированных
+    раундовых ключей (`inkey[0]` и `inmask[0]`): выбор экземпляра по случайной траектории
+    зависел бы от данных каждого блока и не может быть выполнен одновременно для 64-х блоков.
+    Временные данные уничтожаются однократно, при выходе из функции.
+
+    @return Количество обработанных блоков (кратное 64).                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static size_t ak_magma_bitslice_groups( ak_skey skey, ak_uint64 *in, ak_uint64 *out,
+                                            const size_t blocks, const ak_uint8 *order, const int oc )
+{
+  int k;
+  size_t done = 0;
+  ak_uint32 n3, n4;
+  struct magma_bitslice bs;
+  ak_uint32 *kp = ((struct magma_encrypted_keys *)skey->data)->inkey[0];
+  ak_uint32 *mp = ((struct magma_encrypted_keys *)skey->data)->inmask[0];
+
+  if( blocks < 64 ) return 0;
+
+ /* вычисляем поразрядные функции маскированных ключей и масок */
+  for( k = 0; k < 8; k++ ) {
+     n3 = kp[k]; n4 = ( ak_uint32 )( 0 - mp[k] );
+     bs.kx[k] = n3 ^ n4; bs.ka[k] = n3 & n4;
+  }
+  for( ; done + 64 <= blocks; done += 64 )
+     ak_magma_bitslice_blocks( &bs, in+done, out+done, order, oc );
+
+ /* уничтожаем развернутые ключи и промежуточные значения */
+  ak_magma_context_wipe( skey, &bs, sizeof( bs ));
+ return done;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает несколько последовательно расположенных блоков информации
+    алгоритмом Магма.
+
+    Блоки обрабатываются группами по 64 блока с использованием bitslice реализации, время работы
+    которой не зависит от обрабатываемых данных и значения ключа. Оставшиеся блоки
+    зашифровываются по одному.                                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_encrypt_blocks_bitslice( ak_skey skey, ak_pointer in,
+                                                                   ak_pointer out, size_t blocks )
+{
+  size_t done = 0;
+  ak_uint64 *inptr = ( ak_uint64 *)in, *outptr = ( ak_uint64 *)out;
+
+  done = ak_magma_bitslice_groups( skey, inptr, outptr, blocks,
+                                                                magma_bitslice_encrypt_order, 0 );
+  inptr += done; outptr += done; blocks -= done;
+  for( ; blocks > 0; blocks--, inptr++, outptr++ )
+     ak_magma_encrypt_with_random_walk( skey, inptr, outptr );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифровывает несколько последовательно расположенных блоков информации
+    алгоритмом Магма с использованием bitslice реализации.                                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_decrypt_blocks_bitslice( ak_skey skey, ak_pointer in,
+                                                                   ak_pointer out, size_t blocks )
+{
+  size_t i = 0, done = 0;
+  ak_uint32 mv[64];
+  ak_uint64 *inptr = ( ak_uint64 *)in, *outptr = ( ak_uint64 *)out;
+
+  done = ak_magma_bitslice_groups( skey, inptr, outptr, blocks,
+                                                                magma_bitslice_decrypt_order, 0 );
+  inptr += done; outptr += done; blocks -= done;
+  if( blocks == 0 ) return;
+  ak_magma_next_trajectories( skey, mv, blocks );
+  for( i = 0; i < blocks; i++ ) ak_magma_decrypt_walk( skey, inptr+i, outptr+i, mv[i] );
+  memset( mv, 0, sizeof( mv ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает несколько последовательно расположенных блоков информации
+    алгоритмом Магма в варианте, совместимом с библиотекой openssl.                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_encrypt_blocks_bitslice_oc( ak_skey skey, ak_pointer in,
+                                                                   ak_pointer out, size_t blocks )
+{
+  size_t i = 0, done = 0;
+  ak_uint32 mv[64];
+  ak_uint64 *inptr = ( ak_uint64 *)in, *outptr = ( ak_uint64 *)out;
+
+  done = ak_magma_bitslice_groups( skey, inptr, outptr, blocks,
+                                                                magma_bitslice_encrypt_order, 1 );
+  inptr += done; outptr += done; blocks -= done;
+  if( blocks == 0 ) return;
+  ak_magma_next_trajectories( skey, mv, blocks );
+  for( i = 0; i < blocks; i++ ) ak_magma_encrypt_walk_oc( skey, inptr+i, outptr+i, mv[i] );
+  memset( mv, 0, sizeof( mv ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифровывает несколько последовательно расположенных блоков информации
+    алгоритмом Магма в варианте, совместимом с библиотекой openssl.                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_decrypt_blocks_bitslice_oc( ak_skey skey, ak_pointer in,
+                                                                   ak_pointer out, size_t blocks )
+{
+  size_t i = 0, done = 0;
+  ak_uint32 mv[64];
+  ak_uint64 *inptr = ( ak_uint64 *)in, *outptr = ( ak_uint64 *)out;
+
+  done = ak_magma_bitslice_groups( skey, inptr, outptr, blocks,
+                                                                magma_bitslice_decrypt_order, 1 );
+  inptr += done; outptr += done; blocks -= done;
+  if( blocks == 0 ) return;
+  ak_magma_next_trajectories( skey, mv, blocks );
+  for( i = 0; i < blocks; i++ ) ak_magma_decrypt_walk_oc( skey, inptr+i, outptr+i, mv[i] );
+  memset( mv, 0, sizeof( mv ));
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция уничтожения развернутых ключей для маскированной магмы
 
@@ -361,6 +794,9 @@
                                                             "using a null pointer to secret key" );
  /* если ключ был создан, но ему не было присвоено значение, здесь возникнет ошибка */
   if( skey->data != NULL ) {
+   #ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_destroy( &(( struct magma_encrypted_keys *)skey->data)->mutex );
+   #endif
     ak_ptr_context_wipe( skey->data, sizeof( struct magma_encrypted_keys ), &skey->generator );
     free( skey->data );
     skey->data = NULL;
@@ -394,6 +830,10 @@
 
  /* выставляем флаги того, что память выделена */
   memset( data, 0, sizeof( struct magma_encrypted_keys ));
+  data->tpos = ak_magma_trajectory_count; /* буффер траекторий заполняется при первом обращении */
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_init( &data->mutex, NULL );
+#endif
   skey->data = ( ak_pointer )data;
   skey->flags |= ak_key_flag_data_not_free;
 
@@ -651,10 +1091,14 @@ int ak_bckey_context_create_magma( ak_bckey bkey )
   if( oc ) {
     bkey->encrypt = ak_magma_encrypt_with_random_walk_oc;
     bkey->decrypt = ak_magma_decrypt_with_random_walk_oc;
+    bkey->encrypt_blocks = ak_magma_encrypt_blocks_bitslice_oc;
+    bkey->decrypt_blocks = ak_magma_decrypt_blocks_bitslice_oc;
   }
    else {
     bkey->encrypt = ak_magma_encrypt_with_random_walk;
     bkey->decrypt = ak_magma_decrypt_with_random_walk;
+    bkey->encrypt_blocks = ak_magma_encrypt_blocks_bitslice;
+    bkey->decrypt_blocks = ak_magma_decrypt_blocks_bitslice;
   }
   return error;
 }
@@ -762,7 +1206,7 @@ int ak_bckey_context_create_magma( ak_bckey bkey )
 
   struct bckey mkey;
   size_t i = 0, j = 0;
-  ak_uint8 myout[256];
+  ak_uint8 myout[552], mydata[552];
   bool_t result = ak_true;
   int error = ak_error_ok, audit = ak_log_get_level(),
       oc = (int) ak_libakrypt_get_option( "openssl_compability" );
@@ -900,6 +1344,38 @@ int ak_bckey_context_create_magma( ak_bckey bkey )
   if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
                 "the cbc mode encryption/decryption test from GOST R 34.13-2015 is Ok" );
 
+ /* 5. Проверяем совпадение bitslice и поблочной реализаций алгоритма
+       на количестве блоков, не кратном размеру обрабатываемой группы */
+  for( i = 0; i < sizeof( mydata ); i++ ) mydata[i] = ( ak_uint8 )( magma_in[i&0x1f] + i );
+  if(( error = ak_bckey_context_encrypt_ecb( &mkey, mydata,
+                                                       myout, sizeof( mydata ))) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "wrong multiblock ecb mode encryption" );
+    result = ak_false;
+    goto exit;
+  }
+  for( i = 0; i < sizeof( mydata ); i += 8 ) mkey.encrypt( &mkey.key, mydata+i, mydata+i );
+  if( !ak_ptr_is_equal_with_log( myout, mydata, sizeof( mydata ))) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                                     "the bitslice encryption differs from one block encryption" );
+    result = ak_false;
+    goto exit;
+  }
+  if(( error = ak_bckey_context_decrypt_ecb( &mkey, mydata,
+                                                       mydata, sizeof( mydata ))) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "wrong multiblock ecb mode decryption" );
+    result = ak_false;
+    goto exit;
+  }
+  for( i = 0; i < sizeof( mydata ); i += 8 ) mkey.decrypt( &mkey.key, myout+i, myout+i );
+  if( !ak_ptr_is_equal_with_log( myout, mydata, sizeof( mydata ))) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                                     "the bitslice decryption differs from one block decryption" );
+    result = ak_false;
+    goto exit;
+  }
+  if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
+                                            "the bitslice encryption/decryption test is Ok" );
+
 
  /* 10. Тестируем режим выработки имитовставки (плоская реализация). */
   if(( error = ak_bckey_context_cmac( &mkey, oc ? openssl_magma_in : magma_in,
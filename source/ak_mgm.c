@@ -0,0 +1,877 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Copyright (c) 2014 - 2019 by Axel Kenzo, axelkenzo@mail.ru                                     */
+/*                                                                                                 */
+/*  Файл ak_mgm.c                                                                                  */
+/*  - содержит реализацию режима аутентифицированного шифрования MGM                               */
+/*    из рекомендаций по стандартизации Р 1323565.1.026-2019.                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <ak_gf2n.h>
+ #include <ak_tools.h>
+ #include <ak_bckey.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef LIBAKRYPT_HAVE_STRING_H
+ #include <string.h>
+#else
+ #error Library cannot be compiled without string.h header
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Контекст инициализирован значением синхропосылки. */
+ #define ak_mgm_flag_clean          (0x01)
+/*! \brief Обработан неполный блок ассоциированных данных. */
+ #define ak_mgm_flag_adata_tail     (0x02)
+/*! \brief Начата обработка шифруемых данных. */
+ #define ak_mgm_flag_data           (0x04)
+/*! \brief Обработан неполный блок шифруемых данных. */
+ #define ak_mgm_flag_data_tail      (0x08)
+
+/*! \brief Размер (в 64-х битных словах) буффера для одновременной обработки нескольких блоков.
+    \details Буффер вмещает 32 блока алгоритма Кузнечик или 64 блока алгоритма Магма. */
+ #define ak_mgm_buffer_words        (64)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Увеличение на единицу значения, хранящегося в порядке байт little endian. */
+#ifdef LIBAKRYPT_LITTLE_ENDIAN
+ #define ak_mgm_next64( x ) ( (x) + 1 )
+#else
+ #define ak_mgm_next64( x ) bswap_64( bswap_64( x ) + 1 )
+#endif
+
+/*! \brief Увеличение на единицу младшей половины 64-х битного значения (по модулю 2^32). */
+ #define ak_mgm_next_low32( x ) ((( x )&0xffffffff00000000LL ) | ((( x ) + 1 )&0xffffffffLL ))
+/*! \brief Увеличение на единицу старшей половины 64-х битного значения (по модулю 2^32). */
+ #define ak_mgm_next_high32( x ) (( x ) + 0x100000000LL )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Изменение порядка следования байт в одном блоке. */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mgm_reverse( ak_uint64 *out, const ak_uint64 *in, const size_t bsize )
+{
+  ak_uint64 t;
+
+  if( bsize == 16 ) {
+    t = bswap_64( in[0] );
+    out[0] = bswap_64( in[1] );
+    out[1] = t;
+  } else out[0] = bswap_64( in[0] );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция помещает в буффер последовательные значения счетчиков режима.
+
+    Сначала в буффер помещаются `yblocks` значений счетчика, используемого для выработки гаммы
+    (у счетчика увеличивается младшая половина), затем `zblocks` значений счетчика, используемого
+    для выработки множителей (у счетчика увеличивается старшая половина). Значения записываются
+    в том порядке байт, который ожидает функция зашифрования блока.                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_mgm_context_counters( ak_mgm_ctx ctx, ak_uint64 *buffer,
+                                             const size_t yblocks, const size_t zblocks, int oc )
+{
+  size_t i, w = ctx->bsize >> 3;
+
+  for( i = 0; i < yblocks; i++, buffer += w ) {
+     if( oc ) ak_mgm_reverse( buffer, ctx->ycount, ctx->bsize );
+       else memcpy( buffer, ctx->ycount, ctx->bsize );
+     if( w == 2 ) ctx->ycount[0] = ak_mgm_next64( ctx->ycount[0] );
+      else {
+      #ifdef LIBAKRYPT_LITTLE_ENDIAN
+       ctx->ycount[0] = ak_mgm_next_low32( ctx->ycount[0] );
+      #else
+       ctx->ycount[0] = bswap_64( ak_mgm_next_low32( bswap_64( ctx->ycount[0] )));
+      #endif
+      }
+  }
+  for( i = 0; i < zblocks; i++, buffer += w ) {
+     if( oc ) ak_mgm_reverse( buffer, ctx->zcount, ctx->bsize );
+       else memcpy( buffer, ctx->zcount, ctx->bsize );
+     if( w == 2 ) ctx->zcount[1] = ak_mgm_next64( ctx->zcount[1] );
+      else {
+      #ifdef LIBAKRYPT_LITTLE_ENDIAN
+       ctx->zcount[0] = ak_mgm_next_high32( ctx->zcount[0] );
+      #else
+       ctx->zcount[0] = bswap_64( ak_mgm_next_high32( bswap_64( ctx->zcount[0] )));
+      #endif
+      }
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция добавляет к накапливаемой сумме сумму попарных произведений `blocks`
+    множителей и `blocks` блоков данных; приведение по модулю выполняется один раз.               */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mgm_context_multiply( ak_mgm_ctx ctx, ak_uint64 *h,
+                                                           ak_pointer data, const size_t blocks )
+{
+  ak_uint64 t[2];
+
+  if( ctx->bsize == 16 ) {
+    ak_gf128_mul_sum( t, h, data, blocks );
+    ctx->sum[0] ^= t[0]; ctx->sum[1] ^= t[1];
+  } else {
+    ak_gf64_mul_sum( t, h, data, blocks );
+    ctx->sum[0] ^= t[0];
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет, что ключ может быть использован для обработки заданного
+    количества блоков, и уменьшает ресурс ключа.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_mgm_context_check_key( ak_mgm_ctx ctx, ak_bckey bkey, const ak_int64 blocks )
+{
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to mgm context" );
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to block cipher key" );
+  if( !( ctx->flags&ak_mgm_flag_clean ))
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__,
+                                                            "using non initialized mgm context" );
+  if( bkey->bsize != ctx->bsize )
+    return ak_error_message( ak_error_wrong_block_cipher, __func__,
+                                  "block size of secret key differs from mgm context block size" );
+ /* проверяем целостность ключа */
+  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                                   "incorrect integrity code of secret key value" );
+ /* уменьшаем значение ресурса ключа */
+  if( bkey->key.resource.value.counter < blocks )
+    return ak_error_message( ak_error_low_key_resource, __func__ ,
+                                                              "low resource of block cipher key" );
+   else bkey->key.resource.value.counter -= blocks;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вырабатывает начальные значения счетчиков режима MGM:
+    \f$ Y_1 = e_K(0||ICN) \f$ и \f$ Z_1 = e_K(1||ICN) \f$, где \f$ ICN \f$ - синхропосылка,
+    длина которой на один бит меньше длины блока. Старший бит переданного значения `iv`
+    игнорируется. Накапливаемая сумма и длины обработанных данных обнуляются.
+
+    @param ctx Контекст режима MGM.
+    @param bkey Ключ алгоритма блочного шифрования (Магма или Кузнечик).
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в байтах; должна быть не меньше длины блока.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mgm_context_clean( ak_mgm_ctx ctx, ak_bckey bkey, const ak_pointer iv, const size_t iv_size )
+{
+  ak_uint64 icn[2], block[2];
+  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option( "openssl_compability" );
+
+  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to mgm context" );
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to block cipher key" );
+  if( iv == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using null pointer to initial vector" );
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
+                                          __func__ , "incorrect block size of block cipher key" );
+  if( iv_size < bkey->bsize )
+    return ak_error_message( ak_error_wrong_iv_length, __func__,
+                                                              "incorrect length of initial value" );
+
+  memset( ctx, 0, sizeof( struct mgm_ctx ));
+  ctx->bsize = bkey->bsize;
+  ctx->flags = ak_mgm_flag_clean;
+  if(( error = ak_mgm_context_check_key( ctx, bkey, 2 )) != ak_error_ok ) {
+    ctx->flags = 0;
+    return ak_error_message( error, __func__, "wrong secret key for mgm mode" );
+  }
+
+ /* синхропосылка хранится в порядке байт little endian */
+  memset( icn, 0, sizeof( icn ));
+  memcpy( icn, iv, ctx->bsize );
+  if( oc ) ak_mgm_reverse( icn, icn, ctx->bsize );
+
+ /* вырабатываем значение Y_1 */
+  ((ak_uint8 *)icn)[ctx->bsize-1] &= 0x7f;
+  if( oc ) {
+    ak_mgm_reverse( block, icn, ctx->bsize );
+    bkey->encrypt( &bkey->key, block, block );
+    ak_mgm_reverse( ctx->ycount, block, ctx->bsize );
+  } else bkey->encrypt( &bkey->key, icn, ctx->ycount );
+
+ /* вырабатываем значение Z_1 */
+  ((ak_uint8 *)icn)[ctx->bsize-1] ^= 0x80;
+  if( oc ) {
+    ak_mgm_reverse( block, icn, ctx->bsize );
+    bkey->encrypt( &bkey->key, block, block );
+    ak_mgm_reverse( ctx->zcount, block, ctx->bsize );
+  } else bkey->encrypt( &bkey->key, icn, ctx->zcount );
+
+ /* перемаскируем ключ */
+  if(( error = ak_skey_context_remask( &bkey->key, 2 )) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of secret key" );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция добавляет к имитовставке фрагмент ассоциированных (незашифровываемых) данных.
+    Функция может вызываться несколько раз подряд; при этом длины всех фрагментов, кроме
+    последнего, должны быть кратны длине блока. Все ассоциированные данные должны быть
+    обработаны до начала обработки шифруемых данных.
+
+    Множители \f$ H_i \f$ вырабатываются сразу для нескольких блоков одним вызовом многоблочной
+    функции зашифрования, а сумма произведений приводится по модулю один раз для всей группы.
+
+    @param ctx Контекст режима MGM.
+    @param bkey Ключ алгоритма блочного шифрования.
+    @param adata Указатель на ассоциированные данные.
+    @param adata_size Длина ассоциированных данных в байтах.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mgm_context_authentication_update( ak_mgm_ctx ctx, ak_bckey bkey,
+                                                  const ak_pointer adata, const size_t adata_size )
+{
+  size_t i, n, w;
+  ak_int64 blocks, tail;
+  ak_uint8 *aptr = ( ak_uint8 *)adata;
+  ak_uint64 h[ak_mgm_buffer_words], data[ak_mgm_buffer_words];
+  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option( "openssl_compability" );
+
+  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+  if( !adata_size ) return ak_error_ok;
+  if( adata == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                         "using null pointer to associated data" );
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to mgm context" );
+  if( !( ctx->flags&ak_mgm_flag_clean ))
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__,
+                                                            "using non initialized mgm context" );
+  if( ctx->flags&( ak_mgm_flag_adata_tail|ak_mgm_flag_data ))
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__,
+                                   "associated data cannot be added to mgm context at this stage" );
+  if(( ctx->bsize == 8 ) && ( ctx->abitlen + ( adata_size << 3 ) > 0xffffffffLL ))
+    return ak_error_message( ak_error_overflow, __func__,
+                                                       "too large length of associated data" );
+
+  blocks = ( ak_int64 )( adata_size/ctx->bsize );
+  tail = ( ak_int64 )( adata_size%ctx->bsize );
+  if(( error = ak_mgm_context_check_key( ctx, bkey, blocks + ( tail > 0 ))) != ak_error_ok )
+    return ak_error_message( error, __func__, "wrong secret key for mgm mode" );
+
+  w = ctx->bsize >> 3;
+  ctx->abitlen += ( adata_size << 3 );
+
+ /* обрабатываем полные блоки группами */
+  while( blocks > 0 ) {
+    n = ( size_t ) ak_min( blocks, ( ak_int64 )( ak_mgm_buffer_words/w ));
+    ak_mgm_context_counters( ctx, h, 0, n, oc );
+    ak_bckey_context_encrypt_blocks( bkey, h, h, n );
+    if( oc ) {
+      for( i = 0; i < n; i++ ) {
+         ak_mgm_reverse( h+i*w, h+i*w, ctx->bsize );
+         ak_mgm_reverse( data+i*w, (ak_uint64 *)( aptr+i*ctx->bsize ), ctx->bsize );
+      }
+      ak_mgm_context_multiply( ctx, h, data, n );
+    } else ak_mgm_context_multiply( ctx, h, aptr, n );
+    aptr += n*ctx->bsize;
+    blocks -= ( ak_int64 )n;
+  }
+
+ /* обрабатываем неполный блок, дополненный нулями */
+  if( tail ) {
+    ak_mgm_context_counters( ctx, h, 0, 1, oc );
+    bkey->encrypt( &bkey->key, h, h );
+    if( oc ) ak_mgm_reverse( h, h, ctx->bsize );
+    memset( data, 0, ctx->bsize );
+    for( i = 0; i < ( size_t )tail; i++ )
+       if( oc ) ((ak_uint8 *)data)[ctx->bsize-1-i] = aptr[i];
+         else ((ak_uint8 *)data)[ctx->bsize-( size_t )tail+i] = aptr[i];
+    ak_mgm_context_multiply( ctx, h, data, 1 );
+    ctx->flags |= ak_mgm_flag_adata_tail;
+  }
+
+ /* перемаскируем ключ */
+  if(( error = ak_skey_context_remask( &bkey->key,
+                      ( ak_int64 )(( adata_size + ctx->bsize - 1 )/ctx->bsize ))) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of secret key" );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Общая часть функций зашифрования и расшифрования данных в режиме MGM.
+
+    Значения счетчиков \f$ Y_i \f$ и \f$ Z_i \f$ для группы блоков зашифровываются одним вызовом
+    многоблочной функции, после чего выработанная гамма накладывается на данные, а сумма
+    произведений множителей \f$ H_i \f$ на блоки шифртекста вычисляется с однократным
+    приведением по модулю.
+
+    @param encrypt Флаг: ak_true для зашифрования, ak_false для расшифрования.                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_mgm_context_data_update( ak_mgm_ctx ctx, ak_bckey bkey, const ak_pointer in,
+                                          ak_pointer out, const size_t size, const bool_t encrypt )
+{
+  size_t i, n, w;
+  ak_int64 blocks, tail;
+  ak_uint8 *inptr = ( ak_uint8 *)in, *outptr = ( ak_uint8 *)out, *cptr, *gamma;
+  ak_uint64 buffer[2*ak_mgm_buffer_words], data[ak_mgm_buffer_words], *h;
+  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option( "openssl_compability" );
+
+  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+  if( !size ) return ak_error_ok;
+  if(( in == NULL ) || ( out == NULL )) return ak_error_message( ak_error_null_pointer, __func__,
+                                                                  "using null pointer to data" );
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to mgm context" );
+  if( !( ctx->flags&ak_mgm_flag_clean ))
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__,
+                                                            "using non initialized mgm context" );
+  if( ctx->flags&ak_mgm_flag_data_tail )
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__,
+                                         "data cannot be added to mgm context after a tail block" );
+  if(( ctx->bsize == 8 ) && ( ctx->pbitlen + ( size << 3 ) > 0xffffffffLL ))
+    return ak_error_message( ak_error_overflow, __func__, "too large length of processed data" );
+
+  blocks = ( ak_int64 )( size/ctx->bsize );
+  tail = ( ak_int64 )( size%ctx->bsize );
+  if(( error = ak_mgm_context_check_key( ctx, bkey, 2*( blocks + ( tail > 0 )))) != ak_error_ok )
+    return ak_error_message( error, __func__, "wrong secret key for mgm mode" );
+
+  w = ctx->bsize >> 3;
+  ctx->pbitlen += ( size << 3 );
+  ctx->flags |= ak_mgm_flag_data;
+
+ /* обрабатываем полные блоки группами */
+  while( blocks > 0 ) {
+    n = ( size_t ) ak_min( blocks, ( ak_int64 )( ak_mgm_buffer_words/w ));
+    h = buffer + n*w;
+    ak_mgm_context_counters( ctx, buffer, n, n, oc );
+    ak_bckey_context_encrypt_blocks( bkey, buffer, buffer, 2*n );
+
+   /* при расшифровании шифртекст учитывается до наложения гаммы,
+      поскольку указатели in и out могут совпадать */
+    cptr = encrypt ? outptr : inptr;
+    if( !encrypt ) {
+      if( oc ) for( i = 0; i < n; i++ ) {
+                  ak_mgm_reverse( h+i*w, h+i*w, ctx->bsize );
+                  ak_mgm_reverse( data+i*w, (ak_uint64 *)( cptr+i*ctx->bsize ), ctx->bsize );
+               }
+      ak_mgm_context_multiply( ctx, h, oc ? (ak_pointer) data : (ak_pointer) cptr, n );
+    }
+    for( i = 0; i < n*w; i++ ) ((ak_uint64 *)outptr)[i] = ((ak_uint64 *)inptr)[i] ^ buffer[i];
+    if( encrypt ) {
+      if( oc ) for( i = 0; i < n; i++ ) {
+                  ak_mgm_reverse( h+i*w, h+i*w, ctx->bsize );
+                  ak_mgm_reverse( data+i*w, (ak_uint64 *)( cptr+i*ctx->bsize ), ctx->bsize );
+               }
+      ak_mgm_context_multiply( ctx, h, oc ? (ak_pointer) data : (ak_pointer) cptr, n );
+    }
+    inptr += n*ctx->bsize; outptr += n*ctx->bsize;
+    blocks -= ( ak_int64 )n;
+  }
+
+ /* обрабатываем неполный блок: гамма берется из старших байт, шифртекст дополняется нулями */
+  if( tail ) {
+    h = buffer + w;
+    gamma = ( ak_uint8 *)buffer;
+    ak_mgm_context_counters( ctx, buffer, 1, 1, oc );
+    ak_bckey_context_encrypt_blocks( bkey, buffer, buffer, 2 );
+    if( oc ) ak_mgm_reverse( h, h, ctx->bsize );
+
+    memset( data, 0, ctx->bsize );
+    for( i = 0; i < ( size_t )tail; i++ ) {
+       ak_uint8 g = oc ? gamma[i] : gamma[ctx->bsize-( size_t )tail+i],
+                c = encrypt ? ( ak_uint8 )( inptr[i]^g ) : inptr[i];
+       if( oc ) ((ak_uint8 *)data)[ctx->bsize-1-i] = c;
+         else ((ak_uint8 *)data)[ctx->bsize-( size_t )tail+i] = c;
+       outptr[i] = inptr[i]^g;
+    }
+    ak_mgm_context_multiply( ctx, h, data, 1 );
+    ctx->flags |= ak_mgm_flag_data_tail;
+  }
+
+ /* перемаскируем ключ */
+  if(( error = ak_skey_context_remask( &bkey->key,
+                          2*( ak_int64 )(( size + ctx->bsize - 1 )/ctx->bsize ))) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of secret key" );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает фрагмент данных и добавляет полученный шифртекст к имитовставке.
+    Функция может вызываться несколько раз подряд; при этом длины всех фрагментов, кроме
+    последнего, должны быть кратны длине блока.
+
+    @param ctx Контекст режима MGM.
+    @param bkey Ключ алгоритма блочного шифрования.
+    @param in Указатель на зашифровываемые данные.
+    @param out Указатель на область памяти, куда помещается шифртекст
+    (этот указатель может совпадать с `in`).
+    @param size Длина данных в байтах.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mgm_context_encryption_update( ak_mgm_ctx ctx, ak_bckey bkey, const ak_pointer in,
+                                                              ak_pointer out, const size_t size )
+{
+  return ak_mgm_context_data_update( ctx, bkey, in, out, size, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция добавляет фрагмент шифртекста к имитовставке и расшифровывает его.
+    Функция может вызываться несколько раз подряд; при этом длины всех фрагментов, кроме
+    последнего, должны быть кратны длине блока.
+
+    @param ctx Контекст режима MGM.
+    @param bkey Ключ алгоритма блочного шифрования.
+    @param in Указатель на шифртекст.
+    @param out Указатель на область памяти, куда помещаются расшифрованные данные
+    (этот указатель может совпадать с `in`).
+    @param size Длина данных в байтах.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mgm_context_decryption_update( ak_mgm_ctx ctx, ak_bckey bkey, const ak_pointer in,
+                                                              ak_pointer out, const size_t size )
+{
+  return ak_mgm_context_data_update( ctx, bkey, in, out, size, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция добавляет к накопленной сумме блок, содержащий длины ассоциированных и
+    зашифрованных данных, зашифровывает результат и помещает `out_size` старших байт
+    полученного значения в область памяти `out`. После выполнения функции контекст должен
+    быть повторно инициализирован функцией ak_mgm_context_clean().
+
+    @param ctx Контекст режима MGM.
+    @param bkey Ключ алгоритма блочного шифрования.
+    @param out Указатель на область памяти, куда помещается имитовставка.
+    @param out_size Длина имитовставки в байтах (не более длины блока).
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mgm_context_finalize( ak_mgm_ctx ctx, ak_bckey bkey, ak_pointer out, const size_t out_size )
+{
+  ak_uint64 h[2], len[2];
+  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option( "openssl_compability" );
+
+  if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+  if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using null pointer to result buffer" );
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to mgm context" );
+  if( !( ctx->flags&ak_mgm_flag_clean ))
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__,
+                                                            "using non initialized mgm context" );
+  if( !out_size || out_size > ctx->bsize )
+    return ak_error_message( ak_error_wrong_length, __func__,
+                                                       "using incorrect length of result buffer" );
+  if(( error = ak_mgm_context_check_key( ctx, bkey, 2 )) != ak_error_ok )
+    return ak_error_message( error, __func__, "wrong secret key for mgm mode" );
+
+ /* добавляем блок с длинами: старшая половина содержит длину ассоциированных данных */
+  ak_mgm_context_counters( ctx, h, 0, 1, oc );
+  bkey->encrypt( &bkey->key, h, h );
+  if( oc ) ak_mgm_reverse( h, h, ctx->bsize );
+  if( ctx->bsize == 16 ) {
+   #ifdef LIBAKRYPT_LITTLE_ENDIAN
+    len[0] = ctx->pbitlen; len[1] = ctx->abitlen;
+   #else
+    len[0] = bswap_64( ctx->pbitlen ); len[1] = bswap_64( ctx->abitlen );
+   #endif
+  } else {
+    len[0] = ( ctx->abitlen << 32 )|( ctx->pbitlen&0xffffffffLL );
+   #ifndef LIBAKRYPT_LITTLE_ENDIAN
+    len[0] = bswap_64( len[0] );
+   #endif
+  }
+  ak_mgm_context_multiply( ctx, h, len, 1 );
+
+ /* зашифровываем сумму и копируем старшие байты результата */
+  if( oc ) ak_mgm_reverse( h, ctx->sum, ctx->bsize );
+    else memcpy( h, ctx->sum, ctx->bsize );
+  bkey->encrypt( &bkey->key, h, h );
+  if( oc ) memcpy( out, h, out_size );
+    else memcpy( out, (ak_uint8 *)h + ( ctx->bsize - out_size ), out_size );
+
+ /* контекст не может быть использован повторно без инициализации */
+  ctx->flags = 0;
+
+ /* перемаскируем ключ */
+  if(( error = ak_skey_context_remask( &bkey->key, 2 )) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of secret key" );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует режим аутентифицированного шифрования MGM: данные `in` зашифровываются,
+    а для ассоциированных данных `adata` и полученного шифртекста вычисляется имитовставка.
+    Для обработки данных, поступающих фрагментами, следует использовать функции
+    ak_mgm_context_clean(), ak_mgm_context_authentication_update(),
+    ak_mgm_context_encryption_update() и ak_mgm_context_finalize().
+
+    @param bkey Ключ алгоритма блочного шифрования (Магма или Кузнечик).
+    @param adata Указатель на ассоциированные данные (может быть NULL).
+    @param adata_size Длина ассоциированных данных в байтах.
+    @param in Указатель на зашифровываемые данные (может быть NULL).
+    @param out Указатель на область памяти, куда помещается шифртекст.
+    @param size Длина зашифровываемых данных в байтах.
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в байтах.
+    @param icode Указатель на область памяти, куда помещается имитовставка.
+    @param icode_size Длина имитовставки в байтах.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_context_encrypt_mgm( ak_bckey bkey, const ak_pointer adata, const size_t adata_size,
+                   const ak_pointer in, ak_pointer out, const size_t size, const ak_pointer iv,
+                                   const size_t iv_size, ak_pointer icode, const size_t icode_size )
+{
+  struct mgm_ctx ctx;
+  int error = ak_error_ok;
+
+  if(( error = ak_mgm_context_clean( &ctx, bkey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect initialization of mgm context" );
+  if(( error = ak_mgm_context_authentication_update( &ctx, bkey,
+                                                         adata, adata_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect processing of associated data" );
+  if(( error = ak_mgm_context_encryption_update( &ctx, bkey, in, out, size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect encryption of data" );
+  if(( error = ak_mgm_context_finalize( &ctx, bkey, icode, icode_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect calculation of integrity code" );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция расшифровывает данные `in`, вычисляет имитовставку для ассоциированных данных
+    `adata` и шифртекста и сравнивает ее со значением `icode`. В случае несовпадения
+    имитовставок расшифрованные данные затираются и возвращается
+    \ref ak_error_not_equal_data.
+
+    @param bkey Ключ алгоритма блочного шифрования (Магма или Кузнечик).
+    @param adata Указатель на ассоциированные данные (может быть NULL).
+    @param adata_size Длина ассоциированных данных в байтах.
+    @param in Указатель на шифртекст (может быть NULL).
+    @param out Указатель на область памяти, куда помещаются расшифрованные данные.
+    @param size Длина шифртекста в байтах.
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в байтах.
+    @param icode Указатель на проверяемую имитовставку.
+    @param icode_size Длина имитовставки в байтах.
+
+    @return В случае совпадения имитовставок возвращается \ref ak_error_ok (ноль).
+    В противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_context_decrypt_mgm( ak_bckey bkey, const ak_pointer adata, const size_t adata_size,
+                   const ak_pointer in, ak_pointer out, const size_t size, const ak_pointer iv,
+                                   const size_t iv_size, ak_pointer icode, const size_t icode_size )
+{
+  struct mgm_ctx ctx;
+  ak_uint8 result[16];
+  int error = ak_error_ok;
+
+  if( icode == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to integrity code" );
+  if(( error = ak_mgm_context_clean( &ctx, bkey, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect initialization of mgm context" );
+  if(( error = ak_mgm_context_authentication_update( &ctx, bkey,
+                                                         adata, adata_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect processing of associated data" );
+  if(( error = ak_mgm_context_decryption_update( &ctx, bkey, in, out, size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect decryption of data" );
+  if(( error = ak_mgm_context_finalize( &ctx, bkey, result, icode_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect calculation of integrity code" );
+
+  if( !ak_ptr_is_equal( result, icode, icode_size )) {
+    if( size ) memset( out, 0, size );
+    return ak_error_message( ak_error_not_equal_data, __func__, "wrong value of integrity code" );
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Проверка режима MGM для одного ключа на заданных значениях.
+
+    Проверяется зашифрование и расшифрование данных за один вызов, обработка данных
+    фрагментами, а также совпадение результатов для большого объема данных, обработанного
+    группами блоков и поблочно.                                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_bckey_test_mgm_values( ak_bckey bkey, ak_uint8 *adata, const size_t adata_size,
+                 ak_uint8 *in, ak_uint8 *out, const size_t size, ak_uint8 *iv, ak_uint8 *icode )
+{
+  size_t i = 0;
+  struct mgm_ctx ctx;
+  ak_uint8 myout[128], myicode[16], mydata[1000], myadata[200];
+  int error = ak_error_ok, audit = ak_log_get_level();
+
+ /* 1. зашифрование за один вызов */
+  if(( error = ak_bckey_context_encrypt_mgm( bkey, adata, adata_size, in, myout, size,
+                                      iv, bkey->bsize, myicode, bkey->bsize )) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "wrong mgm mode encryption" );
+    return ak_false;
+  }
+  if( !ak_ptr_is_equal_with_log( myout, out, size )) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                             "the mgm mode encryption test from R 1323565.1.026-2019 is wrong" );
+    return ak_false;
+  }
+  if( !ak_ptr_is_equal_with_log( myicode, icode, bkey->bsize )) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                         "the mgm mode integrity code test from R 1323565.1.026-2019 is wrong" );
+    return ak_false;
+  }
+
+ /* 2. расшифрование за один вызов с проверкой имитовставки */
+  if(( error = ak_bckey_context_decrypt_mgm( bkey, adata, adata_size, out, myout, size,
+                                          iv, bkey->bsize, icode, bkey->bsize )) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "wrong mgm mode decryption" );
+    return ak_false;
+  }
+  if( !ak_ptr_is_equal_with_log( myout, in, size )) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                             "the mgm mode decryption test from R 1323565.1.026-2019 is wrong" );
+    return ak_false;
+  }
+  if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
+                 "the mgm mode encryption/decryption test from R 1323565.1.026-2019 is Ok" );
+
+ /* 3. обработка данных фрагментами */
+  memset( myout, 0, sizeof( myout ));
+  memset( myicode, 0, sizeof( myicode ));
+  if(( error = ak_mgm_context_clean( &ctx, bkey, iv, bkey->bsize )) != ak_error_ok ) goto lexit;
+  if(( error = ak_mgm_context_authentication_update( &ctx, bkey,
+                                                      adata, bkey->bsize )) != ak_error_ok ) goto lexit;
+  if(( error = ak_mgm_context_authentication_update( &ctx, bkey,
+                  adata+bkey->bsize, adata_size-bkey->bsize )) != ak_error_ok ) goto lexit;
+  if(( error = ak_mgm_context_encryption_update( &ctx, bkey,
+                                              in, myout, 2*bkey->bsize )) != ak_error_ok ) goto lexit;
+  if(( error = ak_mgm_context_encryption_update( &ctx, bkey, in+2*bkey->bsize,
+                           myout+2*bkey->bsize, size-2*bkey->bsize )) != ak_error_ok ) goto lexit;
+  if(( error = ak_mgm_context_finalize( &ctx, bkey, myicode, bkey->bsize )) != ak_error_ok )
+    goto lexit;
+  if( !ak_ptr_is_equal_with_log( myout, out, size ) ||
+                                         !ak_ptr_is_equal_with_log( myicode, icode, bkey->bsize )) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                                           "the mgm mode encryption of data fragments is wrong" );
+    return ak_false;
+  }
+
+ /* 4. большой объем данных: группы блоков и поблочная обработка должны совпадать */
+  for( i = 0; i < sizeof( mydata ); i++ ) mydata[i] = ( ak_uint8 )( in[i%size] + i );
+  for( i = 0; i < sizeof( myadata ); i++ ) myadata[i] = ( ak_uint8 )( adata[i%adata_size] ^ i );
+  if(( error = ak_bckey_context_encrypt_mgm( bkey, myadata, sizeof( myadata ), mydata, mydata,
+                      sizeof( mydata ), iv, bkey->bsize, myicode, bkey->bsize )) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "wrong mgm mode encryption of long data" );
+    return ak_false;
+  }
+  if(( error = ak_mgm_context_clean( &ctx, bkey, iv, bkey->bsize )) != ak_error_ok ) goto lexit;
+  for( i = 0; i < sizeof( myadata ); i += bkey->bsize )
+     if(( error = ak_mgm_context_authentication_update( &ctx, bkey, myadata+i,
+                        ak_min( bkey->bsize, sizeof( myadata ) - i ))) != ak_error_ok ) goto lexit;
+  for( i = 0; i < sizeof( mydata ); i += bkey->bsize )
+     if(( error = ak_mgm_context_decryption_update( &ctx, bkey, mydata+i, mydata+i,
+                         ak_min( bkey->bsize, sizeof( mydata ) - i ))) != ak_error_ok ) goto lexit;
+  if(( error = ak_mgm_context_finalize( &ctx, bkey, myout, bkey->bsize )) != ak_error_ok )
+    goto lexit;
+  if( !ak_ptr_is_equal_with_log( myout, myicode, bkey->bsize )) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                                "the mgm mode integrity code for long data is wrong" );
+    return ak_false;
+  }
+  for( i = 0; i < sizeof( mydata ); i++ )
+     if( mydata[i] != ( ak_uint8 )( in[i%size] + i )) {
+       ak_error_message( ak_error_not_equal_data, __func__ ,
+                                               "the mgm mode decryption of long data is wrong" );
+       return ak_false;
+     }
+  if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
+                                   "the mgm mode test for data fragments and long data is Ok" );
+ return ak_true;
+
+  lexit:
+   ak_error_message( error, __func__ , "wrong processing of data fragments in mgm mode" );
+ return ak_false;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция проверяет корректность реализации режима MGM для алгоритмов блочного шифрования
+    Магма и Кузнечик с использованием контрольных примеров из Р 1323565.1.026-2019.
+
+    @return Функция возвращает ak_true, если тестирование прошло успешно.
+    В противном случае, возвращается ak_false.                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ bool_t ak_bckey_test_mgm( void )
+{
+ /* ключ, синхропосылка и данные для алгоритма Кузнечик */
+  ak_uint8 kuznechik_key[32] = {
+    0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+    0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+  ak_uint8 openssl_kuznechik_key[32] = {
+    0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+    0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10, 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef };
+  ak_uint8 kuznechik_iv[16] = {
+    0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11 };
+  ak_uint8 openssl_kuznechik_iv[16] = {
+    0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+  ak_uint8 kuznechik_adata[41] = {
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+    0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0xea };
+  ak_uint8 openssl_kuznechik_adata[41] = {
+    0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    0xea, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05 };
+  ak_uint8 kuznechik_in[67] = {
+    0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+    0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00,
+    0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+    0x11, 0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22,
+    0xcc, 0xbb, 0xaa };
+  ak_uint8 openssl_kuznechik_in[67] = {
+    0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88,
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xee, 0xff, 0x0a,
+    0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xee, 0xff, 0x0a, 0x00,
+    0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xee, 0xff, 0x0a, 0x00, 0x11,
+    0xaa, 0xbb, 0xcc };
+  ak_uint8 kuznechik_out[67] = {
+    0xfc, 0x42, 0x9f, 0xe8, 0x3d, 0xa3, 0xb8, 0x55, 0x90, 0x6e, 0x95, 0x47, 0x81, 0x7b, 0x75, 0xa9,
+    0x39, 0x6b, 0xc1, 0xad, 0x9a, 0x06, 0xf7, 0xd3, 0x5b, 0xfd, 0xf9, 0x2b, 0x21, 0xd2, 0x75, 0x80,
+    0x1c, 0x85, 0xf6, 0xa9, 0x0e, 0x5d, 0x6b, 0x93, 0x85, 0xba, 0xa6, 0x15, 0x59, 0xb1, 0x7a, 0x49,
+    0xeb, 0x6d, 0xc7, 0x95, 0x06, 0x42, 0x94, 0xab, 0xd0, 0x83, 0xf8, 0xd3, 0xd4, 0x14, 0x0c, 0xc6,
+    0x52, 0x75, 0x2c };
+  ak_uint8 openssl_kuznechik_out[67] = {
+    0xa9, 0x75, 0x7b, 0x81, 0x47, 0x95, 0x6e, 0x90, 0x55, 0xb8, 0xa3, 0x3d, 0xe8, 0x9f, 0x42, 0xfc,
+    0x80, 0x75, 0xd2, 0x21, 0x2b, 0xf9, 0xfd, 0x5b, 0xd3, 0xf7, 0x06, 0x9a, 0xad, 0xc1, 0x6b, 0x39,
+    0x49, 0x7a, 0xb1, 0x59, 0x15, 0xa6, 0xba, 0x85, 0x93, 0x6b, 0x5d, 0x0e, 0xa9, 0xf6, 0x85, 0x1c,
+    0xc6, 0x0c, 0x14, 0xd4, 0xd3, 0xf8, 0x83, 0xd0, 0xab, 0x94, 0x42, 0x06, 0x95, 0xc7, 0x6d, 0xeb,
+    0x2c, 0x75, 0x52 };
+  ak_uint8 kuznechik_icode[16] = {
+    0x4c, 0xdb, 0xfc, 0x29, 0x0e, 0xbb, 0xe8, 0x46, 0x5c, 0x4f, 0xc3, 0x40, 0x6f, 0x65, 0x5d, 0xcf };
+  ak_uint8 openssl_kuznechik_icode[16] = {
+    0xcf, 0x5d, 0x65, 0x6f, 0x40, 0xc3, 0x4f, 0x5c, 0x46, 0xe8, 0xbb, 0x0e, 0x29, 0xfc, 0xdb, 0x4c };
+
+ /* ключ, синхропосылка и данные для алгоритма Магма */
+  ak_uint8 magma_key[32] = {
+    0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8, 0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0,
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+  ak_uint8 openssl_magma_key[32] = {
+    0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00,
+    0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff };
+  ak_uint8 magma_iv[8] = {
+    0x59, 0x0a, 0x13, 0x3c, 0x6b, 0xf0, 0xde, 0x12 };
+  ak_uint8 openssl_magma_iv[8] = {
+    0x12, 0xde, 0xf0, 0x6b, 0x3c, 0x13, 0x0a, 0x59 };
+  ak_uint8 magma_adata[41] = {
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+    0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0xea };
+  ak_uint8 openssl_magma_adata[41] = {
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+    0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0xea };
+  ak_uint8 magma_in[67] = {
+    0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+    0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00,
+    0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11,
+    0x11, 0x00, 0x0a, 0xff, 0xee, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22,
+    0xcc, 0xbb, 0xaa };
+  ak_uint8 openssl_magma_in[67] = {
+    0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x00,
+    0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xee, 0xff, 0x0a, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+    0x99, 0xaa, 0xbb, 0xcc, 0xee, 0xff, 0x0a, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88,
+    0xaa, 0xbb, 0xcc, 0xee, 0xff, 0x0a, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99,
+    0xaa, 0xbb, 0xcc };
+  ak_uint8 magma_out[67] = {
+    0x3b, 0xa0, 0x9e, 0x5f, 0x6c, 0x06, 0x95, 0xc7, 0xae, 0x85, 0x91, 0x45, 0x42, 0x33, 0x11, 0x85,
+    0x5d, 0x78, 0x2b, 0xbf, 0xd6, 0x00, 0x2e, 0x1f, 0x7d, 0x8e, 0x9c, 0xbb, 0xb8, 0x70, 0x04, 0x94,
+    0x70, 0xdc, 0x7d, 0x1f, 0x73, 0xd3, 0x5d, 0x9a, 0x76, 0xa5, 0x6f, 0xce, 0x0a, 0xcb, 0x27, 0xec,
+    0xd5, 0x75, 0xbb, 0x6a, 0x64, 0x5c, 0xf6, 0x70, 0x4e, 0xc3, 0xb5, 0xbc, 0xc3, 0x37, 0xaa, 0x47,
+    0x9c, 0xbb, 0x03 };
+  ak_uint8 openssl_magma_out[67] = {
+    0xc7, 0x95, 0x06, 0x6c, 0x5f, 0x9e, 0xa0, 0x3b, 0x85, 0x11, 0x33, 0x42, 0x45, 0x91, 0x85, 0xae,
+    0x1f, 0x2e, 0x00, 0xd6, 0xbf, 0x2b, 0x78, 0x5d, 0x94, 0x04, 0x70, 0xb8, 0xbb, 0x9c, 0x8e, 0x7d,
+    0x9a, 0x5d, 0xd3, 0x73, 0x1f, 0x7d, 0xdc, 0x70, 0xec, 0x27, 0xcb, 0x0a, 0xce, 0x6f, 0xa5, 0x76,
+    0x70, 0xf6, 0x5c, 0x64, 0x6a, 0xbb, 0x75, 0xd5, 0x47, 0xaa, 0x37, 0xc3, 0xbc, 0xb5, 0xc3, 0x4e,
+    0x03, 0xbb, 0x9c };
+  ak_uint8 magma_icode[8] = {
+    0x10, 0xfd, 0x10, 0xaa, 0x69, 0x80, 0x92, 0xa7 };
+  ak_uint8 openssl_magma_icode[8] = {
+    0xa7, 0x92, 0x80, 0x69, 0xaa, 0x10, 0xfd, 0x10 };
+
+  struct bckey key;
+  bool_t result = ak_true;
+  int error = ak_error_ok, audit = ak_log_get_level(),
+      oc = (int) ak_libakrypt_get_option( "openssl_compability" );
+
+ /* Проверка используемого режима совместимости */
+  if(( oc < 0 ) || ( oc > 1 )) {
+    ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+    return ak_false;
+  }
+
+ /* 1. Тестируем режим для алгоритма Кузнечик */
+  if(( error = ak_bckey_context_create_kuznechik( &key )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect initialization of kuznechik secret key context");
+    return ak_false;
+  }
+  if(( error = ak_bckey_context_set_key( &key, oc ? openssl_kuznechik_key : kuznechik_key,
+                                                       sizeof( kuznechik_key ))) != ak_error_ok ) {
+    ak_error_message( error, __func__, "wrong creation of test key" );
+    result = ak_false;
+  } else
+     result = ak_bckey_test_mgm_values( &key, oc ? openssl_kuznechik_adata : kuznechik_adata,
+                        sizeof( kuznechik_adata ), oc ? openssl_kuznechik_in : kuznechik_in,
+                        oc ? openssl_kuznechik_out : kuznechik_out, sizeof( kuznechik_in ),
+                                                   oc ? openssl_kuznechik_iv : kuznechik_iv,
+                                               oc ? openssl_kuznechik_icode : kuznechik_icode );
+  ak_bckey_context_destroy( &key );
+  if( result != ak_true ) {
+    ak_error_message( ak_error_get_value(), __func__ , "incorrect testing of mgm mode for kuznechik" );
+    return ak_false;
+  }
+  if( audit >= ak_log_maximum )
+    ak_error_message( ak_error_ok, __func__ , "testing of mgm mode for kuznechik is Ok" );
+
+ /* 2. Тестируем режим для алгоритма Магма */
+  if(( error = ak_bckey_context_create_magma( &key )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect initialization of magma secret key context");
+    return ak_false;
+  }
+  if(( error = ak_bckey_context_set_key( &key, oc ? openssl_magma_key : magma_key,
+                                                           sizeof( magma_key ))) != ak_error_ok ) {
+    ak_error_message( error, __func__, "wrong creation of test key" );
+    result = ak_false;
+  } else
+     result = ak_bckey_test_mgm_values( &key, oc ? openssl_magma_adata : magma_adata,
+                                sizeof( magma_adata ), oc ? openssl_magma_in : magma_in,
+                                        oc ? openssl_magma_out : magma_out, sizeof( magma_in ),
+                                                           oc ? openssl_magma_iv : magma_iv,
+                                                       oc ? openssl_magma_icode : magma_icode );
+  ak_bckey_context_destroy( &key );
+  if( result != ak_true ) {
+    ak_error_message( ak_error_get_value(), __func__ , "incorrect testing of mgm mode for magma" );
+    return ak_false;
+  }
+  if( audit >= ak_log_maximum )
+    ak_error_message( ak_error_ok, __func__ , "testing of mgm mode for magma is Ok" );
+
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                                       ak_mgm.c  */
+/* ----------------------------------------------------------------------------------------------- */
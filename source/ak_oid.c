@@ -37,6 +37,12 @@
  static const char *on_streebog512[] =      { "streebog512", "md_gost12_512", NULL };
  static const char *on_hmac_streebog256[] = { "hmac-streebog256", "HMAC-md_gost12_256", NULL };
  static const char *on_hmac_streebog512[] = { "hmac-streebog512", "HMAC-md_gost12_512", NULL };
+ static const char *on_sha3_256[] =         { "sha3-256", NULL };
+ static const char *on_sha3_384[] =         { "sha3-384", NULL };
+ static const char *on_sha3_512[] =         { "sha3-512", NULL };
+ static const char *on_hmac_sha3_256[] =    { "hmac-sha3-256", NULL };
+ static const char *on_hmac_sha3_384[] =    { "hmac-sha3-384", NULL };
+ static const char *on_hmac_sha3_512[] =    { "hmac-sha3-512", NULL };
 
  static const char *on_kuznechik[] =        { "kuznechik", "kuznyechik", "grasshopper", NULL };
  static const char *on_magma[] =            { "magma", NULL };
@@ -166,6 +172,23 @@
                                                   ( ak_function_void *) ak_hash_context_destroy,
                                                    ( ak_function_void *) ak_hash_context_delete }},
 
+  /* идентификаторы функций хеширования SHA-3 согласно FIPS 202,
+     значения OID взяты из дерева NIST (2.16.840.1.101.3.4.2 - hashAlgs) */
+   { hash_function, algorithm, on_sha3_256, "2.16.840.1.101.3.4.2.8", NULL,
+                { sizeof( struct hash ), ( ak_function_void *) ak_hash_context_create_sha3_256,
+                                                  ( ak_function_void *) ak_hash_context_destroy,
+                                                   ( ak_function_void *) ak_hash_context_delete }},
+
+   { hash_function, algorithm, on_sha3_384, "2.16.840.1.101.3.4.2.9", NULL,
+                { sizeof( struct hash ), ( ak_function_void *) ak_hash_context_create_sha3_384,
+                                                  ( ak_function_void *) ak_hash_context_destroy,
+                                                   ( ak_function_void *) ak_hash_context_delete }},
+
+   { hash_function, algorithm, on_sha3_512, "2.16.840.1.101.3.4.2.10", NULL,
+                { sizeof( struct hash ), ( ak_function_void *) ak_hash_context_create_sha3_512,
+                                                  ( ak_function_void *) ak_hash_context_destroy,
+                                                   ( ak_function_void *) ak_hash_context_delete }},
+
   /* 3. идентификаторы параметров алгоритма бесключевого хеширования ГОСТ Р 34.11-94.
         значения OID взяты из перечней КриптоПро
 
@@ -183,6 +206,22 @@
                                                   ( ak_function_void *) ak_hmac_context_destroy,
                                                    ( ak_function_void *) ak_hmac_context_delete }},
 
+  /* идентификаторы алгоритмов HMAC на основе функций хеширования SHA-3 (NIST) */
+   { hmac_function, algorithm, on_hmac_sha3_256, "2.16.840.1.101.3.4.2.14", NULL,
+                { sizeof( struct hmac ), ( ak_function_void *) ak_hmac_context_create_sha3_256,
+                                                  ( ak_function_void *) ak_hmac_context_destroy,
+                                                   ( ak_function_void *) ak_hmac_context_delete }},
+
+   { hmac_function, algorithm, on_hmac_sha3_384, "2.16.840.1.101.3.4.2.15", NULL,
+                { sizeof( struct hmac ), ( ak_function_void *) ak_hmac_context_create_sha3_384,
+                                                  ( ak_function_void *) ak_hmac_context_destroy,
+                                                   ( ak_function_void *) ak_hmac_context_delete }},
+
+   { hmac_function, algorithm, on_hmac_sha3_512, "2.16.840.1.101.3.4.2.16", NULL,
+                { sizeof( struct hmac ), ( ak_function_void *) ak_hmac_context_create_sha3_512,
+                                                  ( ak_function_void *) ak_hmac_context_destroy,
+                                                   ( ak_function_void *) ak_hmac_context_delete }},
+
   /* 6. идентификаторы алгоритмов блочного шифрования
         в дереве библиотеки: 1.2.643.2.52.1.6 - алгоритмы блочного шифрования
         в дереве библиотеки: 1.2.643.2.52.1.7 - параметры алгоритмов блочного шифрования */
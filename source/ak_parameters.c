@@ -315,6 +315,42 @@
   "fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffdc7"
  };
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Параметры скрученной кривой Эдвардса, эквивалентной 256-ти битной кривой paramSetA
+    из рекомендаций Р 50.1.114-2016. */
+/*! \code
+      e = "1",
+      d = "605F6B7C183FA81578BC39CFAD518132B9DF62897009AF7E522C32D6DC7BFFB",
+      s = "7E7E82520F9F015FAA1D0F18C14AB9FB35188275DA3FD94206B74F34A48E0ECD",
+      t = "100FE73F595FF158E974B44D478D9588744FE5C192AC47EA63075DCE7A14AAA"
+    \endcode                                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ const struct tcurve id_tc26_gost_3410_2012_256_paramSetA_twisted = {
+  ( ak_wcurve ) &id_tc26_gost_3410_2012_256_paramSetA,
+  { 0x0000000000000269LL, 0x0000000000000000LL, 0x0000000000000000LL, 0x0000000000000000LL }, /* e */
+  { 0x40c8687d966dd5b1LL, 0x1fb647d3f0757f77LL, 0xffda75588b970634LL, 0x845fa0e16716c1bbLL }, /* d */
+  { 0x2fcde5e09a6488c5LL, 0xf8126e0b03e2a022LL, 0x000962a9dd1a3e72LL, 0xdee817c7a63a4f91LL }, /* s */
+  { 0x8acc116a43bcf88cLL, 0x05490bf8a813953eLL, 0xaaa468e41743d65eLL, 0x6b65457ae683caf4LL }  /* t */
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Параметры скрученной кривой Эдвардса, эквивалентной 512-ти битной кривой paramSetC
+    из рекомендаций Р 50.1.114-2016. */
+/*! \code
+      e = "1",
+      d = "9E4F5D8C017D8D9F13A5CF3CDF5BFE4DAB402D54198E31EBDE28A0621050439CA6B39E0A515C06B304E2CE43E79E369E91A0CFC2BC2A22B4CA302DBB33EE7550",
+      s = "186C289CFFA09C983B168C30C829006C952FF4AAF99C73850875D7E77BEBEF18D653187D6BA8FE533EC74C6F061872585B97CC0F50F57752CD73F4913304621E",
+      t = "9A628F975594ECEFD89BA28A2539FFB79C8AB238AEED0851FA5C1ABB02B80B44C6734501B83A011DD625CD0B5145091A6D9ACD4B1F5C5B1E21B2B249DDFD1271"
+    \endcode                                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ const struct tcurve id_tc26_gost_3410_2012_512_paramSetC_twisted = {
+  ( ak_wcurve ) &id_tc26_gost_3410_2012_512_paramSetC,
+  { 0x0000000000000239, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 }, /* e */
+  { 0x6515a5166d05caf7, 0xae6dc7d439a723d5, 0xdc1c74edcea76671, 0x853a44eed58ae3e5, 0xc84c79f64266472e, 0xa1a4bfeccd0cf540, 0xab899e4c73783aa1, 0xde66ec2f500fc692 }, /* d */
+  { 0xa6ba96ba64be8cb4, 0x94648e0af196370a, 0x88f8e2c48c562663, 0x5eb16ec44a9d4706, 0xcdece1826f666e34, 0x9796d004ccbcc2af, 0x551d986ce321f157, 0x486644f42bfc0e5b }, /* s */
+  { 0xe62e462e6780f788, 0x9d124bf8b44685f8, 0xfa04be27a2713bbd, 0x163460d278ec7b50, 0x76b769a90b110bdd, 0xf0461ffcccd77e35, 0x71ec450cbde95f1a, 0x2511275d3802a118 }  /* t */
+ };
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                                                                                ak_parameters.c  */
 /* ----------------------------------------------------------------------------------------------- */
@@ -1584,6 +1584,12 @@ extern "C" {
  extern const struct wcurve id_tc26_gost_3410_2012_512_paramSetB;
  extern const struct wcurve id_tc26_gost_3410_2012_512_paramSetC;
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                            параметры скрученных кривых Эдвардса                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ extern const struct tcurve id_tc26_gost_3410_2012_256_paramSetA_twisted;
+ extern const struct tcurve id_tc26_gost_3410_2012_512_paramSetC_twisted;
+
 #ifdef __cplusplus
 } /* конец extern "C" */
 #endif
@@ -23,6 +23,10 @@
 #ifdef LIBAKRYPT_HAVE_TIME_H
  #include <time.h>
 #endif
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ #include <pthread.h>
+ #include <unistd.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Установление или изменение маски секретного ключа ассиметричного криптографического
@@ -616,7 +620,7 @@
 
  /* поскольку функция не экспортируется, мы оставляем все проверки функциям верхнего уровня */
  /* вычисляем r */
-  ak_wpoint_pow( &wr, &wc->point, k, wc->size, wc );
+  ak_wpoint_pow_base( &wr, k, wc->size, wc );
   ak_wpoint_reduce( &wr, wc );
   ak_mpzn_rem( r, wr.x, wc->q, wc->size );
 
@@ -871,7 +875,7 @@
  /* теперь определяем открытый ключ */
   ak_mpzn_mul_montgomery( k, ( ak_uint64 *)sctx->key.key, one,
                                                       pctx->wc->q, pctx->wc->nq, pctx->wc->size );
-  ak_wpoint_pow( &pctx->qpoint, &pctx->wc->point, k, pctx->wc->size, pctx->wc );
+  ak_wpoint_pow_base( &pctx->qpoint, k, pctx->wc->size, pctx->wc );
 
   ak_mpzn_mul_montgomery( k, ( ak_uint64 *)( sctx->key.key + sctx->key.key_size ),
                                                   one, pctx->wc->q, pctx->wc->nq, pctx->wc->size);
@@ -982,7 +986,7 @@
   int i = 0;
 #endif
   ak_mpzn512 v, z1, z2, u, r, s, h;
-  struct wpoint cpoint, tpoint;
+  struct wpoint cpoint;
 
   if( pctx == NULL ) {
     ak_error_message( ak_error_null_pointer, __func__,
@@ -1034,9 +1038,8 @@
   ak_mpzn_mul_montgomery( z2, z2, pctx->wc->point.z, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
 
  /* сложение точек и проверка */
-  ak_wpoint_pow( &cpoint, &pctx->wc->point, z1, pctx->wc->size, pctx->wc );
-  ak_wpoint_pow( &tpoint, &pctx->qpoint, z2, pctx->wc->size, pctx->wc );
-  ak_wpoint_add( &cpoint, &tpoint, pctx->wc );
+  ak_wpoint_pow_double( &cpoint, &pctx->wc->point, z1,
+                                        &pctx->qpoint, z2, pctx->wc->size, pctx->wc );
   ak_wpoint_reduce( &cpoint, pctx->wc );
   ak_mpzn_rem( cpoint.x, cpoint.x, pctx->wc->q, pctx->wc->size );
 
@@ -1047,6 +1050,320 @@
  return ak_true;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                             пакетная проверка электронной подписи                               */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество подписей, обрабатываемых потоком за один раз. */
+ #define ak_verifykey_batch_chunk_size  ( 32 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Общие данные потоков, выполняющих пакетную проверку электронной подписи. */
+ typedef struct verify_batch {
+  /*! \brief Массив заданий. */
+   ak_verify_task tasks;
+  /*! \brief Количество заданий. */
+   size_t count;
+  /*! \brief Номер первого нераспределенного задания. */
+   size_t next;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  /*! \brief Мьютекс, защищающий номер первого нераспределенного задания. */
+   pthread_mutex_t mutex;
+#endif
+ } *ak_verify_batch;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Промежуточные значения, вычисляемые при проверке одной подписи из пакета. */
+ typedef struct verify_item {
+  /*! \brief Величина \f$ r \f$ из подписи. */
+   ak_mpzn512 r;
+  /*! \brief Величина \f$ s \f$ из подписи. */
+   ak_mpzn512 s;
+  /*! \brief Вычет \f$ e \f$ (в представлении Монтгомери), а затем обратный к нему. */
+   ak_mpzn512 v;
+  /*! \brief Точка \f$ C = [z_1]P + [z_2]Q \f$. */
+   struct wpoint cpoint;
+  /*! \brief Признак того, что подпись еще проверяется. */
+   bool_t active;
+  /*! \brief Признак того, что значение уже обработано при групповом обращении. */
+   bool_t done;
+ } *ak_verify_item;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обращает набор вычетов в представлении Монтгомери, вычисляя одну степень
+    по модулю (метод Монтгомери): для \f$ c_i = a_1\cdots a_i \f$ вычисляется \f$ c_n^{-1} \f$,
+    после чего обратные элементы получаются последовательным домножением.
+
+    @param vals Указатели на ненулевые обращаемые вычеты; результат помещается на их место.
+    @param count Количество вычетов, не более \ref ak_verifykey_batch_chunk_size.
+    @param m Простой модуль.
+    @param n0 Константа Монтгомери для модуля m.
+    @param size Размер модуля в машинных словах.                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_mpzn_batch_inverse_montgomery( ak_uint64 **vals, size_t count, ak_uint64 *m,
+                                                                ak_uint64 n0, const size_t size )
+{
+  size_t i = 0;
+  ak_mpzn512 prefix[ak_verifykey_batch_chunk_size], inv, u;
+
+  if( !count ) return;
+  ak_mpzn_set( prefix[0], vals[0], size );
+  for( i = 1; i < count; i++ )
+     ak_mpzn_mul_montgomery( prefix[i], prefix[i-1], vals[i], m, n0, size );
+
+  ak_mpzn_set_ui( u, size, 2 );
+  ak_mpzn_sub( u, m, u, size );
+  ak_mpzn_modpow_montgomery( inv, prefix[count-1], u, m, n0, size ); // inv <- c_n^{m-2} (mod m)
+
+  for( i = count-1; i > 0; i-- ) {
+     ak_mpzn_mul_montgomery( u, inv, prefix[i-1], m, n0, size );       // u = a_i^{-1}
+     ak_mpzn_mul_montgomery( inv, inv, vals[i], m, n0, size );         // inv = c_{i-1}^{-1}
+     ak_mpzn_set( vals[i], u, size );
+  }
+  ak_mpzn_set( vals[0], inv, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обращает по модулю \f$ q \f$ (если q_mod истинно) или по модулю \f$ p \f$
+    значения, принадлежащие подписям, вычисленным на одной кривой, выполняя одно
+    возведение в степень для каждой встречающейся кривой.                                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_verifykey_batch_inverse( ak_verify_task tasks, ak_verify_item items,
+                                                                  size_t count, bool_t q_mod )
+{
+  size_t i = 0, j = 0, cnt = 0;
+  ak_wcurve wc = NULL;
+  ak_uint64 *vals[ak_verifykey_batch_chunk_size];
+
+  for( i = 0; i < count; i++ ) items[i].done = !items[i].active;
+  for( i = 0; i < count; i++ ) {
+     if( items[i].done ) continue;
+     wc = tasks[i].key->wc;
+     for( j = i, cnt = 0; j < count; j++ ) {
+        if( items[j].done || ( tasks[j].key->wc != wc )) continue;
+        vals[cnt++] = q_mod ? items[j].v : items[j].cpoint.z;
+        items[j].done = ak_true;
+     }
+     if( q_mod ) ak_mpzn_batch_inverse_montgomery( vals, cnt, wc->q, wc->nq, wc->size );
+      else ak_mpzn_batch_inverse_montgomery( vals, cnt, wc->p, wc->n, wc->size );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет группу подписей, используя общие обращения вычетов.
+    \details Вычисления повторяют функцию ak_verifykey_context_verify_hash(): обращение
+    вычета \f$ e \f$ по модулю \f$ q \f$ и приведение точки \f$ C \f$ к аффинной форме
+    выполняются сразу для всех подписей группы. Подписи, не прошедшие проверку,
+    повторно проверяются функцией ak_verifykey_context_verify_hash().                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_verifykey_batch_chunk( ak_verify_task tasks, size_t count )
+{
+#ifndef LIBAKRYPT_LITTLE_ENDIAN
+  size_t k = 0;
+#endif
+  size_t i = 0;
+  ak_verifykey pctx = NULL;
+  ak_mpzn512 z1, z2, h, one = ak_mpzn512_one;
+  struct verify_item items[ak_verifykey_batch_chunk_size];
+
+ /* проверяем входные данные и вычисляем e (в представлении Монтгомери) */
+  for( i = 0; i < count; i++ ) {
+     tasks[i].result = ak_false;
+     items[i].active = ak_false;
+     if(( pctx = tasks[i].key ) == NULL ) {
+       tasks[i].error = ak_error_message( ak_error_null_pointer, __func__,
+                                                 "using a null pointer to public key context" );
+       continue;
+     }
+     if(( tasks[i].hash == NULL ) || ( tasks[i].sign == NULL )) {
+       tasks[i].error = ak_error_message( ak_error_null_pointer, __func__,
+                                             "using a null pointer to hash or sign value" );
+       continue;
+     }
+     if( tasks[i].hsize != sizeof( ak_uint64 )*( pctx->wc->size )) {
+       tasks[i].error = ak_error_message( ak_error_wrong_length, __func__,
+                                                           "using hash value with wrong length" );
+       continue;
+     }
+     ak_mpzn_set_little_endian( items[i].s, pctx->wc->size, tasks[i].sign,
+                                                   sizeof( ak_uint64 )*pctx->wc->size, ak_true );
+     ak_mpzn_set_little_endian( items[i].r, pctx->wc->size,
+                    ( ak_uint64* )tasks[i].sign + pctx->wc->size,
+                                                   sizeof( ak_uint64 )*pctx->wc->size, ak_true );
+     memcpy( h, tasks[i].hash, sizeof( ak_uint64 )*pctx->wc->size );
+#ifndef LIBAKRYPT_LITTLE_ENDIAN
+     for( k = 0; k < pctx->wc->size; k++ ) h[k] = bswap_64( h[k] );
+#endif
+     ak_mpzn_rem( items[i].v, h, pctx->wc->q, pctx->wc->size );
+     if( ak_mpzn_cmp_ui( items[i].v, pctx->wc->size, 0 ))
+       ak_mpzn_set_ui( items[i].v, pctx->wc->size, 1 );
+     ak_mpzn_mul_montgomery( items[i].v, items[i].v, pctx->wc->r2q,
+                                                 pctx->wc->q, pctx->wc->nq, pctx->wc->size );
+     items[i].active = ak_true;
+     tasks[i].error = ak_error_ok;
+  }
+
+ /* v <- e^{-1} (mod q) */
+  ak_verifykey_batch_inverse( tasks, items, count, ak_true );
+
+ /* вычисляем точки C = [z1]P + [z2]Q */
+  for( i = 0; i < count; i++ ) {
+     if( !items[i].active ) continue;
+     pctx = tasks[i].key;
+     ak_mpzn_mul_montgomery( z1, items[i].s, pctx->wc->r2q, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
+     ak_mpzn_mul_montgomery( z1, z1, items[i].v, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
+     ak_mpzn_mul_montgomery( z1, z1, pctx->wc->point.z, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
+
+     ak_mpzn_mul_montgomery( z2, items[i].r, pctx->wc->r2q, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
+     ak_mpzn_sub( z2, pctx->wc->q, z2, pctx->wc->size );
+     ak_mpzn_mul_montgomery( z2, z2, items[i].v, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
+     ak_mpzn_mul_montgomery( z2, z2, pctx->wc->point.z, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
+
+     ak_wpoint_pow_double( &items[i].cpoint, &pctx->wc->point, z1,
+                                                     &pctx->qpoint, z2, pctx->wc->size, pctx->wc );
+    /* бесконечно удаленная точка не может быть приведена к аффинной форме */
+     if( ak_mpzn_cmp_ui( items[i].cpoint.z, pctx->wc->size, 0 ) == ak_true )
+       items[i].active = ak_false;
+  }
+
+ /* z <- z^{-1} (mod p) */
+  ak_verifykey_batch_inverse( tasks, items, count, ak_false );
+
+ /* сравниваем x/z (mod q) с величиной r */
+  for( i = 0; i < count; i++ ) {
+     if( tasks[i].error != ak_error_ok ) continue;
+     pctx = tasks[i].key;
+     if( items[i].active ) {
+       ak_mpzn_mul_montgomery( items[i].cpoint.z, items[i].cpoint.z, one,
+                                                       pctx->wc->p, pctx->wc->n, pctx->wc->size );
+       ak_mpzn_mul_montgomery( items[i].cpoint.x, items[i].cpoint.x, items[i].cpoint.z,
+                                                       pctx->wc->p, pctx->wc->n, pctx->wc->size );
+       ak_mpzn_rem( items[i].cpoint.x, items[i].cpoint.x, pctx->wc->q, pctx->wc->size );
+       if( ak_mpzn_cmp( items[i].cpoint.x, items[i].r, pctx->wc->size ) == 0 ) {
+         tasks[i].result = ak_true;
+         continue;
+       }
+     }
+    /* при несовпадении выполняем независимую проверку подписи */
+     tasks[i].result = ak_verifykey_context_verify_hash( pctx, tasks[i].hash,
+                                                                tasks[i].hsize, tasks[i].sign );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока: последовательная проверка еще не распределенных групп подписей.        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_verifykey_context_verify_batch_run( void *ptr )
+{
+  size_t idx = 0;
+  ak_verify_batch batch = ( ak_verify_batch )ptr;
+
+  for( ;; ) {
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+     pthread_mutex_lock( &batch->mutex );
+#endif
+     idx = batch->next;
+     batch->next += ak_verifykey_batch_chunk_size;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+     pthread_mutex_unlock( &batch->mutex );
+#endif
+     if( idx >= batch->count ) break;
+     ak_verifykey_batch_chunk( batch->tasks + idx,
+                                ak_min( ak_verifykey_batch_chunk_size, batch->count - idx ));
+  }
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция проверяет электронные подписи для набора открытых ключей, хеш-кодов и подписей.
+    Результат проверки каждой подписи совпадает с результатом функции
+    ak_verifykey_context_verify_hash() и помещается в поле `result` соответствующего задания.
+
+    Подписи обрабатываются группами по \ref ak_verifykey_batch_chunk_size штук. Для каждой
+    группы обращение хеш-кодов по модулю \f$ q \f$ и приведение вычисленных точек к аффинной
+    форме выполняются с одним возведением в степень для каждой кривой (метод Монтгомери),
+    а кратные точки вычисляются функцией ak_wpoint_pow_double() с общей цепочкой удвоений.
+    Подписи, не прошедшие проверку, повторно проверяются функцией
+    ak_verifykey_context_verify_hash(). Группы распределяются между потоками, количество которых
+    определяется опцией `verify_thread_count`; нулевое значение опции означает количество
+    доступных процессоров.
+
+    Открытые ключи могут быть определены на различных эллиптических кривых.
+
+    @param tasks Массив заданий.
+    @param count Количество заданий в массиве.
+
+    @return Функция возвращает \ref ak_error_ok, если все задания были выполнены, независимо
+    от результатов проверки подписей. В противном случае возвращается код ошибки первого
+    из невыполненных заданий (например, задания с неверной длиной хеш-кода).                      */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_verifykey_context_verify_hash_batch( ak_verify_task tasks, const size_t count )
+{
+  size_t idx = 0;
+  struct verify_batch batch;
+  ak_int64 threads_count = ak_libakrypt_get_option( "verify_thread_count" );
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  size_t running = 0;
+  pthread_t *threads = NULL;
+#endif
+
+  if( tasks == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                               "using null pointer to task array" );
+  if( !count ) return ak_error_message( ak_error_zero_length, __func__ ,
+                                                                  "using empty array of tasks" );
+  for( idx = 0; idx < count; idx++ ) {
+     tasks[idx].result = ak_false;
+     tasks[idx].error = ak_error_undefined_value;
+  }
+  batch.tasks = tasks;
+  batch.count = count;
+  batch.next = 0;
+
+ /* определяем количество потоков */
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  if( threads_count <= 0 ) {
+   #ifdef _SC_NPROCESSORS_ONLN
+    threads_count = ( ak_int64 ) sysconf( _SC_NPROCESSORS_ONLN );
+   #endif
+    if( threads_count <= 0 ) threads_count = 1;
+  }
+#else
+  threads_count = 1;
+#endif
+  threads_count = ( ak_int64 ) ak_min( ( size_t )threads_count,
+                    ( count + ak_verifykey_batch_chunk_size - 1 )/ak_verifykey_batch_chunk_size );
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_init( &batch.mutex, NULL );
+  if( threads_count > 1 ) {
+    if(( threads = calloc(( size_t )threads_count, sizeof( pthread_t ))) == NULL ) {
+      pthread_mutex_destroy( &batch.mutex );
+      return ak_error_message( ak_error_out_of_memory, __func__, "wrong allocation of threads" );
+    }
+    for( idx = 0; idx < ( size_t )threads_count; idx++, running++ )
+       if( pthread_create( threads+idx, NULL, ak_verifykey_context_verify_batch_run, &batch ) != 0 ) {
+         ak_error_message( ak_error_undefined_function, __func__,
+                                                                 "wrong creation of worker thread" );
+         break;
+       }
+   /* группы распределяются динамически, поэтому их проверят уже созданные потоки;
+      если ни один поток не создан, выполняем проверку в текущем потоке */
+    if( !running ) ak_verifykey_context_verify_batch_run( &batch );
+    for( idx = 0; idx < running; idx++ ) pthread_join( threads[idx], NULL );
+    free( threads );
+  } else
+#endif
+  ak_verifykey_context_verify_batch_run( &batch );
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_destroy( &batch.mutex );
+#endif
+
+  for( idx = 0; idx < count; idx++ )
+     if( tasks[idx].error != ak_error_ok )
+       return ak_error_message_fmt( tasks[idx].error, __func__,
+                                   "incorrect signature verification for task %u", (unsigned int) idx );
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param pctx контекст открытого ключа.
     @param in область памяти для которой проверяется электронная подпись.
@@ -122,6 +122,24 @@ extern "C" {
   ak_uint64 flags;
 } *ak_verifykey;
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание на проверку электронной подписи для пакетной функции
+    ak_verifykey_context_verify_hash_batch(). */
+ typedef struct verify_task {
+  /*! \brief Контекст открытого ключа. */
+   ak_verifykey key;
+  /*! \brief Вычисленное заранее значение хеш-функции. */
+   ak_pointer hash;
+  /*! \brief Размер хеш-кода в байтах. */
+   size_t hsize;
+  /*! \brief Проверяемая электронная подпись. */
+   ak_pointer sign;
+  /*! \brief Результат проверки электронной подписи. */
+   bool_t result;
+  /*! \brief Код ошибки, возникшей при выполнении задания. */
+   int error;
+} *ak_verify_task;
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Инициализация контекста открытого ключа асимметричного криптографического алгоритма,
     в частности, алгоритма ГОСТ Р 34.10-2012. */
@@ -142,6 +160,8 @@ extern "C" {
 /*! \brief Проверка электронной подписи для вычисленного заранее значения хеш-функции. */
  bool_t ak_verifykey_context_verify_hash( ak_verifykey , const ak_pointer ,
                                                                        const size_t , ak_pointer );
+/*! \brief Пакетная проверка электронных подписей для вычисленных заранее значений хеш-функции. */
+ int ak_verifykey_context_verify_hash_batch( ak_verify_task , const size_t );
 /*! \brief Проверка электронной подписи для заданной области памяти. */
  bool_t ak_verifykey_context_verify_ptr( ak_verifykey , const ak_pointer ,
                                                                        const size_t , ak_pointer );
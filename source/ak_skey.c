@@ -38,6 +38,11 @@
 #ifdef LIBAKRYPT_HAVE_PTHREAD
  static pthread_mutex_t session_unique_number_mutex = PTHREAD_MUTEX_INITIALIZER;
 #endif
+#if defined( LIBAKRYPT_HAVE_PTHREAD ) && !defined( LIBAKRYPT_HAVE_BUILTIN_ATOMIC )
+/*! \brief Мьютекс, используемый для изменения ресурса ключей в случае, когда компилятор
+    не поддерживает атомарные операции. */
+ static pthread_mutex_t skey_resource_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \details Функция выделяет массив памяти, достаточный для размещения секретного ключа и
@@ -270,6 +275,12 @@
                                                               "using a zero length for key size" );
  /* Инициализируем данные базовыми значениями */
   skey->key = NULL;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_init( &skey->shared.mutex, NULL );
+  pthread_cond_init( &skey->shared.cond, NULL );
+  skey->shared.readers = skey->shared.writers = 0;
+  skey->shared.ready = ak_true;
+#endif
   if(( error = ak_skey_context_alloc_memory( skey, size, malloc_policy )) != ak_error_ok ) {
     ak_error_message( error, __func__ ,"wrong allocation memory of internal secret key buffer" );
     ak_skey_context_destroy( skey );
@@ -279,6 +290,9 @@
   skey->icode = 0; /* контрольная сумма ключа не задана */
   skey->data = NULL; /* внутренние данные ключа не определены */
   memset( &(skey->resource), 0, sizeof( struct resource )); /* ресурс ключа не определен */
+ /* политика смены маски определяется опциями библиотеки */
+  ak_skey_context_set_remask_policy( skey, ak_libakrypt_get_option( "remask_call_count" ),
+     ak_libakrypt_get_option( "remask_block_count" ), ak_libakrypt_get_option( "remask_interval" ));
 
  /* инициализируем генератор масок */
   if(( error = ak_random_context_create_lcg( &skey->generator )) != ak_error_ok ) {
@@ -344,10 +358,19 @@
   }
   skey->oid = NULL;
   skey->flags = ak_key_flag_undefined;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  if( skey->shared.ready == ak_true ) {
+    pthread_cond_destroy( &skey->shared.cond );
+    pthread_mutex_destroy( &skey->shared.mutex );
+  }
+#endif
 
  /* замещаем ключевый данные произвольным мусором */
   memcpy( skey, data, sizeof( data ));
   memset( data, 0, sizeof( data ));
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  skey->shared.ready = ak_false;
+#endif
 
  return ak_error_ok;
 }
@@ -598,6 +621,278 @@
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция проверяет, что ресурс ключа не меньше `value`, и уменьшает его на эту величину.
+    Проверка и уменьшение выполняются атомарно, поэтому функция может вызываться одновременно
+    из нескольких потоков, использующих один ключ.
+
+    \param skey Контекст секретного ключа.
+    \param value Величина, на которую уменьшается ресурс ключа.
+    \return В случае успеха функция возвращает \ref ak_error_ok. Если ресурс ключа недостаточен,
+    то возвращается \ref ak_error_low_key_resource, а значение ресурса не изменяется.              */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_skey_context_decrement_resource( ak_skey skey, const ssize_t value )
+{
+#ifdef LIBAKRYPT_HAVE_BUILTIN_ATOMIC
+  ssize_t counter = 0;
+#endif
+
+  if( skey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                            "using a null pointer to secret key" );
+#ifdef LIBAKRYPT_HAVE_BUILTIN_ATOMIC
+  counter = __atomic_load_n( &skey->resource.value.counter, __ATOMIC_RELAXED );
+  do {
+     if( counter < value ) return ak_error_low_key_resource;
+  } while( !__atomic_compare_exchange_n( &skey->resource.value.counter, &counter,
+                                 counter - value, ak_false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED ));
+#else
+ #ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_lock( &skey_resource_mutex );
+ #endif
+  if( skey->resource.value.counter < value ) {
+   #ifdef LIBAKRYPT_HAVE_PTHREAD
+    pthread_mutex_unlock( &skey_resource_mutex );
+   #endif
+    return ak_error_low_key_resource;
+  }
+  skey->resource.value.counter -= value;
+ #ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_unlock( &skey_resource_mutex );
+ #endif
+#endif
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает текущее время в микросекундах. */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_int64 ak_skey_context_get_time( void )
+{
+#ifdef LIBAKRYPT_HAVE_SYSTIME_H
+  struct timeval tv;
+  gettimeofday( &tv, NULL );
+ return ( ak_int64 )tv.tv_sec*1000000 + ( ak_int64 )tv.tv_usec;
+#else
+ return ( ak_int64 )time( NULL )*1000000;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Значения, установленные по-умолчанию (смена маски после каждого вызова), определяют
+    наиболее строгую политику. Увеличение значений позволяет уменьшить стоимость обработки
+    коротких сообщений, поскольку выработка новой маски выполняется реже.
+
+    \param skey Контекст секретного ключа.
+    \param calls Количество вызовов, после которых маска сменяется. Значение, меньшее единицы,
+    заменяется единицей.
+    \param blocks Количество блоков, после обработки которых маска сменяется
+    (ноль - условие не проверяется).
+    \param interval Интервал времени в микросекундах, после которого маска сменяется
+    (ноль - условие не проверяется).
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае,
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_skey_context_set_remask_policy( ak_skey skey, const ak_int64 calls,
+                                                   const ak_int64 blocks, const ak_int64 interval )
+{
+  if( skey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                            "using a null pointer to secret key" );
+  skey->remask.calls = ak_max( calls, 1 );
+  skey->remask.blocks = ak_max( blocks, 0 );
+  skey->remask.interval = ak_max( interval, 0 );
+  skey->remask.processed_calls = skey->remask.processed_blocks = 0;
+  skey->remask.time = skey->remask.interval ? ak_skey_context_get_time() : 0;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция атомарно увеличивает счетчик политики смены маски и возвращает его новое
+    значение (при нулевом `value` функция возвращает текущее значение счетчика).              */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_int64 ak_skey_context_remask_counter_add( ak_int64 *counter, const ak_int64 value )
+{
+  ak_int64 result = 0;
+#ifdef LIBAKRYPT_HAVE_BUILTIN_ATOMIC
+  result = __atomic_add_fetch( counter, value, __ATOMIC_ACQ_REL );
+#else
+ #ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_lock( &skey_resource_mutex );
+ #endif
+  result = ( *counter += value );
+ #ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_unlock( &skey_resource_mutex );
+ #endif
+#endif
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция атомарно присваивает счетчику политики смены маски значение `value`. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_skey_context_remask_counter_store( ak_int64 *counter, const ak_int64 value )
+{
+#ifdef LIBAKRYPT_HAVE_BUILTIN_ATOMIC
+  __atomic_store_n( counter, value, __ATOMIC_RELEASE );
+#else
+ #ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_lock( &skey_resource_mutex );
+ #endif
+  *counter = value;
+ #ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_unlock( &skey_resource_mutex );
+ #endif
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет, выполнено ли одно из условий смены маски ключа.
+
+    \param skey Контекст секретного ключа.
+    \param calls Количество вызовов, выполненных после последней смены маски.
+    \param blocks Количество блоков, обработанных после последней смены маски.
+    \param now Указатель, по которому помещается текущее время (если оно было определено).
+    \return Функция возвращает \ref ak_true, если маску ключа необходимо сменить.               */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_skey_context_remask_is_due( ak_skey skey, const ak_int64 calls,
+                                                            const ak_int64 blocks, ak_int64 *now )
+{
+  if( calls < skey->remask.calls ) {
+    if(( skey->remask.blocks == 0 ) || ( blocks < skey->remask.blocks )) {
+      if( skey->remask.interval == 0 ) return ak_false;
+      if(( *now = ak_skey_context_get_time()) -
+              ak_skey_context_remask_counter_add( &skey->remask.time, 0 ) < skey->remask.interval )
+        return ak_false;
+    }
+  }
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вызывается после каждого использования ключа и сменяет его маску только в том случае,
+    когда выполнено одно из условий, определенных политикой смены маски ключа.
+
+    \param skey Контекст секретного ключа.
+    \param blocks Количество блоков, обработанных с момента предыдущего вызова функции.
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае,
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_skey_context_remask( ak_skey skey, const ak_int64 blocks )
+{
+  ak_int64 now = 0;
+  int error = ak_error_ok;
+
+  if( skey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                            "using a null pointer to secret key" );
+  skey->remask.processed_calls++;
+  skey->remask.processed_blocks += blocks;
+  if( !ak_skey_context_remask_is_due( skey, skey->remask.processed_calls,
+                                                  skey->remask.processed_blocks, &now ))
+    return ak_error_ok;
+
+ /* одно из условий выполнено: сменяем маску ключа */
+  if(( error = skey->set_mask( skey )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "wrong remasking of secret key" );
+  skey->remask.processed_calls = skey->remask.processed_blocks = 0;
+  if( skey->remask.interval ) skey->remask.time = now ? now : ak_skey_context_get_time();
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция захватывает блокировку совместного использования ключа. Пока блокировка удерживается
+    хотя бы одним потоком, маска ключа не может быть изменена функцией
+    ak_skey_context_remask_shared(). Блокировка принадлежит ключу; если другой поток ожидает
+    смены маски этого ключа, функция дожидается ее завершения.
+
+    \param skey Контекст секретного ключа.                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_skey_context_shared_lock( ak_skey skey )
+{
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_lock( &skey->shared.mutex );
+  while( skey->shared.writers ) pthread_cond_wait( &skey->shared.cond, &skey->shared.mutex );
+  skey->shared.readers++;
+  pthread_mutex_unlock( &skey->shared.mutex );
+#else
+  (void)skey;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param skey Контекст секретного ключа.                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_skey_context_shared_unlock( ak_skey skey )
+{
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_mutex_lock( &skey->shared.mutex );
+  if(( --skey->shared.readers == 0 ) && skey->shared.writers )
+    pthread_cond_broadcast( &skey->shared.cond );
+  pthread_mutex_unlock( &skey->shared.mutex );
+#else
+  (void)skey;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует ту же политику смены маски, что и ak_skey_context_remask(), но может
+    вызываться одновременно из нескольких потоков, использующих один ключ. Счетчики вызовов и
+    блоков изменяются атомарно; смена маски выполняется под блокировкой на запись, то есть
+    только после того, как все потоки освободят блокировку, захваченную функцией
+    ak_skey_context_shared_lock(); новые потоки при этом не получают доступ к ключу. После захвата блокировки условия смены маски проверяются
+    повторно, поэтому маска сменяется однократно, даже если условие было обнаружено
+    несколькими потоками.
+
+    Функция не должна вызываться потоком, удерживающим блокировку совместного использования.
+
+    \param skey Контекст секретного ключа.
+    \param blocks Количество блоков, обработанных с момента предыдущего вызова функции.
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае,
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_skey_context_remask_shared( ak_skey skey, const ak_int64 blocks )
+{
+  ak_int64 now = 0;
+  int error = ak_error_ok;
+
+  if( skey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                            "using a null pointer to secret key" );
+  if( !ak_skey_context_remask_is_due( skey,
+                  ak_skey_context_remask_counter_add( &skey->remask.processed_calls, 1 ),
+                  ak_skey_context_remask_counter_add( &skey->remask.processed_blocks, blocks ), &now ))
+    return ak_error_ok;
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ /* запрещаем новым потокам доступ к ключу и дожидаемся завершения работы остальных;
+    мьютекс удерживается до окончания смены маски */
+  pthread_mutex_lock( &skey->shared.mutex );
+  skey->shared.writers++;
+  while( skey->shared.readers ) pthread_cond_wait( &skey->shared.cond, &skey->shared.mutex );
+  skey->shared.writers--;
+#endif
+ /* другой поток мог сменить маску, пока мы ожидали блокировку */
+  now = 0;
+  if( ak_skey_context_remask_is_due( skey,
+                        ak_skey_context_remask_counter_add( &skey->remask.processed_calls, 0 ),
+                        ak_skey_context_remask_counter_add( &skey->remask.processed_blocks, 0 ), &now )) {
+    if(( error = skey->set_mask( skey )) != ak_error_ok )
+      ak_error_message( error, __func__ , "wrong remasking of secret key" );
+     else {
+      ak_skey_context_remask_counter_store( &skey->remask.processed_calls, 0 );
+      ak_skey_context_remask_counter_store( &skey->remask.processed_blocks, 0 );
+      if( skey->remask.interval ) ak_skey_context_remask_counter_store( &skey->remask.time,
+                                                            now ? now : ak_skey_context_get_time());
+     }
+  }
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_cond_broadcast( &skey->shared.cond );
+  pthread_mutex_unlock( &skey->shared.mutex );
+#endif
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                             функции установки ключевой информации                               */
 /* ----------------------------------------------------------------------------------------------- */
@@ -21,6 +21,9 @@ extern "C" {
 #ifdef LIBAKRYPT_HAVE_STDALIGN_H
  #include <stdalign.h>
 #endif
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ #include <pthread.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Указатель на структуру секретного ключа. */
@@ -71,6 +74,51 @@ extern "C" {
    struct time_interval time;
  } *ak_resource;
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Структура определяет политику смены маски ключа.
+    \details Маска ключа сменяется, если выполнено хотя бы одно из условий: количество вызовов
+    функций, использующих ключ, достигло значения `calls`; количество обработанных блоков достигло
+    значения `blocks`; с момента предыдущей смены маски прошло `interval` микросекунд.
+    Нулевые значения полей `blocks` и `interval` означают, что соответствующее условие
+    не проверяется. */
+ typedef struct remask_policy {
+  /*! \brief Количество вызовов, после которых маска сменяется (не менее единицы). */
+   ak_int64 calls;
+  /*! \brief Количество блоков, после обработки которых маска сменяется. */
+   ak_int64 blocks;
+  /*! \brief Интервал времени (в микросекундах), после которого маска сменяется. */
+   ak_int64 interval;
+  /*! \brief Количество вызовов, выполненных после последней смены маски. */
+   ak_int64 processed_calls;
+  /*! \brief Количество блоков, обработанных после последней смены маски. */
+   ak_int64 processed_blocks;
+  /*! \brief Время последней смены маски (в микросекундах). */
+   ak_int64 time;
+} *ak_remask_policy;
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Блокировка совместного использования ключа несколькими потоками.
+
+    Потоки, использующие ключ, захватывают блокировку совместно; смена маски выполняется
+    при исключительном владении ключом. Блокировка отдает предпочтение смене маски: пока
+    имеется поток, ожидающий смены маски, новые потоки не получают доступ к ключу. */
+ typedef struct skey_shared_lock {
+  /*! \brief Мьютекс, защищающий поля блокировки. */
+   pthread_mutex_t mutex;
+  /*! \brief Условная переменная, на которой ожидаются изменения состояния блокировки. */
+   pthread_cond_t cond;
+  /*! \brief Количество потоков, использующих ключ. */
+   size_t readers;
+  /*! \brief Количество потоков, ожидающих смены маски. */
+   size_t writers;
+  /*! \brief Признак выполняющейся смены маски. */
+   bool_t writer;
+  /*! \brief Признак того, что блокировка инициализирована. */
+   bool_t ready;
+} *ak_skey_shared_lock;
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Перечисление, определяющее флаги хранения и обработки секретных ключей. */
  typedef ak_uint64 key_flags_t;
@@ -102,6 +150,10 @@ extern "C" {
 /*! \brief Флаг, который определяет, можно ли использовать значение внутреннего буффера в режиме omac. */
  #define ak_key_flag_omac_buffer_used   (0x0000000000000200ULL)
 
+/*! \brief Флаг, который определяет, вычислены ли для ключа алгоритма HMAC состояния функции
+    хеширования после обработки блоков ipad и opad. */
+ #define ak_key_flag_hmac_pads_set      (0x0000000000000400ULL)
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Способ выделения памяти для хранения секретной информации. */
  typedef enum {
@@ -153,6 +205,12 @@ extern "C" {
    struct random generator;
   /*! \brief ресурс использования ключа */
    struct resource resource;
+  /*! \brief политика смены маски ключа */
+   struct remask_policy remask;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  /*! \brief блокировка совместного использования ключа несколькими потоками */
+   struct skey_shared_lock shared;
+#endif
   /*! \brief указатель на внутренние данные ключа */
    ak_pointer data;
  /*! \brief Флаги текущего состояния ключа */
@@ -211,6 +269,18 @@ extern "C" {
 /*! \brief Функция устанавливает ресурс и временной итервал действия ключа. */
  int ak_skey_context_set_resource_values( ak_skey ,
                                              counter_resource_t , const char * , time_t , time_t );
+/*! \brief Функция атомарно уменьшает ресурс ключа на заданную величину. */
+ int ak_skey_context_decrement_resource( ak_skey , const ssize_t );
+/*! \brief Функция устанавливает политику смены маски ключа. */
+ int ak_skey_context_set_remask_policy( ak_skey , const ak_int64 , const ak_int64 , const ak_int64 );
+/*! \brief Смена маски ключа в соответствии с установленной политикой. */
+ int ak_skey_context_remask( ak_skey , const ak_int64 );
+/*! \brief Захват блокировки совместного использования ключа несколькими потоками. */
+ void ak_skey_context_shared_lock( ak_skey );
+/*! \brief Освобождение блокировки совместного использования ключа. */
+ void ak_skey_context_shared_unlock( ak_skey );
+/*! \brief Смена маски ключа, одновременно используемого несколькими потоками. */
+ int ak_skey_context_remask_shared( ak_skey , const ak_int64 );
 
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef LIBAKRYPT_HAVE_DEBUG_FUNCTIONS
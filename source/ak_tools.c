@@ -11,6 +11,10 @@
  #ifndef _POSIX_C_SOURCE
    #define _POSIX_C_SOURCE 2
  #endif
+/* а это - для использования функций pread() и posix_fadvise() */
+ #ifndef _XOPEN_SOURCE
+   #define _XOPEN_SOURCE 600
+ #endif
 #endif
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -138,6 +142,38 @@
      { "acpkm_section_magma_block_count", 128, 128, 16777216 },
      { "acpkm_section_kuznechik_block_count", 512, 512, 16777216 },
 
+  /* количество потоков, используемых в многопоточной реализации режима гаммирования
+                                          (нулевое значение - количество доступных процессоров) */
+     { "ctr_thread_count", 0, 0, 256 },
+
+  /* количество потоков, используемых при древовидном хешировании данных
+                                          (нулевое значение - количество доступных процессоров) */
+     { "hash_thread_count", 0, 0, 256 },
+
+  /* количество потоков, используемых при пакетной выработке ключей из паролей
+                                          (нулевое значение - количество доступных процессоров) */
+     { "pbkdf2_thread_count", 0, 0, 256 },
+
+  /* количество потоков, используемых при пакетной проверке электронной подписи
+                                          (нулевое значение - количество доступных процессоров) */
+     { "verify_thread_count", 0, 0, 256 },
+
+  /* минимальная длина файла (в октетах), при которой файл отображается в память
+                             при вычислении хеш-кодов и имитовставок (ноль - не использовать) */
+     { "mmap_file_threshold", 0, 0, 1099511627776 },
+
+  /* размер буффера (в октетах) и количество буфферов, используемых для чтения файлов;
+                       при количестве буфферов больше одного чтение выполняется отдельным потоком */
+     { "file_buffer_size", 65536, 4096, 16777216 },
+     { "file_buffers_count", 4, 1, 64 },
+
+  /* политика смены маски ключей алгоритмов блочного шифрования: маска сменяется после заданного
+     количества вызовов, обработанных блоков или микросекунд (нулевые значения двух последних
+                  опций отключают соответствующее условие, значение 1 первой - самая строгая политика) */
+     { "remask_call_count", 1, 1, 2147483648 },
+     { "remask_block_count", 0, 0, 2147483648 },
+     { "remask_interval", 0, 0, 3600000000 },
+
   /* при значении равным единицы, формат шифрования данных соответствует варианту OpenSSL */
      { "openssl_compability", 0, 0, 1 },
   /* флаг использования цвета при выводе сообщений библиотеки */
@@ -768,6 +804,241 @@
  #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция считывает данные, начиная с заданного смещения от начала файла, и не изменяет
+    текущую позицию файла. Поэтому функция может одновременно вызываться из нескольких потоков,
+    использующих один и тот же дескриптор файла.
+
+    @param file Дескриптор открытого на чтение файла.
+    @param buffer Область памяти, в которую помещаются считанные данные.
+    @param size Количество считываемых байт.
+    @param offset Смещение (в байтах) от начала файла.
+    @return Функция возвращает количество считанных байт или отрицательное значение
+    в случае ошибки.                                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ ssize_t ak_file_read_offset( ak_file file, ak_pointer buffer, size_t size, ak_int64 offset )
+{
+ #ifdef LIBAKRYPT_HAVE_WINDOWS_H
+  DWORD dwBytesReaden = 0;
+  OVERLAPPED ov;
+
+  memset( &ov, 0, sizeof( OVERLAPPED ));
+  ov.Offset = ( DWORD )( offset&0xFFFFFFFF );
+  ov.OffsetHigh = ( DWORD )( offset >> 32 );
+  if( ReadFile( file->hFile, buffer, ( DWORD )size,  &dwBytesReaden, &ov ) == FALSE ) {
+    ak_error_message( ak_error_read_data, __func__, "unable to read from file");
+    return -1;
+  } else return ( ssize_t ) dwBytesReaden;
+ #else
+  return pread( file->fd, buffer, size, ( off_t )offset );
+ #endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция считывает из файла данные до заполнения буффера или до достижения конца файла.
+    \return Функция возвращает количество считанных байт или отрицательное значение
+    в случае ошибки.                                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static ssize_t ak_file_read_full( ak_file file, ak_uint8 *buffer, size_t size )
+{
+  ssize_t len = 0, total = 0;
+
+  while( total < ( ssize_t )size ) {
+    if(( len = ak_file_read( file, buffer + total, size - ( size_t )total )) < 0 ) return len;
+    if( len == 0 ) break;
+    total += len;
+  }
+ return total;
+}
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Кольцо буфферов, заполняемых потоком чтения и освобождаемых потоком обработки. */
+ typedef struct file_ring {
+  /*! \brief Считываемый файл. */
+   ak_file file;
+  /*! \brief Массив буфферов. */
+   ak_uint8 **buffers;
+  /*! \brief Количество данных, помещенных в каждый из буфферов. */
+   ssize_t *lengths;
+  /*! \brief Количество буфферов. */
+   size_t count;
+  /*! \brief Размер каждого буффера (в октетах). */
+   size_t size;
+  /*! \brief Номер буффера, заполняемого следующим. */
+   size_t head;
+  /*! \brief Количество заполненных, но еще не обработанных буфферов. */
+   size_t filled;
+  /*! \brief Флаг досрочного завершения чтения. */
+   bool_t stop;
+  /*! \brief Мьютекс, защищающий поля head, filled и stop. */
+   pthread_mutex_t mutex;
+  /*! \brief Условие появления заполненного буффера. */
+   pthread_cond_t not_empty;
+  /*! \brief Условие появления свободного буффера. */
+   pthread_cond_t not_full;
+ } *ak_file_ring;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока чтения: заполнение свободных буфферов кольца. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_file_ring_reader( void *ptr )
+{
+  size_t idx = 0;
+  ssize_t len = 0;
+  ak_file_ring ring = ( ak_file_ring )ptr;
+
+  do{
+      pthread_mutex_lock( &ring->mutex );
+      while(( ring->filled == ring->count ) && !ring->stop )
+        pthread_cond_wait( &ring->not_full, &ring->mutex );
+      if( ring->stop ) {
+        pthread_mutex_unlock( &ring->mutex );
+        break;
+      }
+      idx = ring->head;
+      pthread_mutex_unlock( &ring->mutex );
+
+     /* чтение выполняется без блокировки: буффер idx принадлежит потоку чтения */
+      len = ak_file_read_full( ring->file, ring->buffers[idx], ring->size );
+
+      pthread_mutex_lock( &ring->mutex );
+      ring->lengths[idx] = len;
+      ring->head = ( idx + 1 )%ring->count;
+      ring->filled++;
+      pthread_cond_signal( &ring->not_empty );
+      pthread_mutex_unlock( &ring->mutex );
+  } while( len == ( ssize_t )ring->size );
+
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обработка файла с одновременным чтением следующих фрагментов в отдельном потоке. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_file_process_pipelined( ak_file file, ak_function_file_process *function,
+                                    ak_pointer ctx, const size_t count, const size_t size )
+{
+  size_t i = 0, tail = 0;
+  ssize_t len = 0;
+  pthread_t reader;
+  struct file_ring ring;
+  int error = ak_error_ok;
+
+  memset( &ring, 0, sizeof( struct file_ring ));
+  ring.file = file;
+  ring.count = count;
+  ring.size = size;
+  if((( ring.buffers = calloc( count, sizeof( ak_uint8 * ))) == NULL ) ||
+     (( ring.lengths = calloc( count, sizeof( ssize_t ))) == NULL )) {
+    error = ak_error_message( ak_error_out_of_memory, __func__, "wrong allocation of file ring" );
+    goto lexit;
+  }
+  for( i = 0; i < count; i++ )
+     if(( ring.buffers[i] = ak_libakrypt_aligned_malloc( size )) == NULL ) {
+       error = ak_error_message( ak_error_out_of_memory, __func__,
+                                                        "wrong allocation of file ring buffer" );
+       goto lexit;
+     }
+  pthread_mutex_init( &ring.mutex, NULL );
+  pthread_cond_init( &ring.not_empty, NULL );
+  pthread_cond_init( &ring.not_full, NULL );
+  if( pthread_create( &reader, NULL, ak_file_ring_reader, &ring ) != 0 ) {
+    error = ak_error_message( ak_error_undefined_function, __func__,
+                                                                "wrong creation of reader thread" );
+    goto ldestroy;
+  }
+
+ /* обрабатываем буфферы в порядке их заполнения */
+  do{
+      pthread_mutex_lock( &ring.mutex );
+      while( ring.filled == 0 ) pthread_cond_wait( &ring.not_empty, &ring.mutex );
+      len = ring.lengths[tail];
+      pthread_mutex_unlock( &ring.mutex );
+
+      if( len < 0 ) error = ak_error_message( ak_error_read_data, __func__,
+                                                                   "unable to read from file" );
+       else if( len > 0 ) error = function( ctx, ring.buffers[tail], ( size_t )len );
+
+      pthread_mutex_lock( &ring.mutex );
+      tail = ( tail + 1 )%ring.count;
+      ring.filled--;
+      if( error != ak_error_ok ) ring.stop = ak_true;
+      pthread_cond_signal( &ring.not_full );
+      pthread_mutex_unlock( &ring.mutex );
+  } while(( error == ak_error_ok ) && ( len == ( ssize_t )ring.size ));
+  pthread_join( reader, NULL );
+
+  ldestroy:
+   pthread_cond_destroy( &ring.not_full );
+   pthread_cond_destroy( &ring.not_empty );
+   pthread_mutex_destroy( &ring.mutex );
+  lexit:
+   if( ring.buffers != NULL ) {
+     for( i = 0; i < count; i++ )
+        if( ring.buffers[i] != NULL ) {
+          memset( ring.buffers[i], 0, size );
+          free( ring.buffers[i] );
+        }
+     free( ring.buffers );
+   }
+   if( ring.lengths != NULL ) free( ring.lengths );
+ return error;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция последовательно считывает файл фрагментами длины `file_buffer_size` октетов
+    (последний фрагмент может быть короче) и передает каждый фрагмент функции обработки.
+    Если значение опции `file_buffers_count` больше единицы, то чтение выполняется отдельным
+    потоком, заполняющим кольцо из `file_buffers_count` буфферов: пока обрабатывается
+    очередной фрагмент, следующие фрагменты уже считываются с диска.
+
+    @param file Дескриптор открытого на чтение файла.
+    @param function Функция обработки считанных фрагментов.
+    @param ctx Указатель, передаваемый функции обработки первым аргументом.
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки (в том числе код ошибки, возвращенный функцией обработки).            */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_file_process( ak_file file, ak_function_file_process *function, ak_pointer ctx )
+{
+  ssize_t len = 0;
+  ak_uint8 *buffer = NULL;
+  int error = ak_error_ok;
+  size_t count = ( size_t ) ak_libakrypt_get_option( "file_buffers_count" ),
+         size = ( size_t ) ak_libakrypt_get_option( "file_buffer_size" );
+
+  if( file == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                              "using null pointer to file context" );
+  if( function == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to process function" );
+  size = ak_max( size, ( size_t )file->blksize );
+ #if defined(POSIX_FADV_SEQUENTIAL) && !defined(LIBAKRYPT_HAVE_WINDOWS_H)
+  posix_fadvise( file->fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+ #endif
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  if(( count > 1 ) && ( file->size > ( ak_int64 )size ))
+    return ak_file_process_pipelined( file, function, ctx, count, size );
+#endif
+
+ /* последовательное чтение и обработка с использованием одного буффера */
+  if(( buffer = ak_libakrypt_aligned_malloc( size )) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                                      "memory allocation error for local buffer" );
+  do{
+      if(( len = ak_file_read_full( file, buffer, size )) < 0 ) {
+        error = ak_error_message( ak_error_read_data, __func__, "unable to read from file" );
+        break;
+      }
+      if( len > 0 ) error = function( ctx, buffer, ( size_t )len );
+  } while(( error == ak_error_ok ) && ( len == ( ssize_t )size ));
+
+  memset( buffer, 0, size );
+  free( buffer );
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  ssize_t ak_file_write( ak_file file, ak_const_pointer buffer, size_t size )
 {
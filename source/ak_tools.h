@@ -35,6 +35,10 @@ extern "C" {
   ak_int64 blksize;
  } *ak_file;
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обработки очередного фрагмента данных, считанного из файла. */
+ typedef int ( ak_function_file_process )( ak_pointer , const ak_pointer , const size_t );
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция выделения динамической памяти. */
  ak_pointer ak_libakrypt_aligned_malloc( size_t );
@@ -56,6 +60,10 @@ extern "C" {
  int ak_file_close( ak_file );
 /*! \brief Функция считывает заданное количество байт из файла. */
  ssize_t ak_file_read( ak_file , ak_pointer , size_t );
+/*! \brief Функция считывает заданное количество байт, начиная с заданного смещения от начала файла. */
+ ssize_t ak_file_read_offset( ak_file , ak_pointer , size_t , ak_int64 );
+/*! \brief Функция последовательно считывает файл и передает считанные фрагменты функции обработки. */
+ int ak_file_process( ak_file , ak_function_file_process * , ak_pointer );
 /*! \brief Функция записывает заданное количество байт в файл. */
  ssize_t ak_file_write( ak_file , ak_const_pointer , size_t );
 
@@ -0,0 +1,111 @@
+/* Тестовый пример иллюстрирует применение режима шифрования CTR-ACPKM для зашифрования
+   объема данных, превышающего ресурс одного ключа алгоритма Кузнечик. Кроме того, проверяется,
+   что создание рабочей копии ключа не изменяет исходный ключ.
+   Внимание! Используются не экспортируемые функции.
+
+   test-bckey05.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <ak_bckey.h>
+ #include <ak_tools.h>
+
+ static bool_t test_copy( ak_function_bckey_create *create, ak_uint8 *testkey )
+{
+  struct bckey key, work;
+  ak_uint8 stored[64], in[16] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x00,
+                                  0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 }, out[16], res[16];
+  bool_t result = ak_false;
+
+  create( &key );
+  ak_bckey_context_set_key( &key, testkey, 32 );
+  memcpy( stored, key.key.key, 2*key.key.key_size );
+  if( ak_bckey_context_create_and_set_bckey( &work, &key ) != ak_error_ok ) goto lab;
+
+  key.encrypt( &key.key, in, out );
+  work.encrypt( &work.key, in, res );
+  result = ( memcmp( out, res, key.bsize ) == 0 ) &&
+           ( memcmp( stored, key.key.key, 2*key.key.key_size ) == 0 ) &&
+           ( memcmp( stored, work.key.key, 2*key.key.key_size ) != 0 ) &&
+           ( work.key.check_icode( &work.key ) == ak_true );
+  ak_bckey_context_destroy( &work );
+  lab:
+   ak_bckey_context_destroy( &key );
+ return result;
+}
+
+ int main( void )
+{
+  size_t i, offset, len;
+  struct bckey key, work;
+  int error, result = EXIT_FAILURE;
+  ak_uint8 *data = NULL, *buffer = NULL, iv[8] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xce, 0xf0 };
+ /* объем данных (40 Мб) превышает ресурс ключа алгоритма Кузнечик, равный 32 Мб */
+  size_t size = 40*1024*1024 + 7;
+
+  ak_uint8 testkey[32] = {
+    0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+    0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ /* инициализируем библиотеку */
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+
+  if(( data = malloc( size )) == NULL ) goto exlab;
+  if(( buffer = malloc( size )) == NULL ) goto exlab;
+  for( i = 0; i < size; i++ ) data[i] = ( ak_uint8 )( i*7 + ( i >> 11 ));
+
+ /* 0. копирование ключа не изменяет маскированное значение исходного ключа */
+  if( !test_copy( ak_bckey_context_create_magma, testkey ) ||
+      !test_copy( ak_bckey_context_create_kuznechik, testkey )) {
+    printf("wrong copy of secret key\n");
+    goto exlab;
+  }
+  printf("copy of secret key is Ok\n");
+
+ /* создаем ключ */
+  ak_bckey_context_create_kuznechik( &key );
+  ak_bckey_context_set_key( &key, testkey, sizeof( testkey ));
+
+ /* 1. обычный режим гаммирования не может зашифровать такой объем данных */
+  ak_bckey_context_create_and_set_bckey( &work, &key );
+  error = ak_bckey_context_ctr( &work, data, buffer, size, iv, sizeof( iv ));
+  ak_bckey_context_destroy( &work );
+  printf("ctr mode for %u bytes: %s\n", (unsigned int)size,
+                                        error == ak_error_low_key_resource ? "rejected" : "accepted" );
+  if( error != ak_error_low_key_resource ) goto lab;
+
+ /* 2. зашифровываем данные за один вызов на рабочей копии ключа */
+  ak_bckey_context_create_and_set_bckey( &work, &key );
+  error = ak_bckey_context_ctr_acpkm( &work, data, buffer, size, 0, iv, sizeof( iv ));
+  ak_bckey_context_destroy( &work );
+  printf("ctr-acpkm encryption of %u bytes: %s\n", (unsigned int)size,
+                                                     error == ak_error_ok ? "Ok" : "Wrong" );
+  if( error != ak_error_ok ) goto lab;
+
+ /* 3. расшифровываем данные фрагментами, границы которых не совпадают с границами секций */
+  ak_bckey_context_create_and_set_bckey( &work, &key );
+  for( offset = 0, i = 0; offset < size; offset += len, i++ ) {
+     len = ak_min( size - offset, 16*( 1 + ( i*131 )%4099 ));
+     if(( error = ak_bckey_context_ctr_acpkm( &work, buffer+offset, buffer+offset, len, 0,
+                         offset ? NULL : iv, offset ? 0 : sizeof( iv ))) != ak_error_ok ) break;
+  }
+  ak_bckey_context_destroy( &work );
+  printf("ctr-acpkm decryption in %u fragments: %s\n", (unsigned int)i,
+                                                     error == ak_error_ok ? "Ok" : "Wrong" );
+  if( error != ak_error_ok ) goto lab;
+
+  if( memcmp( data, buffer, size ) == 0 ) {
+    printf("decrypted data is equal to plain data\n");
+    result = EXIT_SUCCESS;
+  } else printf("decrypted data is not equal to plain data\n");
+
+  lab:
+   ak_bckey_context_destroy( &key );
+  exlab:
+   if( data != NULL ) free( data );
+   if( buffer != NULL ) free( buffer );
+   ak_libakrypt_destroy();
+
+ return result;
+}
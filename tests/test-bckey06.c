@@ -0,0 +1,83 @@
+/* Тестовый пример проверяет совпадение результатов многопоточной и последовательной
+   реализаций режима гаммирования, а также одинаковое изменение ресурса ключа и синхропосылки.
+   Внимание! Используются не экспортируемые функции.
+
+   test-bckey06.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <ak_bckey.h>
+ #include <ak_tools.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int test_ctr_parallel( ak_function_bckey_create *create, const char *name,
+                                         ak_uint8 *in, ak_uint8 *out1, ak_uint8 *out2, size_t size )
+{
+  size_t first = ( size/3 )&( ~( size_t )63 );
+  struct bckey serial, parallel;
+  int result = EXIT_FAILURE;
+  ak_uint8 key[32], iv[8] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xce, 0xf0 };
+
+  memset( key, 0x37, sizeof( key ));
+  create( &serial ); ak_bckey_context_set_key( &serial, key, sizeof( key ));
+  create( &parallel ); ak_bckey_context_set_key( &parallel, key, sizeof( key ));
+
+ /* данные обрабатываются двумя фрагментами: второй вызов продолжает счетчик
+    и завершается неполным блоком */
+  ak_bckey_context_ctr( &serial, in, out1, first, iv, sizeof( iv ));
+  ak_bckey_context_ctr( &serial, in+first, out1+first, size-first, NULL, 0 );
+  if( ak_bckey_context_ctr_parallel( &parallel, in, out2, first, iv, sizeof( iv )) != ak_error_ok )
+    goto lexit;
+  if( ak_bckey_context_ctr_parallel( &parallel, in+first, out2+first,
+                                                        size-first, NULL, 0 ) != ak_error_ok ) goto lexit;
+
+  if( memcmp( out1, out2, size ) != 0 ) {
+    printf("%s: parallel ctr result differs from serial one\n", name );
+    goto lexit;
+  }
+  if( serial.key.resource.value.counter != parallel.key.resource.value.counter ) {
+    printf("%s: wrong key resource after parallel ctr\n", name );
+    goto lexit;
+  }
+  if(( parallel.key.flags&ak_key_flag_not_ctr ) == 0 ) {
+    printf("%s: continuation must be disabled after a partial block\n", name );
+    goto lexit;
+  }
+  printf("%s: parallel ctr for %u bytes is Ok\n", name, (unsigned int) size );
+  result = EXIT_SUCCESS;
+
+  lexit:
+   ak_bckey_context_destroy( &serial );
+   ak_bckey_context_destroy( &parallel );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i, size = 3*1048576 + 11;
+  int result = EXIT_FAILURE;
+  ak_uint8 *in = NULL, *out1 = NULL, *out2 = NULL;
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+ /* используем фиксированное количество потоков, не зависящее от количества процессоров */
+  ak_libakrypt_set_option( "ctr_thread_count", 4 );
+
+  if(( in = malloc( size )) == NULL ) goto exlab;
+  if(( out1 = malloc( size )) == NULL ) goto exlab;
+  if(( out2 = malloc( size )) == NULL ) goto exlab;
+  for( i = 0; i < size; i++ ) in[i] = ( ak_uint8 )( i*13 + 5 );
+
+  if(( result = test_ctr_parallel( ak_bckey_context_create_kuznechik,
+                                         "kuznechik", in, out1, out2, size )) == EXIT_SUCCESS )
+    result = test_ctr_parallel( ak_bckey_context_create_magma, "magma", in, out1, out2, size );
+
+  exlab:
+   if( in != NULL ) free( in );
+   if( out1 != NULL ) free( out1 );
+   if( out2 != NULL ) free( out2 );
+   ak_libakrypt_destroy();
+
+ return result;
+}
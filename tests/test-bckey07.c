@@ -0,0 +1,80 @@
+/* Тестовый пример иллюстрирует расшифрование произвольных фрагментов сообщения,
+   зашифрованного в режиме гаммирования, без обработки предшествующих им данных.
+   Внимание! Используются не экспортируемые функции.
+
+   test-bckey07.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <ak_bckey.h>
+ #include <ak_tools.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int test_ctr_offset( ak_function_bckey_create *create, const char *name, const int oc )
+{
+  struct bckey key;
+  size_t i, offset, end, size = 1021;
+  int error = ak_error_ok, result = EXIT_FAILURE;
+  ak_uint8 in[1021], out[1021], buffer[1021], key32[32],
+           iv[8] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xce, 0xf0 };
+
+  memset( key32, 0x37, sizeof( key32 ));
+  for( i = 0; i < size; i++ ) in[i] = ( ak_uint8 )( i*13 + 5 );
+  ak_libakrypt_set_option( "openssl_compability", oc );
+  create( &key );
+  ak_bckey_context_set_key( &key, key32, sizeof( key32 ));
+  ak_bckey_context_ctr( &key, in, out, size, iv, sizeof( iv ));
+
+ /* 1. фрагменты, заканчивающиеся в конце сообщения */
+  for( offset = 0; offset < size; offset += 7 ) {
+     memset( buffer, 0, size );
+     if(( error = ak_bckey_context_ctr_offset( &key, out+offset, buffer, size-offset,
+                                           offset, iv, sizeof( iv ))) != ak_error_ok ) goto lexit;
+     if( memcmp( buffer, in+offset, size-offset ) != 0 ) {
+       printf("%s (oc: %d): wrong decryption of tail fragment from %u\n",
+                                                             name, oc, (unsigned int) offset );
+       goto lexit;
+     }
+  }
+
+ /* 2. фрагменты, заканчивающиеся на границе блока, с последующим продолжением */
+  for( offset = 1; offset + 3*key.bsize < size; offset += 5 ) {
+     end = ( offset/key.bsize + 2 )*key.bsize;
+     memset( buffer, 0, size );
+     if(( error = ak_bckey_context_ctr_offset( &key, out+offset, buffer, end-offset,
+                                           offset, iv, sizeof( iv ))) != ak_error_ok ) goto lexit;
+     if(( error = ak_bckey_context_ctr( &key, out+end, buffer+end-offset,
+                                                           size-end, NULL, 0 )) != ak_error_ok )
+       goto lexit;
+     if( memcmp( buffer, in+offset, size-offset ) != 0 ) {
+       printf("%s (oc: %d): wrong decryption of inner fragment from %u\n",
+                                                             name, oc, (unsigned int) offset );
+       goto lexit;
+     }
+  }
+  printf("%s (oc: %d): ctr mode with offsets is Ok\n", name, oc );
+  result = EXIT_SUCCESS;
+
+  lexit:
+   if( error != ak_error_ok ) printf("%s (oc: %d): error %d\n", name, oc, error );
+   ak_bckey_context_destroy( &key );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  int oc, result = EXIT_SUCCESS;
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  for( oc = 0; oc < 2; oc++ ) {
+     if( test_ctr_offset( ak_bckey_context_create_kuznechik, "kuznechik", oc ) != EXIT_SUCCESS )
+       result = EXIT_FAILURE;
+     if( test_ctr_offset( ak_bckey_context_create_magma, "magma", oc ) != EXIT_SUCCESS )
+       result = EXIT_FAILURE;
+  }
+  ak_libakrypt_destroy();
+
+ return result;
+}
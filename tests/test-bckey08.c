@@ -0,0 +1,139 @@
+/* Тестовый пример иллюстрирует одновременное использование одного ключа в нескольких потоках,
+   каждый из которых владеет собственным контекстом режима гаммирования.
+   Данные обрабатываются фрагментами, содержащими нечетное количество блоков,
+   с выключенной и включенной опцией openssl_compability. В ходе обработки маска ключа
+   сменяется в соответствии с политикой смены маски.
+   Внимание! Используются не экспортируемые функции.
+
+   test-bckey08.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <ak_bckey.h>
+ #include <ak_tools.h>
+
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+ #include <pthread.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define threads_count  ( 4 )
+ #define message_size   ( 65536 + 5 )
+ #define chunk_blocks   ( 517 )
+
+ typedef struct stream {
+   ak_bckey key;
+   ak_uint8 iv[8];
+   ak_uint8 *in, *out;
+   int error;
+ } *ak_stream;
+
+/* ----------------------------------------------------------------------------------------------- */
+/* каждый поток зашифровывает свое сообщение фрагментами из chunk_blocks блоков */
+ static void *encrypt_stream( void *ptr )
+{
+  size_t offset, len;
+  struct ctr_ctx ctx;
+  ak_stream st = ( ak_stream )ptr;
+
+  if(( st->error = ak_ctr_context_clean( &ctx, st->key, st->iv, sizeof( st->iv ))) != ak_error_ok )
+    return NULL;
+  for( offset = 0; offset < message_size; offset += len ) {
+     len = ak_min( message_size - offset, chunk_blocks*st->key->bsize );
+     if(( st->error = ak_ctr_context_update( &ctx, st->key,
+                                     st->in+offset, st->out+offset, len )) != ak_error_ok ) break;
+  }
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int test_shared_key( ak_function_bckey_create *create, const char *name, const int oc )
+{
+  size_t i, j;
+  ssize_t resource;
+  struct bckey key, check;
+  struct stream streams[threads_count];
+  int result = EXIT_FAILURE;
+  ak_uint8 key32[32], mask[32], *buffer = NULL;
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  pthread_t threads[threads_count];
+#endif
+
+  ak_libakrypt_set_option( "openssl_compability", oc );
+  memset( key32, 0x21, sizeof( key32 ));
+  memset( streams, 0, sizeof( streams ));
+  create( &key ); ak_bckey_context_set_key( &key, key32, sizeof( key32 ));
+  create( &check ); ak_bckey_context_set_key( &check, key32, sizeof( key32 ));
+  resource = key.key.resource.value.counter;
+  ak_skey_context_set_remask_policy( &key.key, 3, 0, 0 );
+  memcpy( mask, key.key.key + key.key.key_size, key.key.key_size );
+
+  if(( buffer = malloc( 3*threads_count*message_size )) == NULL ) goto lexit;
+  for( i = 0; i < threads_count; i++ ) {
+     streams[i].key = &key;
+     streams[i].in = buffer + 3*i*message_size;
+     streams[i].out = streams[i].in + message_size;
+     for( j = 0; j < sizeof( streams[i].iv ); j++ ) streams[i].iv[j] = ( ak_uint8 )( i*17 + j );
+     for( j = 0; j < message_size; j++ ) streams[i].in[j] = ( ak_uint8 )( i + j*7 );
+  }
+
+ /* запускаем потоки, использующие один ключ */
+#ifdef LIBAKRYPT_HAVE_PTHREAD
+  for( i = 0; i < threads_count; i++ )
+     pthread_create( threads+i, NULL, encrypt_stream, streams+i );
+  for( i = 0; i < threads_count; i++ ) pthread_join( threads[i], NULL );
+#else
+  for( i = 0; i < threads_count; i++ ) encrypt_stream( streams+i );
+#endif
+
+ /* сравниваем с результатом последовательного зашифрования */
+  for( i = 0; i < threads_count; i++ ) {
+     ak_uint8 *out = streams[i].out + message_size;
+     if( streams[i].error != ak_error_ok ) {
+       printf("%s: stream %u returns error %d\n", name, (unsigned int) i, streams[i].error );
+       goto lexit;
+     }
+     ak_bckey_context_ctr( &check, streams[i].in, out, message_size, streams[i].iv, 8 );
+     if( memcmp( out, streams[i].out, message_size ) != 0 ) {
+       printf("%s: stream %u is wrong\n", name, (unsigned int) i );
+       goto lexit;
+     }
+  }
+  if(( size_t )( resource - key.key.resource.value.counter ) !=
+                        threads_count*(( message_size + key.bsize - 1 )/key.bsize )) {
+    printf("%s: wrong key resource\n", name );
+    goto lexit;
+  }
+  if(( memcmp( mask, key.key.key + key.key.key_size, key.key.key_size ) == 0 ) ||
+                                                  ( key.key.check_icode( &key.key ) != ak_true )) {
+    printf("%s: wrong remasking of shared key\n", name );
+    goto lexit;
+  }
+  printf("%s (oc: %d): %d streams with one shared key is Ok\n", name, oc, threads_count );
+  result = EXIT_SUCCESS;
+
+  lexit:
+   if( buffer != NULL ) free( buffer );
+   ak_bckey_context_destroy( &key );
+   ak_bckey_context_destroy( &check );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  int oc, result = EXIT_FAILURE;
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  for( oc = 0; oc < 2; oc++ ) {
+     if(( result = test_shared_key( ak_bckey_context_create_kuznechik,
+                                                        "kuznechik", oc )) != EXIT_SUCCESS ) break;
+     if(( result = test_shared_key( ak_bckey_context_create_magma,
+                                                            "magma", oc )) != EXIT_SUCCESS ) break;
+  }
+  ak_libakrypt_set_option( "openssl_compability", 0 );
+  ak_libakrypt_destroy();
+
+ return result;
+}
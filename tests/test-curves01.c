@@ -0,0 +1,121 @@
+/* Тестовый пример проверяет совпадение кратных образующей точки, вычисленных методом гребенки
+   (функция ak_wpoint_pow_base()) и функцией ak_wpoint_pow(), для всех эллиптических кривых,
+   в том числе для значений множителя, содержащих нулевые цифры гребенки. Для кривых, имеющих
+   форму скрученной кривой Эдвардса, дополнительно проверяется, что сумма образующей точки и
+   точки второго порядка не проходит проверку порядка.
+   Внимание! Используются не экспортируемые функции.
+
+   test-curves01.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <ak_oid.h>
+ #include <ak_curves.h>
+ #include <ak_random.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define random_count  ( 8 )
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t test_point( ak_wcurve ec, ak_uint64 *k )
+{
+  struct wpoint wp, wq;
+
+  ak_wpoint_pow_base( &wp, k, ec->size, ec );
+  ak_wpoint_pow( &wq, &ec->point, k, ec->size, ec );
+  ak_wpoint_reduce( &wp, ec );
+  ak_wpoint_reduce( &wq, ec );
+  if( ak_mpzn_cmp( wp.z, wq.z, ec->size )) return ak_false;
+  if( ak_mpzn_cmp_ui( wp.z, ec->size, 0 )) return ak_true;
+ return ( ak_mpzn_cmp( wp.x, wq.x, ec->size ) == 0 ) &&
+                                                  ( ak_mpzn_cmp( wp.y, wq.y, ec->size ) == 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t test_curve( ak_wcurve ec, ak_random generator )
+{
+  size_t i = 0;
+  ak_mpznmax k;
+  const size_t d = ( ec->size << 6 )/4;
+
+ /* нулевой множитель: все цифры гребенки равны нулю */
+  ak_mpzn_set_ui( k, ec->size, 0 );
+  if( !test_point( ec, k )) return ak_false;
+ /* единственная ненулевая цифра в младшем или старшем столбце */
+  ak_mpzn_set_ui( k, ec->size, 1 );
+  if( !test_point( ec, k )) return ak_false;
+  ak_mpzn_set_ui( k, ec->size, 0 );
+  k[( d-1 ) >> 6] = ( ak_uint64 )1 << (( d-1 )&0x3f );
+  if( !test_point( ec, k )) return ak_false;
+ /* ненулевые цифры только в младших столбцах */
+  ak_mpzn_set_ui( k, ec->size, 0xf );
+  if( !test_point( ec, k )) return ak_false;
+ /* множитель q-1 */
+  ak_mpzn_set_ui( k, ec->size, 1 );
+  ak_mpzn_sub( k, ec->q, k, ec->size );
+  if( !test_point( ec, k )) return ak_false;
+ /* случайные множители */
+  for( i = 0; i < random_count; i++ ) {
+     ak_random_context_random( generator, k, ec->size*sizeof( ak_uint64 ));
+     k[ec->size-1] >>= 1;
+     if( !test_point( ec, k )) return ak_false;
+  }
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t test_torsion( ak_wcurve ec )
+{
+  struct wpoint wt, wp;
+  ak_tcurve tc = ak_wcurve_get_tcurve( ec );
+
+  if( tc == NULL ) return ak_true;
+ /* точка второго порядка (t:0:1) соответствует точке (0,-1) кривой Эдвардса */
+  memcpy( wt.x, tc->t, ec->size*sizeof( ak_uint64 ));
+  ak_mpzn_set_ui( wt.y, ec->size, 0 );
+  ak_mpzn_set_ui( wt.z, ec->size, 1 );
+  ak_mpzn_mul_montgomery( wt.z, ec->r2, wt.z, ec->p, ec->n, ec->size ); /* единица Монтгомери */
+  if( !ak_wpoint_is_ok( &wt, ec )) return ak_false;
+
+  ak_wpoint_set( &wp, ec );
+  if( !ak_wpoint_check_order( &wp, ec )) return ak_false;
+  ak_wpoint_add( &wp, &wt, ec );
+  if( !ak_wpoint_is_ok( &wp, ec )) return ak_false;
+ return !ak_wpoint_check_order( &wp, ec );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t count = 0;
+  struct random generator;
+  int result = EXIT_FAILURE;
+  ak_oid oid = NULL;
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  ak_random_context_create_lcg( &generator );
+
+  oid = ak_oid_context_find_by_engine( identifier );
+  while( oid != NULL ) {
+    if( oid->mode == wcurve_params ) {
+      if( !test_curve(( ak_wcurve ) oid->data, &generator )) {
+        printf("%s: wrong multiple of base point\n", oid->names[0] );
+        goto lexit;
+      }
+      if( !test_torsion(( ak_wcurve ) oid->data )) {
+        printf("%s: point of order 2q passes order check\n", oid->names[0] );
+        goto lexit;
+      }
+      count++;
+    }
+    oid = ak_oid_context_findnext_by_engine( oid, identifier );
+  }
+  printf("multiples of base point for %u curves is Ok\n", (unsigned int) count );
+  result = EXIT_SUCCESS;
+
+  lexit:
+   ak_random_context_destroy( &generator );
+   ak_libakrypt_destroy();
+ return result;
+}
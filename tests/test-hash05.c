@@ -0,0 +1,109 @@
+/* Пример иллюстрирует древовидное хеширование данных и проверку отдельного листа дерева.
+   Внимание! Используются неэкспортируемые функции.
+
+   test-hash05.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <ak_hash.h>
+ #include <ak_tools.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define data_size  ( 1048576 + 1001 )
+ #define leaf_size  ( 4096 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/* последовательное вычисление корня дерева с помощью функций хеширования листьев и вершин */
+ static int tree_root( ak_hash hctx, ak_hash_tree tree, ak_uint8 *data, ak_uint8 *out )
+{
+  int error = ak_error_ok;
+  ak_uint32 level = 0;
+  ak_uint64 i, count = ak_hash_tree_get_leaves_count( tree );
+  ak_uint8 *hashes = malloc( count*tree->tag_size );
+
+  for( i = 0; i < count; i++ )
+     if(( error = ak_hash_context_tree_leaf( hctx, tree, i, data + i*leaf_size,
+            ak_min( leaf_size, tree->total_size - i*leaf_size ), hashes + i*tree->tag_size )) != ak_error_ok )
+       goto lexit;
+  for( level = 1; count > 1 || level == 1; level++ ) {
+     ak_uint64 upper = ak_hash_tree_get_nodes_count( tree, level );
+     for( i = 0; i < upper; i++ )
+        if(( error = ak_hash_context_tree_node( hctx, tree, level, i,
+                           hashes + i*tree->fanout*tree->tag_size,
+                           ak_min( tree->fanout, count - i*tree->fanout ),
+                                                      hashes + i*tree->tag_size )) != ak_error_ok )
+          goto lexit;
+     count = upper;
+  }
+  memcpy( out, hashes, tree->tag_size );
+
+  lexit:
+   free( hashes );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i;
+  FILE *fp = NULL;
+  struct hash ctx;
+  struct hash_tree tree;
+  int result = EXIT_FAILURE;
+  ak_uint8 *data = NULL, out[64], check[64], leaf[64], plain[64];
+  const char *filename = "test-hash05.dat";
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  ak_hash_context_create_streebog512( &ctx );
+  if(( data = malloc( data_size )) == NULL ) goto lexit;
+  for( i = 0; i < data_size; i++ ) data[i] = ( ak_uint8 )( i*11 + 3 );
+
+ /* 1. многопоточное хеширование совпадает с последовательным */
+  ak_libakrypt_set_option( "hash_thread_count", 4 );
+  ak_hash_tree_create( &tree, &ctx, leaf_size, 4 );
+  if( ak_hash_context_tree_ptr( &ctx, &tree, data, data_size, out, sizeof( out )) != ak_error_ok ) {
+    printf("wrong tree hashing of memory\n"); goto lexit;
+  }
+  if(( tree_root( &ctx, &tree, data, check ) != ak_error_ok ) ||
+                                                          memcmp( out, check, sizeof( out ))) {
+    printf("tree root differs from sequential computation\n"); goto lexit;
+  }
+  ak_libakrypt_set_option( "hash_thread_count", 1 );
+  ak_hash_context_tree_ptr( &ctx, &tree, data, data_size, check, sizeof( check ));
+  if( memcmp( out, check, sizeof( out ))) {
+    printf("tree root depends on the number of threads\n"); goto lexit;
+  }
+
+ /* 2. хеширование файла */
+  ak_libakrypt_set_option( "hash_thread_count", 3 );
+  if(( fp = fopen( filename, "wb" )) == NULL ) goto lexit;
+  fwrite( data, 1, data_size, fp );
+  fclose( fp );
+  memset( check, 0, sizeof( check ));
+  if(( ak_hash_context_tree_file( &ctx, &tree, filename, check, sizeof( check )) != ak_error_ok ) ||
+                                                          memcmp( out, check, sizeof( out ))) {
+    printf("wrong tree hashing of file\n"); remove( filename ); goto lexit;
+  }
+  remove( filename );
+
+ /* 3. лист дерева отличается от хеш-кода тех же данных */
+  ak_hash_context_tree_leaf( &ctx, &tree, 0, data, leaf_size, leaf );
+  ak_hash_context_ptr( &ctx, data, leaf_size, plain, sizeof( plain ));
+  if( !memcmp( leaf, plain, sizeof( leaf ))) {
+    printf("leaf hash is not separated from plain hash\n"); goto lexit;
+  }
+ /* 4. дерево для данных нулевой длины */
+  if(( ak_hash_context_tree_ptr( &ctx, &tree, NULL, 0, out, sizeof( out )) != ak_error_ok ) ||
+     ( tree_root( &ctx, &tree, data, check ) != ak_error_ok ) || memcmp( out, check, sizeof( out ))) {
+    printf("wrong tree hashing of empty data\n"); goto lexit;
+  }
+  printf("tree hashing is Ok\n");
+  result = EXIT_SUCCESS;
+
+  lexit:
+   if( data != NULL ) free( data );
+   ak_hash_context_destroy( &ctx );
+   ak_libakrypt_destroy();
+ return result;
+}
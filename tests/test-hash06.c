@@ -0,0 +1,62 @@
+/* Пример иллюстрирует одновременное хеширование нескольких сообщений разной длины.
+   Внимание! Используются неэкспортируемые функции.
+
+   test-hash06.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <ak_hash.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define jobs_count ( 13 )
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int test_multi( int (*create)( ak_hash ), const char *name )
+{
+  size_t i;
+  struct hash ctx;
+  int result = EXIT_SUCCESS;
+  struct hash_job jobs[jobs_count];
+  ak_uint8 data[4096], out[jobs_count][64], check[64];
+  size_t sizes[jobs_count] = { 0, 1, 63, 64, 65, 127, 128, 1000, 4096, 4095, 200, 3, 2049 };
+
+  for( i = 0; i < sizeof( data ); i++ ) data[i] = ( ak_uint8 )( i*5 + 1 );
+  create( &ctx );
+  memset( out, 0, sizeof( out ));
+  for( i = 0; i < jobs_count; i++ ) {
+     jobs[i].in = data + ( i&7 );
+     jobs[i].size = ak_min( sizes[i], sizeof( data ) - ( i&7 ));
+     jobs[i].out = out[i];
+     jobs[i].out_size = sizeof( out[i] );
+  }
+  if( ak_hash_context_ptr_multi( &ctx, jobs, jobs_count ) != ak_error_ok ) {
+    printf("%s: incorrect hashing of messages\n", name );
+    result = EXIT_FAILURE;
+  }
+  for( i = 0; i < jobs_count; i++ ) {
+     memset( check, 0, sizeof( check ));
+     ak_hash_context_ptr( &ctx, jobs[i].in, jobs[i].size, check, sizeof( check ));
+     if( memcmp( check, out[i], sizeof( check ))) {
+       printf("%s: wrong hash of message %u (length %u)\n",
+                                            name, (unsigned int) i, (unsigned int) jobs[i].size );
+       result = EXIT_FAILURE;
+     }
+  }
+  if( result == EXIT_SUCCESS ) printf("%s: %d messages is Ok\n", name, jobs_count );
+  ak_hash_context_destroy( &ctx );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  int result = EXIT_FAILURE;
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  if(( result = test_multi( ak_hash_context_create_streebog256, "streebog256" )) == EXIT_SUCCESS )
+    result = test_multi( ak_hash_context_create_streebog512, "streebog512" );
+  ak_libakrypt_destroy();
+
+ return result;
+}
@@ -0,0 +1,76 @@
+/* Пример иллюстрирует вычисление хеш-кода файла с отображением файла в память,
+   с чтением данных отдельным потоком и с последовательным чтением данных.
+   Внимание! Используются неэкспортируемые функции.
+
+   test-hash07.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <ak_hash.h>
+ #include <ak_tools.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int test_file( ak_hash ctx, ak_uint8 *data, size_t size )
+{
+  FILE *fp = NULL;
+  ak_uint8 out[64], mapped[64], pipelined[64], readed[64];
+  const char *filename = "test-hash07.dat";
+
+  if(( fp = fopen( filename, "wb" )) == NULL ) return EXIT_FAILURE;
+  fwrite( data, 1, size, fp );
+  fclose( fp );
+
+  ak_hash_context_ptr( ctx, data, size, out, sizeof( out ));
+ /* файл отображается в память */
+  ak_libakrypt_set_option( "mmap_file_threshold", 4096 );
+  ak_hash_context_file( ctx, filename, mapped, sizeof( mapped ));
+ /* файл считывается отдельным потоком */
+  ak_libakrypt_set_option( "mmap_file_threshold", 0 );
+  ak_libakrypt_set_option( "file_buffer_size", 4096 );
+  ak_libakrypt_set_option( "file_buffers_count", 4 );
+  ak_hash_context_file( ctx, filename, pipelined, sizeof( pipelined ));
+ /* файл считывается последовательно */
+  ak_libakrypt_set_option( "file_buffers_count", 1 );
+  ak_hash_context_file( ctx, filename, readed, sizeof( readed ));
+  remove( filename );
+
+  if( memcmp( out, mapped, sizeof( out ))) {
+    printf("wrong hash of mapped file (%u bytes)\n", (unsigned int) size );
+    return EXIT_FAILURE;
+  }
+  if( memcmp( out, pipelined, sizeof( out ))) {
+    printf("wrong hash of pipelined file (%u bytes)\n", (unsigned int) size );
+    return EXIT_FAILURE;
+  }
+  if( memcmp( out, readed, sizeof( out ))) {
+    printf("wrong hash of readed file (%u bytes)\n", (unsigned int) size );
+    return EXIT_FAILURE;
+  }
+  printf("hashing of file with %u bytes is Ok\n", (unsigned int) size );
+ return EXIT_SUCCESS;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i, size = 1048576 + 17;
+  struct hash ctx;
+  int result = EXIT_FAILURE;
+  ak_uint8 *data = NULL;
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  ak_hash_context_create_streebog512( &ctx );
+  if(( data = malloc( size )) == NULL ) goto lexit;
+  for( i = 0; i < size; i++ ) data[i] = ( ak_uint8 )( i*3 + 7 );
+
+  if(( result = test_file( &ctx, data, size )) == EXIT_SUCCESS )
+    if(( result = test_file( &ctx, data, 16*4096 )) == EXIT_SUCCESS )
+      result = test_file( &ctx, data, 4095 );
+
+  lexit:
+   if( data != NULL ) free( data );
+   ak_hash_context_destroy( &ctx );
+   ak_libakrypt_destroy();
+ return result;
+}
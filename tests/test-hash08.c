@@ -0,0 +1,117 @@
+/* Пример иллюстрирует использование функций хеширования SHA-3 через общий интерфейс
+   бесключевых функций хеширования: создание контекста по OID, хеширование файла
+   и вычисление HMAC (в том числе с ключом, длина которого превышает длину блока).
+   Внимание! Используются неэкспортируемые функции.
+
+   test-hash08.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <ak_hmac.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define data_size  ( 100003 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/* первые 16 октетов хеш-кода данных и значений HMAC с ключами длины 32 и 200 октетов */
+ static struct sha3_test {
+   const char *name;
+   size_t tag_size;
+   ak_uint8 hash[16], hmac32[16], hmac200[16];
+ } tests[3] = {
+   { "sha3-256", 32,
+     { 0x2a, 0x67, 0x1a, 0xfc, 0x67, 0xf1, 0x75, 0xdb, 0x68, 0x47, 0xc3, 0x22, 0xc9, 0x63, 0x71, 0xea },
+     { 0xc4, 0x54, 0xe3, 0x26, 0x86, 0x78, 0xa6, 0x54, 0x39, 0x0c, 0xde, 0x1d, 0xd7, 0x1e, 0xb1, 0x95 },
+     { 0x49, 0x5d, 0x65, 0x0d, 0xec, 0xf1, 0x70, 0x47, 0x36, 0x0d, 0xf7, 0xd5, 0x1f, 0x06, 0x19, 0x4b }},
+   { "sha3-384", 48,
+     { 0xd1, 0x6c, 0x7c, 0xfd, 0x77, 0xd2, 0xe0, 0xb0, 0x2a, 0x15, 0xfd, 0xb1, 0xe6, 0xc8, 0x63, 0x67 },
+     { 0x68, 0x20, 0xb2, 0x18, 0xa3, 0x70, 0xcc, 0x74, 0xca, 0x3c, 0xd6, 0xbf, 0x85, 0xd6, 0xf2, 0xdd },
+     { 0x44, 0xbf, 0xd7, 0xf7, 0x57, 0xdd, 0xe1, 0x69, 0x2c, 0x76, 0xe1, 0xa6, 0xd6, 0x53, 0x6f, 0x50 }},
+   { "sha3-512", 64,
+     { 0x3c, 0xa5, 0x7f, 0xac, 0x7f, 0x63, 0xf7, 0xef, 0x61, 0x70, 0x72, 0x5e, 0x84, 0x34, 0x8a, 0x06 },
+     { 0xad, 0x42, 0x8e, 0x0c, 0x2f, 0xd1, 0xc8, 0x6e, 0x76, 0x36, 0x3d, 0x3b, 0x74, 0xb3, 0x4f, 0x1b },
+     { 0xb1, 0x57, 0xa1, 0xf7, 0x0d, 0x79, 0x4b, 0x9e, 0xd1, 0x06, 0x00, 0x63, 0x04, 0x41, 0x4f, 0x33 }}
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int test_sha3( struct sha3_test *test, ak_uint8 *data )
+{
+  size_t i;
+  FILE *fp = NULL;
+  struct hash ctx;
+  struct hmac hctx;
+  char hmacname[32];
+  int result = EXIT_FAILURE;
+  ak_uint8 out[64], key32[32], key200[200];
+  const char *filename = "test-hash08.dat";
+
+  for( i = 0; i < sizeof( key32 ); i++ ) key32[i] = ( ak_uint8 )i;
+  for( i = 0; i < sizeof( key200 ); i++ ) key200[i] = ( ak_uint8 )( i*5 + 1 );
+
+ /* 1. создание контекста по OID и хеширование фрагментами произвольной длины */
+  if( ak_hash_context_create_oid( &ctx, ak_oid_context_find_by_name( test->name )) != ak_error_ok )
+    return EXIT_FAILURE;
+  if( ak_hash_context_get_tag_size( &ctx ) != test->tag_size ) {
+    printf("%s: wrong tag size\n", test->name ); goto lexit;
+  }
+  ak_hash_context_clean( &ctx );
+  for( i = 0; i + 1001 < data_size; i += 1001 ) ak_hash_context_update( &ctx, data + i, 1001 );
+  ak_hash_context_finalize( &ctx, data + i, data_size - i, out, sizeof( out ));
+  if( memcmp( out, test->hash, sizeof( test->hash ))) {
+    printf("%s: wrong hash of memory\n", test->name ); goto lexit;
+  }
+
+ /* 2. хеширование файла */
+  if(( fp = fopen( filename, "wb" )) == NULL ) goto lexit;
+  fwrite( data, 1, data_size, fp );
+  fclose( fp );
+  memset( out, 0, sizeof( out ));
+  ak_hash_context_file( &ctx, filename, out, sizeof( out ));
+  remove( filename );
+  if( memcmp( out, test->hash, sizeof( test->hash ))) {
+    printf("%s: wrong hash of file\n", test->name ); goto lexit;
+  }
+
+ /* 3. вычисление HMAC */
+  sprintf( hmacname, "hmac-%s", test->name );
+  if( ak_hmac_context_create_oid( &hctx, ak_oid_context_find_by_name( hmacname )) != ak_error_ok )
+    goto lexit;
+  ak_hmac_context_set_key( &hctx, key32, sizeof( key32 ));
+  ak_hmac_context_ptr( &hctx, data, data_size, out, sizeof( out ));
+  if( memcmp( out, test->hmac32, sizeof( test->hmac32 ))) {
+    printf("%s: wrong hmac value\n", hmacname ); ak_hmac_context_destroy( &hctx ); goto lexit;
+  }
+  ak_hmac_context_set_key( &hctx, key200, sizeof( key200 ));
+  ak_hmac_context_ptr( &hctx, data, data_size, out, sizeof( out ));
+  ak_hmac_context_destroy( &hctx );
+  if( memcmp( out, test->hmac200, sizeof( test->hmac200 ))) {
+    printf("%s: wrong hmac value for long key\n", hmacname ); goto lexit;
+  }
+  printf("%s is Ok\n", test->name );
+  result = EXIT_SUCCESS;
+
+  lexit:
+   ak_hash_context_destroy( &ctx );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i;
+  ak_uint8 *data = NULL;
+  int result = EXIT_FAILURE;
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  if(( data = malloc( data_size )) == NULL ) goto lexit;
+  for( i = 0; i < data_size; i++ ) data[i] = ( ak_uint8 )( i*13 + 7 );
+
+  for( i = 0; i < 3; i++ )
+     if(( result = test_sha3( tests+i, data )) != EXIT_SUCCESS ) break;
+
+  lexit:
+   if( data != NULL ) free( data );
+   ak_libakrypt_destroy();
+ return result;
+}
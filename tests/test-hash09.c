@@ -0,0 +1,147 @@
+/* Пример иллюстрирует повторное использование состояния функции хеширования и алгоритма HMAC,
+   вычисленного для общего префикса нескольких сообщений.
+   Внимание! Используются неэкспортируемые функции.
+
+   test-hash09.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <ak_hmac.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define prefix_size  ( 1037 )
+ #define message_size ( 1037 + 333 )
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int test_hash( const char *name, ak_uint8 *data )
+{
+  size_t i;
+  int result = EXIT_FAILURE;
+  struct hash prefix, copy, ref;
+  ak_uint8 out[64], check[64];
+
+  if( ak_hash_context_create_oid( &prefix, ak_oid_context_find_by_name( name )) != ak_error_ok )
+    return EXIT_FAILURE;
+  ak_hash_context_create_oid( &ref, prefix.oid );
+  ak_hash_context_create_oid( &copy, prefix.oid );
+  ak_hash_context_clean( &prefix );
+  ak_hash_context_update( &prefix, data, prefix_size );
+
+ /* 1. копии контекста продолжают вычисления для разных сообщений с общим префиксом */
+  for( i = 0; i < 3; i++ ) {
+     struct hash clone;
+     memset( out, 0, sizeof( out ));
+     memset( check, 0, sizeof( check ));
+     data[message_size-1] = ( ak_uint8 )i;
+     ak_hash_context_ptr( &ref, data, message_size, check, sizeof( check ));
+     if( ak_hash_context_clone( &clone, &prefix ) != ak_error_ok ) goto lexit;
+     ak_hash_context_finalize( &clone, data + prefix_size,
+                                                message_size - prefix_size, out, sizeof( out ));
+     ak_hash_context_destroy( &clone );
+     if( memcmp( out, check, sizeof( out ))) {
+       printf("%s: wrong hash computed from cloned context\n", name ); goto lexit;
+     }
+
+ /* 2. восстановление сохраненного состояния в рабочем контексте того же алгоритма */
+     ak_hash_context_update( &copy, data, 7 );
+     if( ak_hash_context_restore( &copy, &prefix ) != ak_error_ok ) goto lexit;
+     ak_hash_context_update( &copy, data + prefix_size, 100 );
+     ak_hash_context_finalize( &copy, data + prefix_size + 100,
+                                          message_size - prefix_size - 100, out, sizeof( out ));
+     if( memcmp( out, check, sizeof( out ))) {
+       printf("%s: wrong hash computed from restored context\n", name ); goto lexit;
+     }
+  }
+
+ /* 3. восстановление в контексте другого алгоритма запрещено */
+  ak_hash_context_destroy( &copy );
+  ak_hash_context_create_sha3_512( &copy );
+  if( ak_hash_context_restore( &copy, &prefix ) == ak_error_ok ) {
+    printf("%s: restoring to context of other algorithm\n", name ); goto lexit;
+  }
+  printf("%s: clone and restore is Ok\n", name );
+  result = EXIT_SUCCESS;
+
+  lexit:
+   ak_hash_context_destroy( &copy );
+   ak_hash_context_destroy( &ref );
+   ak_hash_context_destroy( &prefix );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int test_hmac( const char *name, ak_uint8 *data )
+{
+  size_t i;
+  ssize_t resource;
+  int result = EXIT_FAILURE;
+  struct hmac prefix, work;
+  ak_uint8 out[64], check[64], key[32];
+
+  memset( key, 0x5a, sizeof( key ));
+  if( ak_hmac_context_create_oid( &prefix, ak_oid_context_find_by_name( name )) != ak_error_ok )
+    return EXIT_FAILURE;
+  ak_hmac_context_create_oid( &work, prefix.key.oid );
+  ak_hmac_context_set_key( &prefix, key, sizeof( key ));
+  ak_hmac_context_set_key( &work, key, sizeof( key ));
+  ak_hmac_context_clean( &prefix );
+  ak_hmac_context_update( &prefix, data, prefix_size );
+
+  for( i = 0; i < 2; i++ ) {
+     memset( out, 0, sizeof( out ));
+     memset( check, 0, sizeof( check ));
+     data[message_size-1] = ( ak_uint8 )i;
+     ak_hmac_context_ptr( &work, data, message_size, check, sizeof( check ));
+     resource = work.key.resource.value.counter;
+     if( ak_hmac_context_restore( &work, &prefix ) != ak_error_ok ) goto lexit;
+     if( work.key.resource.value.counter != resource - 1 ) {
+       printf("%s: wrong key resource after restoring\n", name ); goto lexit;
+     }
+     ak_hmac_context_finalize( &work, data + prefix_size,
+                                          message_size - prefix_size, out, sizeof( out ));
+     if( memcmp( out, check, sizeof( out ))) {
+       printf("%s: wrong value computed from restored context\n", name ); goto lexit;
+     }
+  }
+ /* восстановление на ключе с исчерпанным ресурсом запрещено */
+  resource = work.key.resource.value.counter;
+  work.key.resource.value.counter = 1;
+  if( ak_hmac_context_restore( &work, &prefix ) == ak_error_ok ) {
+    printf("%s: restoring to context with low key resource\n", name ); goto lexit;
+  }
+  work.key.resource.value.counter = resource;
+
+ /* восстановление в контексте с другим ключом запрещено */
+  key[0] ^= 1;
+  ak_hmac_context_set_key( &work, key, sizeof( key ));
+  if( ak_hmac_context_restore( &work, &prefix ) == ak_error_ok ) {
+    printf("%s: restoring to context with other key\n", name ); goto lexit;
+  }
+  printf("%s: restore is Ok\n", name );
+  result = EXIT_SUCCESS;
+
+  lexit:
+   ak_hmac_context_destroy( &work );
+   ak_hmac_context_destroy( &prefix );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i;
+  int result = EXIT_FAILURE;
+  ak_uint8 data[message_size];
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  for( i = 0; i < message_size; i++ ) data[i] = ( ak_uint8 )( i*3 + 1 );
+
+  if(( result = test_hash( "streebog512", data )) == EXIT_SUCCESS )
+   if(( result = test_hash( "sha3-256", data )) == EXIT_SUCCESS )
+    if(( result = test_hmac( "hmac-streebog256", data )) == EXIT_SUCCESS )
+      result = test_hmac( "hmac-sha3-384", data );
+
+  ak_libakrypt_destroy();
+ return result;
+}
@@ -0,0 +1,119 @@
+/* Пример иллюстрирует пакетную выработку ключевых векторов из паролей несколькими потоками
+   и ее эквивалентность последовательным вызовам функции ak_hmac_context_pbkdf2_streebog512(),
+   а также совпадение результатов одновременного выполнения нескольких заданий одним потоком
+   с контрольными примерами из Р 50.1.111-2016.
+   Внимание! Используются неэкспортируемые функции.
+
+   test-hmac03.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <ak_hmac.h>
+ #include <ak_tools.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define tasks_count  ( 13 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/* контрольные примеры из Р 50.1.111-2016 (первые 16 октетов) с количеством итераций 1, 2 и 4096 */
+ static ak_uint8 R[4][16] = {
+  { 0x64, 0x77, 0x0a, 0xf7, 0xf7, 0x48, 0xc3, 0xb1, 0xc9, 0xac, 0x83, 0x1d, 0xbc, 0xfd, 0x85, 0xc2 },
+  { 0x5a, 0x58, 0x5b, 0xaf, 0xdf, 0xbb, 0x6e, 0x88, 0x30, 0xd6, 0xd6, 0x8a, 0xa3, 0xb4, 0x3a, 0xc0 },
+  { 0xe5, 0x2d, 0xeb, 0x9a, 0x2d, 0x2a, 0xaf, 0xf4, 0xe2, 0xac, 0x9d, 0x47, 0xa4, 0x1f, 0x34, 0xc2 },
+  { 0x50, 0xdf, 0x06, 0x28, 0x85, 0xb6, 0x98, 0x01, 0xa3, 0xc1, 0x02, 0x48, 0xeb, 0x0a, 0x27, 0xab }
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+/* все четыре задания выполняются одним потоком одновременно */
+ static int test_lanes( void )
+{
+  size_t i;
+  struct pbkdf2_task tasks[4];
+  ak_uint8 out[4][64];
+  char password_one[8] = "password", password_two[9] = { 'p', 'a', 's', 's', 0, 'w', 'o', 'r', 'd' },
+       salt_one[4] = "salt", salt_two[5] = { 's', 'a', 0, 'l', 't' };
+  size_t counts[4] = { 1, 2, 4096, 4096 };
+
+  ak_libakrypt_set_option( "pbkdf2_thread_count", 1 );
+  for( i = 0; i < 4; i++ ) {
+     tasks[i].password = ( i == 3 ) ? password_two : password_one;
+     tasks[i].password_size = ( i == 3 ) ? sizeof( password_two ) : sizeof( password_one );
+     tasks[i].salt = ( i == 3 ) ? salt_two : salt_one;
+     tasks[i].salt_size = ( i == 3 ) ? sizeof( salt_two ) : sizeof( salt_one );
+     tasks[i].count = counts[i];
+     tasks[i].dklen = 64;
+     tasks[i].out = out[i];
+  }
+  if( ak_hmac_context_pbkdf2_streebog512_batch( tasks, 4 ) != ak_error_ok ) {
+    printf("wrong batch key derivation for test vectors\n"); return EXIT_FAILURE;
+  }
+  for( i = 0; i < 4; i++ )
+     if( memcmp( out[i], R[i], sizeof( R[i] ))) {
+       printf("wrong test vector %u in batch key derivation\n", (unsigned int) i );
+       return EXIT_FAILURE;
+     }
+ return EXIT_SUCCESS;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i;
+  int result = EXIT_FAILURE;
+  struct pbkdf2_task tasks[tasks_count];
+  char passwords[tasks_count][16];
+  ak_uint8 salts[tasks_count][16], out[tasks_count][64], check[64];
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  if( test_lanes() != EXIT_SUCCESS ) goto lexit;
+  ak_libakrypt_set_option( "pbkdf2_thread_count", 4 );
+
+ /* формируем задания с различными паролями, длинами и количеством итераций */
+  memset( out, 0, sizeof( out ));
+  for( i = 0; i < tasks_count; i++ ) {
+     sprintf( passwords[i], "password-%02u", (unsigned int) i );
+     memset( salts[i], ( int )( i*7 + 1 ), sizeof( salts[i] ));
+     tasks[i].password = passwords[i];
+     tasks[i].password_size = strlen( passwords[i] );
+     tasks[i].salt = salts[i];
+     tasks[i].salt_size = 1 + i;
+     tasks[i].count = 1 + i*37;
+     tasks[i].dklen = ( i&1 ) ? 64 : 32;
+     tasks[i].out = out[i];
+  }
+
+ /* 1. результат пакетной обработки совпадает с последовательными вызовами */
+  if( ak_hmac_context_pbkdf2_streebog512_batch( tasks, tasks_count ) != ak_error_ok ) {
+    printf("wrong batch key derivation\n"); goto lexit;
+  }
+  for( i = 0; i < tasks_count; i++ ) {
+     memset( check, 0, sizeof( check ));
+     ak_hmac_context_pbkdf2_streebog512( tasks[i].password, tasks[i].password_size,
+                     tasks[i].salt, tasks[i].salt_size, tasks[i].count, tasks[i].dklen, check );
+     if(( tasks[i].error != ak_error_ok ) || memcmp( out[i], check, sizeof( check ))) {
+       printf("task %u: batch result differs from sequential computation\n", (unsigned int) i );
+       goto lexit;
+     }
+  }
+
+ /* 2. ошибка в одном задании не прерывает выполнение остальных */
+  ak_libakrypt_set_option( "pbkdf2_thread_count", 3 );
+  tasks[5].dklen = 16;
+  memset( out[6], 0, sizeof( out[6] ));
+  if( ak_hmac_context_pbkdf2_streebog512_batch( tasks, tasks_count ) != ak_error_wrong_length ) {
+    printf("wrong task is not detected\n"); goto lexit;
+  }
+  if(( tasks[5].error != ak_error_wrong_length ) || ( tasks[6].error != ak_error_ok ) ||
+     ( ak_hmac_context_pbkdf2_streebog512( tasks[6].password, tasks[6].password_size,
+          tasks[6].salt, tasks[6].salt_size, tasks[6].count, tasks[6].dklen, check ) != ak_error_ok )
+                                                    || memcmp( out[6], check, tasks[6].dklen )) {
+    printf("wrong processing of tasks after an error\n"); goto lexit;
+  }
+  printf("batch pbkdf2 is Ok\n");
+  result = EXIT_SUCCESS;
+
+  lexit:
+   ak_libakrypt_destroy();
+ return result;
+}
@@ -0,0 +1,97 @@
+/* Пример иллюстрирует пакетную проверку электронных подписей несколькими потоками
+   и ее эквивалентность последовательным вызовам функции ak_verifykey_context_verify_hash().
+   Внимание! Используются неэкспортируемые функции.
+
+   test-sign04.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <ak_oid.h>
+ #include <ak_sign.h>
+ #include <ak_tools.h>
+ #include <ak_random.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define keys_count   ( 3 )
+ #define tasks_count  ( 101 )
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i, j, created = 0;
+  struct random generator;
+  int result = EXIT_FAILURE;
+  struct signkey sk[keys_count];
+  struct verifykey pk[keys_count];
+  struct verify_task tasks[tasks_count];
+  ak_uint8 hashes[tasks_count][64], signs[tasks_count][128];
+  const char *curves[keys_count] = { "id-tc26-gost-3410-2012-256-paramSetA",
+                               "id-rfc4357-gost-3410-2001-paramSetA",
+                                                       "id-tc26-gost-3410-2012-512-paramSetC" };
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  ak_libakrypt_set_option( "verify_thread_count", 4 );
+  ak_random_context_create_lcg( &generator );
+
+ /* создаем ключи на эллиптических кривых различной формы и размера */
+  for( j = 0; j < keys_count; j++ ) {
+     if( ak_signkey_context_create( &sk[j],
+                               ( ak_wcurve ) ak_oid_context_find_by_name( curves[j] )->data )
+                                                                               != ak_error_ok ) {
+       printf("wrong creation of secret key on %s\n", curves[j] );
+       goto lexit;
+     }
+     ak_signkey_context_set_key_random( &sk[j], &generator );
+     ak_verifykey_context_create_from_signkey( &pk[j], &sk[j] );
+     created++;
+  }
+
+ /* формируем задания, ключи в которых чередуются; часть подписей искажается */
+  for( i = 0; i < tasks_count; i++ ) {
+     j = i%keys_count;
+     tasks[i].key = &pk[j];
+     tasks[i].hash = hashes[i];
+     tasks[i].hsize = sizeof( ak_uint64 )*pk[j].wc->size;
+     tasks[i].sign = signs[i];
+     ak_random_context_random( &generator, hashes[i], tasks[i].hsize );
+     ak_signkey_context_sign_hash( &sk[j], hashes[i], tasks[i].hsize, signs[i], sizeof( signs[i] ));
+     if( i%7 == 3 ) signs[i][i%( 2*tasks[i].hsize )] ^= 0x01;
+     if( i%11 == 5 ) hashes[i][0] ^= 0x80;
+  }
+
+ /* 1. результат пакетной проверки совпадает с последовательными вызовами */
+  if( ak_verifykey_context_verify_hash_batch( tasks, tasks_count ) != ak_error_ok ) {
+    printf("wrong batch signature verification\n"); goto lexit;
+  }
+  for( i = 0; i < tasks_count; i++ ) {
+     if(( tasks[i].error != ak_error_ok ) || ( tasks[i].result !=
+         ak_verifykey_context_verify_hash( tasks[i].key, tasks[i].hash, tasks[i].hsize, tasks[i].sign ))
+         || ( tasks[i].result != (( i%7 != 3 ) && ( i%11 != 5 )))) {
+       printf("task %u: batch result differs from sequential verification\n", (unsigned int) i );
+       goto lexit;
+     }
+  }
+
+ /* 2. ошибка в одном задании не прерывает выполнение остальных */
+  ak_libakrypt_set_option( "verify_thread_count", 1 );
+  tasks[8].hsize = 16;
+  if( ak_verifykey_context_verify_hash_batch( tasks, tasks_count ) != ak_error_wrong_length ) {
+    printf("wrong task is not detected\n"); goto lexit;
+  }
+  if(( tasks[8].error != ak_error_wrong_length ) || ( tasks[8].result != ak_false ) ||
+     ( tasks[9].error != ak_error_ok ) || ( tasks[9].result != ak_true )) {
+    printf("wrong processing of tasks after an error\n"); goto lexit;
+  }
+  printf("batch signature verification is Ok\n");
+  result = EXIT_SUCCESS;
+
+  lexit:
+   for( j = 0; j < created; j++ ) {
+      ak_signkey_context_destroy( &sk[j] );
+      ak_verifykey_context_destroy( &pk[j] );
+   }
+   ak_random_context_destroy( &generator );
+   ak_libakrypt_destroy();
+ return result;
+}
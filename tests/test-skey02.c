@@ -0,0 +1,72 @@
+/* Пример иллюстрирует политику смены маски ключа алгоритма блочного шифрования.
+   Внимание! Используются неэкспортируемые функции.
+
+   test-skey02.c
+*/
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <ak_bckey.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+/* функция зашифровывает данные count раз и проверяет, сменилась ли маска ключа */
+ static bool_t remask_after( ak_bckey key, ak_uint8 *data, size_t size, int count )
+{
+  int i;
+  ak_uint8 mask[32];
+
+  memcpy( mask, key->key.key + key->key.key_size, sizeof( mask ));
+  for( i = 0; i < count; i++ ) ak_bckey_context_encrypt_ecb( key, data, data, size );
+ return memcmp( mask, key->key.key + key->key.key_size, sizeof( mask )) != 0;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  struct bckey key;
+  int result = EXIT_FAILURE;
+  ak_uint8 data[160], testkey[32] = {
+    0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+    0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  memset( data, 0x11, sizeof( data ));
+  ak_bckey_context_create_kuznechik( &key );
+  ak_bckey_context_set_key( &key, testkey, sizeof( testkey ));
+
+ /* 1. политика по-умолчанию: маска сменяется после каждого вызова */
+  if( !remask_after( &key, data, 16, 1 )) {
+    printf("default policy: mask is not changed after one call\n"); goto lexit;
+  }
+ /* 2. маска сменяется после каждого четвертого вызова */
+  ak_skey_context_set_remask_policy( &key.key, 4, 0, 0 );
+  if( remask_after( &key, data, 16, 3 )) {
+    printf("call policy: mask is changed too early\n"); goto lexit;
+  }
+  if( !remask_after( &key, data, 16, 1 )) {
+    printf("call policy: mask is not changed after four calls\n"); goto lexit;
+  }
+ /* 3. маска сменяется после обработки десяти блоков */
+  ak_skey_context_set_remask_policy( &key.key, 1000, 10, 0 );
+  if( remask_after( &key, data, 64, 2 )) {
+    printf("block policy: mask is changed too early\n"); goto lexit;
+  }
+  if( !remask_after( &key, data, 32, 1 )) {
+    printf("block policy: mask is not changed after ten blocks\n"); goto lexit;
+  }
+ /* 4. редкая смена маски не влияет на результат зашифрования */
+  ak_skey_context_set_remask_policy( &key.key, 1000, 0, 0 );
+  memset( data, 0x11, sizeof( data ));
+  ak_bckey_context_encrypt_ecb( &key, data, data, sizeof( data ));
+  ak_bckey_context_decrypt_ecb( &key, data, data, sizeof( data ));
+  if( data[0] != 0x11 || data[sizeof( data )-1] != 0x11 ) {
+    printf("wrong encryption with lazy remasking\n"); goto lexit;
+  }
+  printf("remask policy is Ok\n");
+  result = EXIT_SUCCESS;
+
+  lexit:
+   ak_bckey_context_destroy( &key );
+   ak_libakrypt_destroy();
+ return result;
+}